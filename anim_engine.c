@@ -0,0 +1,318 @@
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+
+#include "anim_engine.h"
+
+// 播放时每帧检查：有新命令就结束当前动画
+static int engine_should_stop(void *arg) {
+    anim_engine *engine = arg;
+    return atomic_load(&engine->pending) != 0;
+}
+
+// 帧时钟的等待方式：在 wake 上等到帧显示时刻，期间有新命令到达时返回-1
+static int engine_sleep(void *arg, const struct timespec *deadline) {
+    anim_engine *engine = arg;
+    pthread_mutex_lock(&engine->lock);
+    while (engine->head == engine->tail) {
+        if (pthread_cond_timedwait(&engine->wake, &engine->lock, deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    int interrupted = engine->head != engine->tail;
+    pthread_mutex_unlock(&engine->lock);
+    return interrupted ? -1 : 0;
+}
+
+// 取得画面：第一次播放或交还画面后重新初始化提交器
+static int acquire_screen(anim_engine *engine) {
+    if (engine->presenting) {
+        return 0;
+    }
+    if (fb_presenter_init(&engine->presenter, &engine->device, engine->format,
+                          FB_PRESENT_AUTO) == -1) {
+        fb_presenter_destroy(&engine->presenter);
+        return -1;
+    }
+    engine->presenting = 1;
+    return 0;
+}
+
+// 交还画面：最后一帧留在第0页
+static void release_screen(anim_engine *engine) {
+    if (!engine->presenting) {
+        return;
+    }
+    frame_clock_report(&engine->player.clock);
+    fb_presenter_report(&engine->presenter);
+    fb_presenter_destroy(&engine->presenter);
+    engine->presenting = 0;
+}
+
+// 映射是否仍然有效：源内容没有变化，包文件没有被重建，也没有被缓存淘汰删除
+static int asset_valid(const anim_engine_asset *asset) {
+    uint64_t key;
+    struct stat mapped, current;
+    return anim_player_source_key(asset->path, &key) == 0 && key == asset->source_key &&
+           fstat(asset->pack.fd, &mapped) == 0 && mapped.st_nlink > 0 &&
+           stat(asset->pack_path, &current) == 0 &&
+           current.st_dev == mapped.st_dev && current.st_ino == mapped.st_ino;
+}
+
+// 查找已映射的动画包；映射已失效时丢弃，由调用者重新播放源路径
+static anim_engine_asset *find_asset(anim_engine *engine, const char *path) {
+    for (int i = 0; i < engine->asset_count; i++) {
+        anim_engine_asset *asset = &engine->assets[i];
+        if (strcmp(asset->path, path) != 0) {
+            continue;
+        }
+        if (!asset_valid(asset)) {
+            anim_pack_close(&asset->pack);
+            *asset = engine->assets[--engine->asset_count];
+            return NULL;
+        }
+        asset->last_used = ++engine->uses;
+        return asset;
+    }
+    return NULL;
+}
+
+// 保持 pack_path 的映射，表满时替换最久未用的动画包
+// source_key 是播放前源内容的键，之后源内容有变化时映射失效
+static void keep_asset(anim_engine *engine, const char *path, uint64_t source_key,
+                       const char *pack_path) {
+    anim_engine_asset *asset;
+    if (engine->asset_count < ANIM_ENGINE_ASSETS) {
+        asset = &engine->assets[engine->asset_count];
+        if (anim_pack_open(&asset->pack, pack_path) == -1) {
+            return;
+        }
+        engine->asset_count++;
+    } else {
+        asset = &engine->assets[0];
+        for (int i = 1; i < engine->asset_count; i++) {
+            if (engine->assets[i].last_used < asset->last_used) {
+                asset = &engine->assets[i];
+            }
+        }
+        anim_pack pack;
+        if (anim_pack_open(&pack, pack_path) == -1) {
+            return;
+        }
+        anim_pack_close(&asset->pack);
+        asset->pack = pack;
+    }
+    snprintf(asset->path, sizeof(asset->path), "%s", path);
+    snprintf(asset->pack_path, sizeof(asset->pack_path), "%s", pack_path);
+    asset->source_key = source_key;
+    asset->last_used = ++engine->uses;
+}
+
+// 播放一条命令，动画播放过（正常结束或被打断）返回0
+static int play_command(anim_engine *engine, const anim_engine_command *cmd) {
+    if (acquire_screen(engine) == -1) {
+        return -1;
+    }
+    anim_player *player = &engine->player;
+    player->presenter = &engine->presenter;
+
+    // 清屏和新动画的第一帧一起提交
+    fb_presenter_clear(&engine->presenter);
+    frame_clock_restart(&player->clock);
+
+    anim_engine_asset *asset = find_asset(engine, cmd->path);
+    if (asset) {
+        return anim_player_play_pack(player, &asset->pack, cmd->delay_ms, cmd->loop_once, 0);
+    }
+    uint64_t source_key;
+    int have_key = anim_player_source_key(cmd->path, &source_key) == 0;
+    if (anim_player_play(player, cmd->path, cmd->delay_ms, cmd->loop_once, 0) != 0) {
+        return -1;
+    }
+    if (player->pack_path[0] && have_key) {
+        keep_asset(engine, cmd->path, source_key, player->pack_path);
+    }
+    return 0;
+}
+
+static void *engine_main(void *arg) {
+    anim_engine *engine = arg;
+
+    pthread_mutex_lock(&engine->lock);
+    while (1) {
+        while (engine->head == engine->tail) {
+            pthread_cond_wait(&engine->wake, &engine->lock);
+        }
+        anim_engine_command cmd = engine->queue[engine->tail % ANIM_ENGINE_QUEUE];
+        engine->tail++;
+        atomic_fetch_sub(&engine->pending, 1);
+
+        if (cmd.op == ANIM_ENGINE_QUIT) {
+            break;
+        }
+        // 后面还有命令时，这条播放命令已被取代
+        if (cmd.op == ANIM_ENGINE_PLAY && engine->head != engine->tail) {
+            engine->done_seq = cmd.seq;
+            continue;
+        }
+
+        engine->active = cmd.op == ANIM_ENGINE_PLAY;
+        pthread_mutex_unlock(&engine->lock);
+        int played = cmd.op == ANIM_ENGINE_PLAY && play_command(engine, &cmd) == 0;
+        // 停止或自然结束时交还画面；被下一条播放命令打断时保留，直接切换
+        // 播放完而后面没有命令，说明动画是自然结束的
+        int finished = 0;
+        if (atomic_load(&engine->pending) == 0) {
+            release_screen(engine);
+            finished = played;
+        }
+        pthread_mutex_lock(&engine->lock);
+        engine->active = 0;
+        engine->done_seq = cmd.seq;
+        pthread_cond_broadcast(&engine->done);
+        if (finished) {
+            // active 已清零：主线程收到通知时 anim_engine_busy 返回0
+            uint64_t one = 1;
+            ssize_t n = write(engine->finished_fd, &one, sizeof(one));
+            (void)n;
+        }
+    }
+    pthread_mutex_unlock(&engine->lock);
+
+    release_screen(engine);
+    return NULL;
+}
+
+static unsigned long push_command(anim_engine *engine, anim_engine_op op, const char *path,
+                                  int loop_once, int delay_ms) {
+    pthread_mutex_lock(&engine->lock);
+    if (engine->head - engine->tail == ANIM_ENGINE_QUEUE) {
+        // 队列已满：最后一条命令还没开始处理就会被新命令取代，直接覆盖
+        engine->head--;
+        atomic_fetch_sub(&engine->pending, 1);
+    }
+    anim_engine_command *cmd = &engine->queue[engine->head % ANIM_ENGINE_QUEUE];
+    cmd->op = op;
+    snprintf(cmd->path, sizeof(cmd->path), "%s", path ? path : "");
+    cmd->loop_once = loop_once;
+    cmd->delay_ms = delay_ms;
+    cmd->seq = ++engine->next_seq;
+    engine->head++;
+    atomic_fetch_add(&engine->pending, 1);
+    unsigned long seq = cmd->seq;
+    pthread_cond_signal(&engine->wake);
+    pthread_mutex_unlock(&engine->lock);
+    // 渲染线程可能正阻塞在解码队列上，唤醒它检查 should_stop
+    anim_player_wake(&engine->player);
+    return seq;
+}
+
+int anim_engine_start(anim_engine *engine) {
+    memset(engine, 0, sizeof(*engine));
+    if (fb_device_open(&engine->device, NULL) == -1) {
+        return -1;
+    }
+    engine->format = pixel_format_from_vinfo(&engine->device.vinfo);
+    if (!engine->format) {
+        fb_device_close(&engine->device);
+        return -1;
+    }
+
+    frame_cache_init(&engine->cache, -1);
+    // presenter 在播放时才初始化，这里只记录屏幕参数
+    engine->presenter.width = engine->device.vinfo.xres;
+    engine->presenter.height = engine->device.vinfo.yres;
+    engine->presenter.line_length = engine->device.finfo.line_length;
+    engine->presenter.format = engine->format;
+    anim_player_init(&engine->player, &engine->presenter, &engine->cache);
+    engine->player.should_stop = engine_should_stop;
+    engine->player.stop_arg = engine;
+    engine->player.clock.sleep = engine_sleep;
+    engine->player.clock.sleep_arg = engine;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&engine->lock, NULL);
+    pthread_cond_init(&engine->wake, &attr);
+    pthread_cond_init(&engine->done, NULL);
+    pthread_condattr_destroy(&attr);
+    atomic_init(&engine->pending, 0);
+    engine->finished_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (engine->finished_fd == -1) {
+        perror("Error creating animation eventfd");
+        pthread_mutex_destroy(&engine->lock);
+        pthread_cond_destroy(&engine->wake);
+        pthread_cond_destroy(&engine->done);
+        fb_device_close(&engine->device);
+        return -1;
+    }
+
+    // 渲染线程屏蔽所有信号，信号只由主线程处理
+    sigset_t all, saved;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &saved);
+    int err = pthread_create(&engine->thread, NULL, engine_main, engine);
+    pthread_sigmask(SIG_SETMASK, &saved, NULL);
+    if (err != 0) {
+        fprintf(stderr, "Error creating render thread\n");
+        close(engine->finished_fd);
+        pthread_mutex_destroy(&engine->lock);
+        pthread_cond_destroy(&engine->wake);
+        pthread_cond_destroy(&engine->done);
+        fb_device_close(&engine->device);
+        return -1;
+    }
+    return 0;
+}
+
+void anim_engine_destroy(anim_engine *engine) {
+    push_command(engine, ANIM_ENGINE_QUIT, NULL, 0, 0);
+    pthread_join(engine->thread, NULL);
+    for (int i = 0; i < engine->asset_count; i++) {
+        anim_pack_close(&engine->assets[i].pack);
+    }
+    engine->asset_count = 0;
+    pthread_mutex_destroy(&engine->lock);
+    pthread_cond_destroy(&engine->wake);
+    pthread_cond_destroy(&engine->done);
+    close(engine->finished_fd);
+    fb_device_close(&engine->device);
+}
+
+int anim_engine_play(anim_engine *engine, const char *path, int loop_once, int delay_ms) {
+    if (!path || strlen(path) >= sizeof(((anim_engine_command *)0)->path)) {
+        fprintf(stderr, "Invalid animation path\n");
+        return -1;
+    }
+    push_command(engine, ANIM_ENGINE_PLAY, path, loop_once, delay_ms);
+    return 0;
+}
+
+void anim_engine_stop(anim_engine *engine) {
+    unsigned long seq = push_command(engine, ANIM_ENGINE_STOP, NULL, 0, 0);
+    pthread_mutex_lock(&engine->lock);
+    while (engine->done_seq < seq) {
+        pthread_cond_wait(&engine->done, &engine->lock);
+    }
+    pthread_mutex_unlock(&engine->lock);
+}
+
+void anim_engine_wait(anim_engine *engine) {
+    pthread_mutex_lock(&engine->lock);
+    while (engine->head != engine->tail || engine->active) {
+        pthread_cond_wait(&engine->done, &engine->lock);
+    }
+    pthread_mutex_unlock(&engine->lock);
+}
+
+int anim_engine_busy(anim_engine *engine) {
+    pthread_mutex_lock(&engine->lock);
+    int busy = engine->head != engine->tail || engine->active;
+    pthread_mutex_unlock(&engine->lock);
+    return busy;
+}
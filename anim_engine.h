@@ -0,0 +1,86 @@
+#ifndef ANIM_ENGINE_H
+#define ANIM_ENGINE_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "anim_pack.h"
+#include "anim_player.h"
+#include "fb_backend.h"
+#include "fb_present.h"
+#include "frame_cache.h"
+
+// 进程内动画引擎：sys_boot 启动时打开一次帧缓冲，由独立的渲染线程播放动画
+// 主线程通过命令队列发送播放、停止命令，渲染线程每帧检查队列，等待帧显示时刻时
+// 也会被新命令唤醒，切换动画在一帧之内完成，新动画的第一帧直接覆盖旧画面
+// 播放过的动画包（预转换包或解码缓存包）保持映射，再次播放时不再扫描目录和查缓存；
+// 源内容有变化（任一帧文件被替换或修改）、包文件被重建或被缓存淘汰删除时丢弃映射，重新查找
+// 动画停止或播放结束后画面交还到第0页，show_text 等程序可以直接绘制
+
+#define ANIM_ENGINE_QUEUE  8       // 命令队列长度
+#define ANIM_ENGINE_ASSETS 8       // 保持映射的动画包个数
+
+typedef enum {
+    ANIM_ENGINE_PLAY,
+    ANIM_ENGINE_STOP,
+    ANIM_ENGINE_QUIT,
+} anim_engine_op;
+
+typedef struct {
+    anim_engine_op op;
+    char path[256];
+    int loop_once;
+    int delay_ms;
+    unsigned long seq;
+} anim_engine_command;
+
+// 已映射的动画包，按源路径（目录、GIF 或动画包）查找
+typedef struct {
+    char path[256];
+    anim_pack pack;
+    char pack_path[512];
+    uint64_t source_key;        // 映射时源内容的键（anim_player_source_key）
+    unsigned long last_used;
+} anim_engine_asset;
+
+typedef struct {
+    fb_device device;
+    const pixel_format *format;
+    fb_presenter presenter;
+    int presenting;             // 渲染线程持有画面（presenter 已初始化）
+    frame_cache cache;
+    anim_player player;
+    anim_engine_asset assets[ANIM_ENGINE_ASSETS];
+    int asset_count;
+    unsigned long uses;
+
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;        // 有新命令（CLOCK_MONOTONIC，渲染线程按帧显示时刻等待）
+    pthread_cond_t done;        // 命令已处理或动画播放结束
+    anim_engine_command queue[ANIM_ENGINE_QUEUE];
+    unsigned int head;
+    unsigned int tail;
+    atomic_int pending;         // 排队中的命令数，播放时每帧检查
+    unsigned long next_seq;
+    unsigned long done_seq;     // 已处理完的最后一条命令
+    int active;                 // 正在播放
+    int finished_fd;            // eventfd：动画自然播放结束时可读，供主线程事件循环等待
+} anim_engine;
+
+// 打开帧缓冲（AKU_FB）并启动渲染线程，成功返回0
+int anim_engine_start(anim_engine *engine);
+// 停止渲染线程，释放动画包并关闭帧缓冲
+void anim_engine_destroy(anim_engine *engine);
+
+// 切换到 path 指向的动画（动画包、含 anim.akp 的目录、GIF 或 BMP 序列目录），不等待
+int anim_engine_play(anim_engine *engine, const char *path, int loop_once, int delay_ms);
+// 停止当前动画，返回时画面已交还到第0页
+void anim_engine_stop(anim_engine *engine);
+// 等待排队的命令和当前动画都结束（用于只播放一次的动画）
+void anim_engine_wait(anim_engine *engine);
+// 是否有动画正在播放或等待播放
+int anim_engine_busy(anim_engine *engine);
+
+#endif
@@ -0,0 +1,457 @@
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "anim_pack.h"
+
+// 校验差分帧：矩形不越界，数据长度与矩形面积一致
+static int check_delta_frame(const unsigned char *data, uint32_t size, int width, int height) {
+    if (size < sizeof(anim_pack_delta)) {
+        return -1;
+    }
+    const anim_pack_delta *delta = (const anim_pack_delta *)data;
+    size_t expected = sizeof(anim_pack_delta) + delta->rect_count * sizeof(anim_pack_rect);
+    if (expected > size) {
+        return -1;
+    }
+    const anim_pack_rect *rects = (const anim_pack_rect *)(data + sizeof(anim_pack_delta));
+    for (int i = 0; i < delta->rect_count; i++) {
+        if (rects[i].w == 0 || rects[i].h == 0 ||
+            rects[i].x + rects[i].w > width || rects[i].y + rects[i].h > height) {
+            return -1;
+        }
+        expected += (size_t)rects[i].w * rects[i].h * 2;
+    }
+    return expected == size ? 0 : -1;
+}
+
+// 打开并映射动画包
+int anim_pack_open(anim_pack *pack, const char *path) {
+    memset(pack, 0, sizeof(*pack));
+    pack->fd = -1;
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        perror("Error opening animation pack");
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        perror("Error reading animation pack size");
+        close(fd);
+        return -1;
+    }
+
+    if ((size_t)st.st_size < sizeof(anim_pack_header)) {
+        fprintf(stderr, "Animation pack too small: %s\n", path);
+        close(fd);
+        return -1;
+    }
+
+    unsigned char *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        perror("Error mapping animation pack");
+        close(fd);
+        return -1;
+    }
+
+    const anim_pack_header *header = (const anim_pack_header *)map;
+    size_t frame_bytes = (size_t)header->width * header->height * 2;
+    size_t index_end = (size_t)header->index_offset +
+                       (size_t)header->frame_count * sizeof(anim_pack_frame);
+
+    if (memcmp(header->magic, ANIM_PACK_MAGIC, 4) != 0 ||
+        header->version < 1 || header->version > ANIM_PACK_VERSION ||
+        header->pixel_format != ANIM_PACK_FMT_RGB565 ||
+        header->frame_count == 0 ||
+        header->index_offset % 4 != 0 ||  // 索引表按 uint32_t 直接访问，必须4字节对齐
+        index_end > (size_t)st.st_size) {
+        fprintf(stderr, "Invalid animation pack: %s\n", path);
+        munmap(map, st.st_size);
+        close(fd);
+        return -1;
+    }
+
+    const anim_pack_frame *frames = (const anim_pack_frame *)(map + header->index_offset);
+
+    // 校验每一帧的范围，播放时就不必再检查
+    for (uint32_t i = 0; i < header->frame_count; i++) {
+        // 版本1没有帧标志，全部是关键帧
+        int is_key = header->version == 1 || (frames[i].flags & ANIM_PACK_FRAME_KEY);
+        int valid = (size_t)frames[i].offset + frames[i].size <= (size_t)st.st_size &&
+                    frames[i].offset % 2 == 0;
+        if (valid && is_key) {
+            valid = frames[i].size == frame_bytes;
+        } else if (valid) {
+            // 第一帧必须是关键帧，否则无从叠加
+            valid = i > 0 &&
+                    check_delta_frame(map + frames[i].offset, frames[i].size,
+                                      header->width, header->height) == 0;
+        }
+        if (!valid) {
+            fprintf(stderr, "Invalid frame %u in animation pack: %s\n", i, path);
+            munmap(map, st.st_size);
+            close(fd);
+            return -1;
+        }
+    }
+
+    // 顺序播放，提示内核预读
+    madvise(map, st.st_size, MADV_WILLNEED);
+
+    pack->fd = fd;
+    pack->map = map;
+    pack->map_size = st.st_size;
+    pack->header = header;
+    pack->frames = frames;
+    return 0;
+}
+
+int anim_pack_frame_is_key(const anim_pack *pack, int index) {
+    return pack->header->version == 1 || (pack->frames[index].flags & ANIM_PACK_FRAME_KEY);
+}
+
+int anim_pack_frame_rects(const anim_pack *pack, int index, anim_pack_rect *key_rect,
+                          const anim_pack_rect **rects, const uint16_t **pixels) {
+    const unsigned char *data = pack->map + pack->frames[index].offset;
+
+    if (anim_pack_frame_is_key(pack, index)) {
+        key_rect->x = 0;
+        key_rect->y = 0;
+        key_rect->w = pack->header->width;
+        key_rect->h = pack->header->height;
+        *rects = key_rect;
+        *pixels = (const uint16_t *)data;
+        return 1;
+    }
+
+    const anim_pack_delta *delta = (const anim_pack_delta *)data;
+    *rects = (const anim_pack_rect *)(data + sizeof(anim_pack_delta));
+    *pixels = (const uint16_t *)(data + sizeof(anim_pack_delta) +
+                                 delta->rect_count * sizeof(anim_pack_rect));
+    return delta->rect_count;
+}
+
+int anim_pack_keyframe_before(const anim_pack *pack, int index) {
+    while (index > 0 && !anim_pack_frame_is_key(pack, index)) {
+        index--;
+    }
+    return index;
+}
+
+void anim_pack_render_frame(const anim_pack *pack, int index, uint16_t *canvas) {
+    int width = pack->header->width;
+
+    for (int frame = anim_pack_keyframe_before(pack, index); frame <= index; frame++) {
+        anim_pack_rect key_rect;
+        const anim_pack_rect *rects;
+        const uint16_t *pixels;
+        int count = anim_pack_frame_rects(pack, frame, &key_rect, &rects, &pixels);
+
+        for (int i = 0; i < count; i++) {
+            for (int y = 0; y < rects[i].h; y++) {
+                memcpy(canvas + (rects[i].y + y) * width + rects[i].x, pixels, rects[i].w * 2);
+                pixels += rects[i].w;
+            }
+        }
+    }
+}
+
+void anim_pack_close(anim_pack *pack) {
+    if (pack->map) {
+        munmap(pack->map, pack->map_size);
+    }
+    if (pack->fd != -1) {
+        close(pack->fd);
+    }
+    memset(pack, 0, sizeof(*pack));
+    pack->fd = -1;
+}
+
+int anim_pack_read_source_hash(const char *path, uint64_t *hash) {
+    anim_pack_header header;
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        return -1;
+    }
+    ssize_t n = pread(fd, &header, sizeof(header), 0);
+    close(fd);
+
+    if (n != sizeof(header) || memcmp(header.magic, ANIM_PACK_MAGIC, 4) != 0 ||
+        header.version < 2 || header.version > ANIM_PACK_VERSION) {
+        return -1;
+    }
+    *hash = header.source_hash;
+    return 0;
+}
+
+// 按对齐要求补零
+static int write_padding(anim_pack_writer *writer) {
+    static const unsigned char zeros[ANIM_PACK_ALIGN];
+    uint32_t pad = (ANIM_PACK_ALIGN - writer->data_offset % ANIM_PACK_ALIGN) % ANIM_PACK_ALIGN;
+    if (pad && fwrite(zeros, 1, pad, writer->fp) != pad) {
+        return -1;
+    }
+    writer->data_offset += pad;
+    return 0;
+}
+
+int anim_pack_writer_open(anim_pack_writer *writer, const char *path, int width, int height,
+                          int keyframe_interval) {
+    memset(writer, 0, sizeof(*writer));
+
+    if (width <= 0 || height <= 0 || width > 0xFFFF || height > 0xFFFF) {
+        fprintf(stderr, "Invalid animation size: %dx%d\n", width, height);
+        return -1;
+    }
+    if (keyframe_interval <= 0) {
+        keyframe_interval = ANIM_PACK_DEFAULT_KEYFRAME_INTERVAL;
+    }
+    if (keyframe_interval > 0xFFFF) {
+        keyframe_interval = 0xFFFF;
+    }
+
+    writer->path = strdup(path);
+    writer->tmp_path = malloc(strlen(path) + 8);
+    writer->prev_pixels = malloc((size_t)width * height * 2);
+    if (!writer->path || !writer->tmp_path || !writer->prev_pixels) {
+        perror("Error allocating animation pack writer");
+        free(writer->path);
+        free(writer->tmp_path);
+        free(writer->prev_pixels);
+        return -1;
+    }
+    // 临时文件名唯一：多个进程可能同时写同一个动画包（如多个播放器填充同一缓存条目）
+    sprintf(writer->tmp_path, "%s.XXXXXX", path);
+    int fd = mkstemp(writer->tmp_path);
+    if (fd != -1 && (fchmod(fd, 0644) == -1 || !(writer->fp = fdopen(fd, "wb")))) {
+        close(fd);
+        unlink(writer->tmp_path);
+    }
+    if (!writer->fp) {
+        perror("Error creating animation pack");
+        free(writer->path);
+        free(writer->tmp_path);
+        free(writer->prev_pixels);
+        return -1;
+    }
+
+    memcpy(writer->header.magic, ANIM_PACK_MAGIC, 4);
+    writer->header.version = ANIM_PACK_VERSION;
+    writer->header.pixel_format = ANIM_PACK_FMT_RGB565;
+    writer->header.width = width;
+    writer->header.height = height;
+    writer->header.keyframe_interval = keyframe_interval;
+
+    // 先写入占位文件头，关闭时回填
+    if (fwrite(&writer->header, sizeof(writer->header), 1, writer->fp) != 1) {
+        perror("Error writing animation pack header");
+        anim_pack_writer_abort(writer);
+        return -1;
+    }
+    writer->data_offset = sizeof(writer->header);
+    return 0;
+}
+
+// 比较当前帧与上一帧，按块找出变化区域并编码到 delta_buf
+// 同一块行内相邻的变化块合并成横向区间，上下区间范围相同则继续合并成矩形
+// 返回编码后的字节数，超过整帧大小时返回0（改写关键帧更划算）
+static size_t encode_delta(anim_pack_writer *writer, const uint16_t *pixels) {
+    int width = writer->header.width;
+    int height = writer->header.height;
+    int tiles_x = (width + ANIM_PACK_TILE_SIZE - 1) / ANIM_PACK_TILE_SIZE;
+    int tiles_y = (height + ANIM_PACK_TILE_SIZE - 1) / ANIM_PACK_TILE_SIZE;
+    size_t frame_bytes = (size_t)width * height * 2;
+
+    // 最坏情况每块一个矩形
+    size_t max_rects = (size_t)tiles_x * tiles_y;
+    size_t needed = sizeof(anim_pack_delta) + max_rects * sizeof(anim_pack_rect) + frame_bytes;
+    if (needed > writer->delta_capacity) {
+        unsigned char *buf = realloc(writer->delta_buf, needed);
+        if (!buf) {
+            return 0;
+        }
+        writer->delta_buf = buf;
+        writer->delta_capacity = needed;
+    }
+
+    anim_pack_rect *rects = (anim_pack_rect *)(writer->delta_buf + sizeof(anim_pack_delta));
+    int rect_count = 0;
+    int open_begin = 0;  // 上一块行结束时仍可向下延伸的矩形范围 [open_begin, rect_count)
+
+    for (int ty = 0; ty < tiles_y; ty++) {
+        int y0 = ty * ANIM_PACK_TILE_SIZE;
+        int h = height - y0 < ANIM_PACK_TILE_SIZE ? height - y0 : ANIM_PACK_TILE_SIZE;
+        int row_begin = rect_count;
+
+        for (int tx = 0; tx < tiles_x; ) {
+            // 找到下一段连续变化的块
+            int changed = 0;
+            int start = tx;
+            for (; tx < tiles_x; tx++) {
+                int x0 = tx * ANIM_PACK_TILE_SIZE;
+                int w = width - x0 < ANIM_PACK_TILE_SIZE ? width - x0 : ANIM_PACK_TILE_SIZE;
+                int diff = 0;
+                for (int y = y0; y < y0 + h && !diff; y++) {
+                    diff = memcmp(pixels + y * width + x0, writer->prev_pixels + y * width + x0, w * 2);
+                }
+                if (diff) {
+                    if (!changed) start = tx;
+                    changed = 1;
+                } else if (changed) {
+                    break;
+                }
+            }
+            if (!changed) {
+                break;
+            }
+
+            int x0 = start * ANIM_PACK_TILE_SIZE;
+            int x1 = tx * ANIM_PACK_TILE_SIZE < width ? tx * ANIM_PACK_TILE_SIZE : width;
+
+            // 与上一块行中范围相同的矩形合并
+            int merged = 0;
+            for (int i = open_begin; i < row_begin; i++) {
+                if (rects[i].x == x0 && rects[i].w == x1 - x0 && rects[i].y + rects[i].h == y0) {
+                    rects[i].h += h;
+                    // 移到本块行末尾，保持下一行只需检查 [row_begin, rect_count)
+                    anim_pack_rect tmp = rects[i];
+                    memmove(&rects[i], &rects[i + 1], (rect_count - i - 1) * sizeof(anim_pack_rect));
+                    rects[rect_count - 1] = tmp;
+                    row_begin--;
+                    merged = 1;
+                    break;
+                }
+            }
+            if (!merged) {
+                rects[rect_count].x = x0;
+                rects[rect_count].y = y0;
+                rects[rect_count].w = x1 - x0;
+                rects[rect_count].h = h;
+                rect_count++;
+            }
+        }
+        open_begin = row_begin;
+    }
+
+    size_t size = sizeof(anim_pack_delta) + rect_count * sizeof(anim_pack_rect);
+    for (int i = 0; i < rect_count; i++) {
+        size += (size_t)rects[i].w * rects[i].h * 2;
+    }
+    if (size >= frame_bytes || rect_count > 0xFFFF) {
+        return 0;
+    }
+
+    anim_pack_delta *delta = (anim_pack_delta *)writer->delta_buf;
+    delta->rect_count = rect_count;
+    delta->reserved = 0;
+
+    uint16_t *out = (uint16_t *)(writer->delta_buf + sizeof(anim_pack_delta) +
+                                 rect_count * sizeof(anim_pack_rect));
+    for (int i = 0; i < rect_count; i++) {
+        for (int y = 0; y < rects[i].h; y++) {
+            memcpy(out, pixels + (rects[i].y + y) * width + rects[i].x, rects[i].w * 2);
+            out += rects[i].w;
+        }
+    }
+    return size;
+}
+
+int anim_pack_writer_add_frame(anim_pack_writer *writer, const uint16_t *pixels, int delay_ms) {
+    if (writer->header.frame_count == writer->frame_capacity) {
+        uint32_t capacity = writer->frame_capacity ? writer->frame_capacity * 2 : 64;
+        anim_pack_frame *frames = realloc(writer->frames, capacity * sizeof(anim_pack_frame));
+        if (!frames) {
+            perror("Error allocating frame index");
+            return -1;
+        }
+        writer->frames = frames;
+        writer->frame_capacity = capacity;
+    }
+
+    if (write_padding(writer) == -1) {
+        perror("Error writing animation pack");
+        return -1;
+    }
+
+    uint32_t frame_bytes = (uint32_t)writer->header.width * writer->header.height * 2;
+    const void *data = pixels;
+    uint32_t size = frame_bytes;
+    uint16_t flags = ANIM_PACK_FRAME_KEY;
+
+    if (writer->header.frame_count % writer->header.keyframe_interval != 0) {
+        size_t delta_size = encode_delta(writer, pixels);
+        if (delta_size > 0) {
+            data = writer->delta_buf;
+            size = delta_size;
+            flags = 0;
+        }
+    }
+
+    if (size && fwrite(data, 1, size, writer->fp) != size) {
+        perror("Error writing frame data");
+        return -1;
+    }
+    memcpy(writer->prev_pixels, pixels, frame_bytes);
+
+    anim_pack_frame *frame = &writer->frames[writer->header.frame_count++];
+    frame->offset = writer->data_offset;
+    frame->size = size;
+    frame->delay_ms = (delay_ms > 0 && delay_ms <= 0xFFFF) ? delay_ms : 0;
+    frame->flags = flags;
+    writer->data_offset += size;
+    return 0;
+}
+
+int anim_pack_writer_close(anim_pack_writer *writer) {
+    if (writer->header.frame_count == 0) {
+        fprintf(stderr, "Animation pack has no frames: %s\n", writer->path);
+        anim_pack_writer_abort(writer);
+        return -1;
+    }
+
+    if (write_padding(writer) == -1 ||
+        fwrite(writer->frames, sizeof(anim_pack_frame), writer->header.frame_count, writer->fp)
+            != writer->header.frame_count) {
+        perror("Error writing frame index");
+        anim_pack_writer_abort(writer);
+        return -1;
+    }
+
+    writer->header.index_offset = writer->data_offset;
+    if (fseek(writer->fp, 0, SEEK_SET) != 0 ||
+        fwrite(&writer->header, sizeof(writer->header), 1, writer->fp) != 1) {
+        perror("Error writing animation pack header");
+        anim_pack_writer_abort(writer);
+        return -1;
+    }
+
+    int closed = fclose(writer->fp);
+    writer->fp = NULL;
+    if (closed != 0 || rename(writer->tmp_path, writer->path) == -1) {
+        perror("Error saving animation pack");
+        unlink(writer->tmp_path);
+        anim_pack_writer_abort(writer);
+        return -1;
+    }
+
+    anim_pack_writer_abort(writer);
+    return 0;
+}
+
+void anim_pack_writer_abort(anim_pack_writer *writer) {
+    if (writer->fp) {
+        fclose(writer->fp);
+        unlink(writer->tmp_path);
+    }
+    free(writer->frames);
+    free(writer->path);
+    free(writer->tmp_path);
+    free(writer->prev_pixels);
+    free(writer->delta_buf);
+    memset(writer, 0, sizeof(*writer));
+}
@@ -0,0 +1,110 @@
+#ifndef ANIM_PACK_H
+#define ANIM_PACK_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// 动画包格式（.akp）
+// 文件布局：文件头 | 帧数据... | 帧索引表
+// 帧数据已是面板原生像素格式（RGB565，小端），播放端 mmap 后直接拷贝，无需解码
+// 关键帧保存整帧像素；差分帧只保存相对上一帧发生变化的矩形区域：
+//   anim_pack_delta | anim_pack_rect[rect_count] | 各矩形像素（按矩形顺序逐行存放）
+#define ANIM_PACK_MAGIC      "AKUP"
+#define ANIM_PACK_VERSION    2           // 版本1只有关键帧，仍可读取
+#define ANIM_PACK_EXT        ".akp"
+#define ANIM_PACK_DIR_FILE   "anim.akp"  // 目录中的动画包文件名，播放器优先使用
+#define ANIM_PACK_ALIGN      16          // 帧数据对齐字节数
+#define ANIM_PACK_DEFAULT_KEYFRAME_INTERVAL 30
+#define ANIM_PACK_TILE_SIZE  8           // 生成差分帧时比较的块大小
+
+// 像素格式
+#define ANIM_PACK_FMT_RGB565 1
+
+// 文件头（32字节）
+typedef struct {
+    char magic[4];           // "AKUP"
+    uint16_t version;        // 格式版本
+    uint16_t pixel_format;   // 像素格式
+    uint16_t width;          // 帧宽度
+    uint16_t height;         // 帧高度
+    uint32_t frame_count;    // 帧数
+    uint32_t index_offset;   // 帧索引表在文件中的偏移
+    uint16_t keyframe_interval; // 每隔多少帧强制一个关键帧
+    uint16_t reserved0;
+    uint64_t source_hash;    // 生成该包的源数据哈希，用于跳过未变化的重建
+} anim_pack_header;
+
+// 帧标志
+#define ANIM_PACK_FRAME_KEY  0x0001      // 关键帧（整帧像素）
+
+// 帧索引项（12字节）
+typedef struct {
+    uint32_t offset;         // 帧数据在文件中的偏移
+    uint32_t size;           // 帧数据字节数
+    uint16_t delay_ms;       // 帧延迟，0 表示使用播放器的 -d 参数
+    uint16_t flags;
+} anim_pack_frame;
+
+// 差分帧头
+typedef struct {
+    uint16_t rect_count;
+    uint16_t reserved;
+} anim_pack_delta;
+
+// 变化区域
+typedef struct {
+    uint16_t x, y, w, h;
+} anim_pack_rect;
+
+// 只读映射的动画包
+typedef struct {
+    int fd;
+    unsigned char *map;
+    size_t map_size;
+    const anim_pack_header *header;
+    const anim_pack_frame *frames;
+} anim_pack;
+
+// 打开并映射动画包，成功返回0，失败返回-1
+int anim_pack_open(anim_pack *pack, const char *path);
+// 第 index 帧是否为关键帧
+int anim_pack_frame_is_key(const anim_pack *pack, int index);
+// 获取第 index 帧的变化区域和像素数据（指向映射区域，不可修改），返回矩形个数
+// 关键帧返回覆盖整帧的一个矩形，rect 由调用者提供存储
+int anim_pack_frame_rects(const anim_pack *pack, int index, anim_pack_rect *key_rect,
+                          const anim_pack_rect **rects, const uint16_t **pixels);
+// 不晚于 index 的最近关键帧
+int anim_pack_keyframe_before(const anim_pack *pack, int index);
+// 从最近关键帧开始叠加差分，得到第 index 帧的完整画面（width * height 个像素）
+void anim_pack_render_frame(const anim_pack *pack, int index, uint16_t *canvas);
+void anim_pack_close(anim_pack *pack);
+// 只读取文件头中的源数据哈希，文件不存在或无效时返回-1
+int anim_pack_read_source_hash(const char *path, uint64_t *hash);
+
+// 动画包写入器：先写入唯一命名的临时文件，关闭时再重命名，避免播放端读到半成品
+typedef struct {
+    FILE *fp;
+    char *path;
+    char *tmp_path;
+    anim_pack_header header;
+    anim_pack_frame *frames;
+    uint32_t frame_capacity;
+    uint32_t data_offset;
+    uint16_t *prev_pixels;   // 上一帧画面，用于生成差分
+    unsigned char *delta_buf;
+    size_t delta_capacity;
+} anim_pack_writer;
+
+// keyframe_interval 为 0 时使用默认值，为 1 时全部写成关键帧
+// 关闭前可直接设置 writer->header.source_hash
+int anim_pack_writer_open(anim_pack_writer *writer, const char *path, int width, int height,
+                          int keyframe_interval);
+// 追加一帧 RGB565 像素（width * height 个），自动选择关键帧或差分帧
+int anim_pack_writer_add_frame(anim_pack_writer *writer, const uint16_t *pixels, int delay_ms);
+// 写入索引表并落盘，成功返回0
+int anim_pack_writer_close(anim_pack_writer *writer);
+// 放弃写入，删除临时文件
+void anim_pack_writer_abort(anim_pack_writer *writer);
+
+#endif
@@ -0,0 +1,651 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <strings.h>
+#include <dirent.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#include "anim_player.h"
+#include "frame_queue.h"
+#include "bmp_fast.h"
+
+void anim_player_init(anim_player *player, fb_presenter *presenter, frame_cache *cache) {
+    memset(player, 0, sizeof(*player));
+    player->presenter = presenter;
+    player->cache = cache;
+    player->queue_depth = FRAME_QUEUE_DEFAULT_DEPTH;
+    player->width = presenter->width;
+    player->height = presenter->height;
+    player->line_length = presenter->line_length;
+    player->format = presenter->format;
+    frame_clock_init(&player->clock, FRAME_CLOCK_STRETCH);
+    pthread_mutex_init(&player->queue_lock, NULL);
+}
+
+static int player_stopped(const anim_player *player) {
+    return player->should_stop && player->should_stop(player->stop_arg);
+}
+
+// 登记显示线程正在等待的解码队列，anim_player_wake 通过它唤醒
+static void set_waiting_queue(anim_player *player, frame_queue *queue) {
+    pthread_mutex_lock(&player->queue_lock);
+    player->queue = queue;
+    pthread_mutex_unlock(&player->queue_lock);
+}
+
+void anim_player_wake(anim_player *player) {
+    pthread_mutex_lock(&player->queue_lock);
+    if (player->queue) {
+        frame_queue_wake(player->queue);
+    }
+    pthread_mutex_unlock(&player->queue_lock);
+}
+
+static int compare_filenames(const void* a, const void* b) {
+    return strcmp(*(const char**)a, *(const char**)b);
+}
+
+// 是否为GIF文件（按扩展名判断）
+static int is_gif_path(const char *path) {
+    size_t len = strlen(path);
+    return len > 4 && strcasecmp(path + len - 4, ".gif") == 0;
+}
+
+// 查找动画包：参数本身是文件，或目录下存在 anim.akp
+static int find_anim_pack(const char *path, char *pack_path, size_t size) {
+    struct stat st;
+    if (stat(path, &st) == 0 && S_ISREG(st.st_mode)) {
+        snprintf(pack_path, size, "%s", path);
+        return 1;
+    }
+    snprintf(pack_path, size, "%s/%s", path, ANIM_PACK_DIR_FILE);
+    return stat(pack_path, &st) == 0 && S_ISREG(st.st_mode);
+}
+
+// 开始一帧；cover 为本帧整块重绘的帧内区域（居中后换算到屏幕坐标），
+// 只更新部分区域的差分帧传 NULL
+static void begin_frame(anim_player *player, int img_width, int img_height,
+                        const anim_pack_rect *cover) {
+    fb_rect screen_cover;
+    if (cover) {
+        screen_cover.x = (player->width - img_width) / 2 + cover->x;
+        screen_cover.y = (player->height - img_height) / 2 + cover->y;
+        screen_cover.w = cover->w;
+        screen_cover.h = cover->h;
+    }
+    player->target = fb_presenter_begin(player->presenter, cover ? &screen_cover : NULL);
+}
+
+// 等到本帧的显示时刻后提交：翻页或拷贝变化区域，需要时保存画面
+// delay_ms 为本帧的显示时长；等待被打断时不提交
+static void present_frame(anim_player *player, int delay_ms) {
+    if (frame_clock_wait(&player->clock, delay_ms) == 0) {
+        fb_presenter_present(player->presenter);
+    }
+}
+
+// 将帧内的一个RGB565矩形转换为屏幕像素格式，写入本帧绘制目标并标记变化区域
+// 帧整体居中，超出屏幕的部分裁剪掉；pixels 为该矩形的像素，按行紧密存放
+static void blit_rgb565_rect(const anim_player *player, int img_width, int img_height,
+                             const anim_pack_rect *rect, const uint16_t *pixels) {
+    int fb_width = player->width;
+    int fb_height = player->height;
+    int bytes_per_pixel = player->format->bytes_per_pixel;
+    int dst_x = (fb_width - img_width) / 2 + rect->x;
+    int dst_y = (fb_height - img_height) / 2 + rect->y;
+
+    int src_x = dst_x < 0 ? -dst_x : 0;
+    int src_y = dst_y < 0 ? -dst_y : 0;
+    int copy_width = rect->w - src_x;
+    int copy_height = rect->h - src_y;
+    if (dst_x + src_x + copy_width > fb_width) copy_width = fb_width - dst_x - src_x;
+    if (dst_y + src_y + copy_height > fb_height) copy_height = fb_height - dst_y - src_y;
+    if (copy_width <= 0 || copy_height <= 0) return;
+
+    for (int y = 0; y < copy_height; y++) {
+        size_t offset = (size_t)(dst_y + src_y + y) * player->line_length +
+                        (dst_x + src_x) * bytes_per_pixel;
+        const uint16_t *row = pixels + (src_y + y) * rect->w + src_x;
+        player->format->from_rgb565_row(row, player->target + offset, copy_width);
+    }
+    fb_presenter_damage(player->presenter, dst_x + src_x, dst_y + src_y, copy_width, copy_height);
+}
+
+// 播放动画包：帧数据直接从映射区域拷贝，无解码、无逐帧分配
+// 差分帧只写入变化的矩形；从中间帧开始播放时先从最近的关键帧叠加出完整画面
+int anim_player_play_pack(anim_player *player, const anim_pack *pack, int delay_ms, int loop_once,
+                          int start_frame) {
+    int width = pack->header->width;
+    int height = pack->header->height;
+    int frame_count = pack->header->frame_count;
+
+    int frame = 0;
+    if (start_frame > 0) {
+        frame = start_frame % frame_count;
+        uint16_t *canvas = malloc((size_t)width * height * 2);
+        if (!canvas) {
+            perror("Error allocating seek canvas");
+            return 1;
+        }
+        anim_pack_render_frame(pack, frame, canvas);
+        anim_pack_rect full = {0, 0, width, height};
+        begin_frame(player, width, height, &full);
+        blit_rgb565_rect(player, width, height, &full, canvas);
+        free(canvas);
+        present_frame(player, pack->frames[frame].delay_ms ? pack->frames[frame].delay_ms : delay_ms);
+        frame++;
+    }
+
+    do {
+        for (; frame < frame_count && !player_stopped(player); frame++) {
+            anim_pack_rect key_rect;
+            const anim_pack_rect *rects;
+            const uint16_t *pixels;
+            int count = anim_pack_frame_rects(pack, frame, &key_rect, &rects, &pixels);
+
+            // 差分帧依赖前一帧，丢帧时照常绘制，只是不提交，变化区域并入下一次提交
+            begin_frame(player, width, height,
+                        anim_pack_frame_is_key(pack, frame) ? &key_rect : NULL);
+            for (int i = 0; i < count; i++) {
+                blit_rgb565_rect(player, width, height, &rects[i], pixels);
+                pixels += rects[i].w * rects[i].h;
+            }
+
+            int frame_delay = pack->frames[frame].delay_ms ? pack->frames[frame].delay_ms : delay_ms;
+            if (!frame_clock_drop(&player->clock, frame_delay)) {
+                present_frame(player, frame_delay);
+            }
+        }
+        frame = 0;
+    } while (!loop_once && !player_stopped(player));
+
+    return 0;
+}
+
+static int play_pack_file(anim_player *player, const char *pack_path, int delay_ms, int loop_once,
+                          int start_frame) {
+    anim_pack pack;
+    if (anim_pack_open(&pack, pack_path) == -1) {
+        return 1;
+    }
+    snprintf(player->pack_path, sizeof(player->pack_path), "%s", pack_path);
+    printf("Playing pack %s: %d frames (%dx%d)\n", pack_path, (int)pack.header->frame_count,
+           pack.header->width, pack.header->height);
+
+    int ret = anim_player_play_pack(player, &pack, delay_ms, loop_once, start_frame);
+    anim_pack_close(&pack);
+    return ret;
+}
+
+// 播放GIF：开始前一次性解码全部帧并转换为RGB565，存放在预分配的连续缓冲区中
+// 播放时只做拷贝，按GIF自带的帧延迟播放
+// 解码结果同时写入帧缓存，下次播放同一文件时直接使用缓存包
+static int play_gif(anim_player *player, const char *gif_path, int delay_ms, int loop_once) {
+    frame_cache *cache = player->cache;
+    uint64_t cache_key = frame_cache_key(&gif_path, 1);
+    char cache_path[300];
+    if (cache && frame_cache_lookup(cache, cache_key, cache_path, sizeof(cache_path))) {
+        frame_cache_report(cache);
+        return play_pack_file(player, cache_path, delay_ms, loop_once, 0);
+    }
+    if (cache) {
+        frame_cache_report(cache);
+    }
+
+    FILE *fp = fopen(gif_path, "rb");
+    if (!fp) {
+        perror("Error opening GIF");
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fileno(fp), &st) == -1 || st.st_size <= 0) {
+        perror("Error reading GIF size");
+        fclose(fp);
+        return 1;
+    }
+    unsigned char *file_data = malloc(st.st_size);
+    if (!file_data || fread(file_data, 1, st.st_size, fp) != (size_t)st.st_size) {
+        perror("Error reading GIF");
+        free(file_data);
+        fclose(fp);
+        return 1;
+    }
+    fclose(fp);
+
+    int *delays = NULL;
+    int width, height, frame_count, channels;
+    unsigned char *rgba = stbi_load_gif_from_memory(file_data, st.st_size, &delays,
+                                                    &width, &height, &frame_count, &channels, 4);
+    free(file_data);
+    if (!rgba) {
+        printf("Error loading GIF %s: %s\n", gif_path, stbi_failure_reason());
+        return 1;
+    }
+
+    size_t frame_pixels = (size_t)width * height;
+    uint16_t *frames = malloc(frame_pixels * frame_count * 2);
+    if (!frames) {
+        perror("Error allocating GIF frames");
+        stbi_image_free(rgba);
+        free(delays);
+        return 1;
+    }
+
+    // 透明部分合成到黑色背景上
+    for (size_t i = 0; i < frame_pixels * frame_count; i++) {
+        const unsigned char *p = rgba + i * 4;
+        unsigned char r = p[0] * p[3] / 255;
+        unsigned char g = p[1] * p[3] / 255;
+        unsigned char b = p[2] * p[3] / 255;
+        frames[i] = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+    }
+    stbi_image_free(rgba);
+
+    anim_pack_writer cache_writer;
+    if (cache && frame_cache_store_begin(cache, cache_key, width, height, &cache_writer) == 0) {
+        int ok = 1;
+        for (int frame = 0; frame < frame_count && ok; frame++) {
+            ok = anim_pack_writer_add_frame(&cache_writer, frames + frame * frame_pixels,
+                                            delays ? delays[frame] : 0) == 0;
+        }
+        if (ok) {
+            if (frame_cache_store_commit(cache, &cache_writer, cache_path, sizeof(cache_path)) == 0) {
+                snprintf(player->pack_path, sizeof(player->pack_path), "%s", cache_path);
+            }
+        } else {
+            anim_pack_writer_abort(&cache_writer);
+        }
+    }
+
+    printf("Playing GIF %s: %d frames (%dx%d)\n", gif_path, frame_count, width, height);
+
+    anim_pack_rect full = {0, 0, width, height};
+
+    do {
+        for (int frame = 0; frame < frame_count && !player_stopped(player); frame++) {
+            int frame_delay = delays && delays[frame] > 0 ? delays[frame] : delay_ms;
+            if (frame_clock_drop(&player->clock, frame_delay)) {
+                continue;
+            }
+            begin_frame(player, width, height, &full);
+            blit_rgb565_rect(player, width, height, &full, frames + frame * frame_pixels);
+            present_frame(player, frame_delay);
+        }
+    } while (!loop_once && !player_stopped(player));
+
+    free(frames);
+    free(delays);
+    return 0;
+}
+
+// 后台解码线程的上下文
+typedef struct {
+    char **files;
+    int num_files;
+    int loop_once;
+    frame_queue *queue;
+    frame_cache *cache;
+    uint64_t cache_key;
+    char cache_path[300];
+    int cached;              // 第一遍结束时缓存是否写入成功
+    atomic_int stop;         // 显示线程已停止取帧
+} decoder_context;
+
+// 等待空闲槽位（队列满时阻塞到显示线程归还槽位），显示线程已停止时返回 NULL
+static frame_slot *wait_producer_slot(decoder_context *ctx) {
+    frame_slot *slot = frame_queue_producer_slot(ctx->queue);
+    if (slot) {
+        return slot;
+    }
+    atomic_fetch_add(&ctx->queue->full_waits, 1);
+    for (;;) {
+        unsigned int events = frame_queue_events(ctx->queue);
+        if ((slot = frame_queue_producer_slot(ctx->queue)) || atomic_load(&ctx->stop)) {
+            return slot;
+        }
+        frame_queue_wait(ctx->queue, events);
+    }
+}
+
+// 解码线程：提前把帧解码并转换为RGB565，放入队列的空闲槽位
+// 第一遍同时写入帧缓存，写入成功后结束，由显示线程改为播放缓存包
+static void *decoder_main(void *arg) {
+    decoder_context *ctx = arg;
+    anim_pack_writer cache_writer;
+    int caching = 0;
+
+    do {
+        for (int frame = 0; frame < ctx->num_files; frame++) {
+            // 24位未压缩BMP走 mmap 快速路径，其它格式回退到 stb_image
+            int img_width, img_height, img_channels;
+            unsigned char* img_data = NULL;
+            bmp_image bmp;
+            if (bmp_fast_open(&bmp, ctx->files[frame]) == 0) {
+                img_width = bmp.width;
+                img_height = bmp.height;
+            } else {
+                img_data = stbi_load(ctx->files[frame], &img_width, &img_height, &img_channels, 3);
+            }
+
+            if (!bmp.map && !img_data) {
+                printf("Error loading image %s: %s\n", ctx->files[frame], stbi_failure_reason());
+                if (caching) {
+                    anim_pack_writer_abort(&cache_writer);
+                    caching = 0;
+                }
+                continue;
+            }
+
+            if (frame == 0 && !ctx->cached && !caching && ctx->cache &&
+                frame_cache_enabled(ctx->cache)) {
+                caching = frame_cache_store_begin(ctx->cache, ctx->cache_key, img_width, img_height,
+                                                  &cache_writer) == 0;
+            } else if (caching && (img_width != cache_writer.header.width ||
+                                   img_height != cache_writer.header.height)) {
+                // 尺寸不一致的序列不缓存
+                anim_pack_writer_abort(&cache_writer);
+                caching = 0;
+            }
+
+            // 等待空闲槽位；显示线程已停止时直接退出
+            frame_slot *slot = wait_producer_slot(ctx);
+            if (!slot) {
+                stbi_image_free(img_data);
+                bmp_fast_close(&bmp);
+                if (caching) {
+                    anim_pack_writer_abort(&cache_writer);
+                }
+                return NULL;
+            }
+
+            size_t pixel_count = (size_t)img_width * img_height;
+            if (pixel_count > slot->capacity) {
+                // 只有尺寸变大的帧才会重新分配
+                uint16_t *pixels = realloc(slot->pixels, pixel_count * 2);
+                if (!pixels) {
+                    perror("Error allocating frame slot");
+                    stbi_image_free(img_data);
+                    bmp_fast_close(&bmp);
+                    if (caching) {
+                        anim_pack_writer_abort(&cache_writer);
+                        caching = 0;
+                    }
+                    continue;
+                }
+                slot->pixels = pixels;
+                slot->capacity = pixel_count;
+            }
+
+            if (img_data) {
+                for (size_t i = 0; i < pixel_count; i++) {
+                    unsigned char r = img_data[i * 3];
+                    unsigned char g = img_data[i * 3 + 1];
+                    unsigned char b = img_data[i * 3 + 2];
+                    slot->pixels[i] = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+                }
+                stbi_image_free(img_data);
+            } else {
+                bmp_fast_to_rgb565(&bmp, slot->pixels, img_width);
+                bmp_fast_close(&bmp);
+            }
+
+            if (caching && anim_pack_writer_add_frame(&cache_writer, slot->pixels, 0) == -1) {
+                anim_pack_writer_abort(&cache_writer);
+                caching = 0;
+            }
+
+            slot->width = img_width;
+            slot->height = img_height;
+            slot->frame = frame;
+            frame_queue_publish(ctx->queue);
+        }
+
+        if (caching) {
+            caching = 0;
+            ctx->cached = frame_cache_store_commit(ctx->cache, &cache_writer, ctx->cache_path,
+                                                   sizeof(ctx->cache_path)) == 0;
+        }
+    } while (!ctx->loop_once && !ctx->cached && !atomic_load(&ctx->stop));
+
+    if (caching) {
+        anim_pack_writer_abort(&cache_writer);
+    }
+
+    // 发送结束标记
+    frame_slot *slot = wait_producer_slot(ctx);
+    if (!slot) {
+        return NULL;
+    }
+    slot->frame = FRAME_QUEUE_END;
+    frame_queue_publish(ctx->queue);
+    return NULL;
+}
+
+// 打印解码队列统计，用于调整队列深度
+static void print_queue_stats(frame_queue *queue) {
+    printf("Decode queue: depth %u/%u, underruns %lu, producer waits %lu\n",
+           frame_queue_depth(queue), queue->size,
+           atomic_load(&queue->underruns), atomic_load(&queue->full_waits));
+}
+
+// 播放已排序的BMP文件列表：后台线程解码，本线程只从队列取帧、拷贝、等待
+static int play_bmp_files(anim_player *player, char **bmp_files, int num_files, int delay_ms,
+                          int loop_once) {
+    frame_cache *cache = player->cache;
+
+    // 查找解码帧缓存，命中时直接播放缓存包
+    uint64_t cache_key = 0;
+    if (cache && frame_cache_enabled(cache)) {
+        char cache_path[300];
+        cache_key = frame_cache_key((const char *const *)bmp_files, num_files);
+        if (frame_cache_lookup(cache, cache_key, cache_path, sizeof(cache_path))) {
+            frame_cache_report(cache);
+            return play_pack_file(player, cache_path, delay_ms, loop_once, 0);
+        }
+        frame_cache_report(cache);
+    }
+
+    // 按第一帧尺寸预分配解码队列槽位
+    int first_width, first_height, first_channels;
+    if (!stbi_info(bmp_files[0], &first_width, &first_height, &first_channels)) {
+        first_width = player->width;
+        first_height = player->height;
+    }
+    frame_queue queue;
+    if (frame_queue_init(&queue, player->queue_depth, (size_t)first_width * first_height) == -1) {
+        return 1;
+    }
+
+    decoder_context decoder = {
+        .files = bmp_files,
+        .num_files = num_files,
+        .loop_once = loop_once,
+        .queue = &queue,
+        .cache = cache,
+        .cache_key = cache_key,
+        .cached = 0,
+    };
+    atomic_init(&decoder.stop, 0);
+
+    pthread_t decoder_thread;
+    if (pthread_create(&decoder_thread, NULL, decoder_main, &decoder) != 0) {
+        fprintf(stderr, "Error creating decoder thread\n");
+        frame_queue_destroy(&queue);
+        return 1;
+    }
+
+    set_waiting_queue(player, &queue);
+    while (1) {
+        frame_slot *slot = frame_queue_consumer_slot(&queue);
+        if (!slot) {
+            // 阻塞到解码线程发布新帧，或 anim_player_wake 通知停止
+            atomic_fetch_add(&queue.underruns, 1);
+            for (;;) {
+                unsigned int events = frame_queue_events(&queue);
+                if ((slot = frame_queue_consumer_slot(&queue)) || player_stopped(player)) {
+                    break;
+                }
+                frame_queue_wait(&queue, events);
+            }
+        }
+        if (player_stopped(player)) {
+            break;
+        }
+
+        if (slot->frame == FRAME_QUEUE_END) {
+            frame_queue_release(&queue);
+            break;
+        }
+
+        // 居中绘制整帧并提交；丢弃的帧直接释放槽位
+        int last_frame = slot->frame == num_files - 1;
+        if (frame_clock_drop(&player->clock, delay_ms)) {
+            frame_queue_release(&queue);
+        } else {
+            anim_pack_rect full = {0, 0, slot->width, slot->height};
+            begin_frame(player, slot->width, slot->height, &full);
+            blit_rgb565_rect(player, slot->width, slot->height, &full, slot->pixels);
+            frame_queue_release(&queue);
+            present_frame(player, delay_ms);
+        }
+        if (last_frame) {
+            print_queue_stats(&queue);
+        }
+    }
+
+    set_waiting_queue(player, NULL);
+    atomic_store(&decoder.stop, 1);
+    frame_queue_wake(&queue);
+    pthread_join(decoder_thread, NULL);
+    print_queue_stats(&queue);
+    frame_queue_destroy(&queue);
+
+    if (decoder.cached) {
+        snprintf(player->pack_path, sizeof(player->pack_path), "%s", decoder.cache_path);
+        // 第一遍解码完成并写入缓存后，改为播放缓存包
+        if (!loop_once && !player_stopped(player)) {
+            return play_pack_file(player, decoder.cache_path, delay_ms, loop_once, 0);
+        }
+    }
+    return 0;
+}
+
+// 扫描目录中的BMP文件，按文件名排序后播放
+static void free_file_list(char **files, int count) {
+    for (int i = 0; i < count; i++) {
+        free(files[i]);
+    }
+    free(files);
+}
+
+// 列出目录中的BMP文件并按文件名排序，成功返回0
+static int list_bmp_files(const char *directory, char ***files, int *count) {
+    DIR *dir;
+    struct dirent *ent;
+    char **bmp_files = NULL;
+    int num_files = 0;
+    int max_files = 1000;  // 假设最多1000个文件
+
+    bmp_files = malloc(max_files * sizeof(char*));
+    if (!bmp_files) {
+        perror("Error allocating memory for file list");
+        return -1;
+    }
+
+    dir = opendir(directory);
+    if (dir == NULL) {
+        perror("Error opening directory");
+        printf("Directory: %s\n", directory);
+        free(bmp_files);
+        return -1;
+    }
+
+    while ((ent = readdir(dir)) != NULL) {
+        if (strstr(ent->d_name, ".bmp") != NULL) {
+            if (num_files >= max_files) {
+                fprintf(stderr, "Too many BMP files in directory\n");
+                break;
+            }
+            bmp_files[num_files] = malloc(strlen(directory) + strlen(ent->d_name) + 2);
+            if (!bmp_files[num_files]) {
+                perror("Error allocating memory for filename");
+                break;
+            }
+            sprintf(bmp_files[num_files], "%s/%s", directory, ent->d_name);
+            num_files++;
+        }
+    }
+    closedir(dir);
+
+    // 对文件名进行排序
+    qsort(bmp_files, num_files, sizeof(char*), compare_filenames);
+    *files = bmp_files;
+    *count = num_files;
+    return 0;
+}
+
+static int play_bmp_directory(anim_player *player, const char *directory, int delay_ms,
+                              int loop_once) {
+    char **bmp_files;
+    int num_files;
+    if (list_bmp_files(directory, &bmp_files, &num_files) == -1) {
+        return 1;
+    }
+
+    int ret = 1;
+    if (num_files == 0) {
+        fprintf(stderr, "No BMP files found in directory\n");
+    } else {
+        printf("Found %d BMP files\n", num_files);
+        ret = play_bmp_files(player, bmp_files, num_files, delay_ms, loop_once);
+    }
+
+    // 清理资源
+    free_file_list(bmp_files, num_files);
+    return ret;
+}
+
+int anim_player_play(anim_player *player, const char *path, int delay_ms, int loop_once,
+                     int start_frame) {
+    player->pack_path[0] = '\0';
+
+    // GIF直接解码播放
+    if (is_gif_path(path)) {
+        return play_gif(player, path, delay_ms, loop_once);
+    }
+
+    // 优先播放预转换的动画包
+    char pack_path[512];
+    if (find_anim_pack(path, pack_path, sizeof(pack_path))) {
+        return play_pack_file(player, pack_path, delay_ms, loop_once, start_frame);
+    }
+
+    return play_bmp_directory(player, path, delay_ms, loop_once);
+}
+
+int anim_player_source_key(const char *path, uint64_t *key) {
+    char pack_path[512];
+    if (is_gif_path(path)) {
+        *key = frame_cache_key(&path, 1);
+        return 0;
+    }
+    if (find_anim_pack(path, pack_path, sizeof(pack_path))) {
+        const char *pack = pack_path;
+        *key = frame_cache_key(&pack, 1);
+        return 0;
+    }
+    char **bmp_files;
+    int num_files;
+    if (list_bmp_files(path, &bmp_files, &num_files) == -1) {
+        return -1;
+    }
+    *key = frame_cache_key((const char *const *)bmp_files, num_files);
+    free_file_list(bmp_files, num_files);
+    return 0;
+}
@@ -0,0 +1,56 @@
+#ifndef ANIM_PLAYER_H
+#define ANIM_PLAYER_H
+
+#include <pthread.h>
+
+#include "anim_pack.h"
+#include "fb_present.h"
+#include "frame_cache.h"
+#include "frame_clock.h"
+#include "frame_queue.h"
+#include "pixel_format.h"
+
+// 动画播放：把动画包、GIF 或 BMP 序列逐帧居中绘制到画面提交器上
+// play_bmp_sequence 命令行和 sys_boot 的渲染线程（anim_engine）共用
+// 播放在调用者的线程中进行，每帧检查 should_stop；等待帧显示时刻时可由 clock.sleep 打断，
+// 等待解码队列时由 anim_player_wake 唤醒
+
+typedef struct {
+    fb_presenter *presenter;
+    frame_cache *cache;             // 解码帧缓存，可为 NULL
+    frame_clock clock;
+    int queue_depth;                // BMP 序列的预解码队列深度
+    int (*should_stop)(void *arg);  // 返回非0时结束播放，可为 NULL
+    void *stop_arg;
+    char pack_path[512];            // 本次播放最终使用的动画包（预转换包或缓存包），没有时为空
+    pthread_mutex_t queue_lock;
+    frame_queue *queue;             // 正在等待的解码队列（BMP 序列播放中），没有时为 NULL
+
+    // 本帧绘制目标（隐藏页或内存画布）
+    unsigned char *target;
+    int width;
+    int height;
+    int line_length;
+    const pixel_format *format;
+} anim_player;
+
+void anim_player_init(anim_player *player, fb_presenter *presenter, frame_cache *cache);
+
+// should_stop 即将返回非0时由其它线程调用：唤醒等待解码帧的播放线程，让它检查 should_stop
+void anim_player_wake(anim_player *player);
+
+// 播放 path：动画包文件、含 anim.akp 的目录、GIF 文件或 BMP 序列目录，成功返回0
+// delay_ms 用于没有自带延迟的帧；loop_once 为0时循环到 should_stop 为止；
+// start_frame 只对动画包有效
+int anim_player_play(anim_player *player, const char *path, int delay_ms, int loop_once,
+                     int start_frame);
+
+// 源内容的键：GIF 或动画包文件本身、BMP 序列目录中的全部帧文件（路径、大小、修改时间）
+// 的 frame_cache_key，内容有变化时键随之改变；目录无法读取时返回-1
+int anim_player_source_key(const char *path, uint64_t *key);
+
+// 播放已映射的动画包
+int anim_player_play_pack(anim_player *player, const anim_pack *pack, int delay_ms, int loop_once,
+                          int start_frame);
+
+#endif
@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#include "bmp_fast.h"
+
+// BMP加载转换基准测试：比较 stb_image + 标量转换（原播放路径）与 mmap 快速路径
+// 输出每像素耗时（ns），包含打开文件、读取和转换为RGB565的全部开销
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// 生成测试用的24位BMP（自下而上，带行填充）
+static int write_test_bmp(const char *path, int width, int height) {
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        perror("Error creating test BMP");
+        return -1;
+    }
+    int row_stride = (width * 3 + 3) & ~3;
+    uint32_t data_size = row_stride * height;
+    unsigned char header[54] = {'B', 'M'};
+    uint32_t fields[][2] = {
+        {2, 54 + data_size}, {10, 54}, {14, 40}, {18, width}, {22, height}, {34, data_size}
+    };
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        memcpy(header + fields[i][0], &fields[i][1], 4);
+    }
+    header[26] = 1;
+    header[28] = 24;
+    fwrite(header, 1, sizeof(header), fp);
+
+    unsigned char *row = calloc(row_stride, 1);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width * 3; x++) {
+            row[x] = (x * 7 + y * 13) & 0xFF;
+        }
+        fwrite(row, 1, row_stride, fp);
+    }
+    free(row);
+    fclose(fp);
+    return 0;
+}
+
+// 原路径：stbi_load 读入RGB缓冲后逐像素转换
+static void load_stb(const char *path, uint16_t *dst) {
+    int width, height, channels;
+    unsigned char *img = stbi_load(path, &width, &height, &channels, 3);
+    if (!img) {
+        return;
+    }
+    for (int i = 0; i < width * height; i++) {
+        unsigned char r = img[i * 3];
+        unsigned char g = img[i * 3 + 1];
+        unsigned char b = img[i * 3 + 2];
+        dst[i] = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+    }
+    stbi_image_free(img);
+}
+
+static void load_fast_scalar(const char *path, uint16_t *dst) {
+    bmp_image img;
+    if (bmp_fast_open(&img, path) == 0) {
+        for (int y = 0; y < img.height; y++) {
+            bgr888_to_rgb565_row_scalar(bmp_fast_row(&img, y), dst + y * img.width, img.width);
+        }
+        bmp_fast_close(&img);
+    }
+}
+
+static void load_fast(const char *path, uint16_t *dst) {
+    bmp_image img;
+    if (bmp_fast_open(&img, path) == 0) {
+        bmp_fast_to_rgb565(&img, dst, img.width);
+        bmp_fast_close(&img);
+    }
+}
+
+static double bench(const char *name, void (*load)(const char *, uint16_t *),
+                    const char *path, uint16_t *dst, int pixels, int iterations) {
+    load(path, dst);  // 预热页缓存
+    double start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        load(path, dst);
+    }
+    double ns = (now_ns() - start) / iterations / pixels;
+    printf("%-20s %8.2f ns/pixel\n", name, ns);
+    return ns;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = argc > 1 ? argv[1] : "/tmp/bench_bmp.bmp";
+    int iterations = argc > 2 ? atoi(argv[2]) : 2000;
+
+    if (argc <= 1 && write_test_bmp(path, 162, 132) == -1) {
+        return 1;
+    }
+
+    bmp_image img;
+    if (bmp_fast_open(&img, path) == -1) {
+        fprintf(stderr, "%s is not an uncompressed 24-bit BMP\n", path);
+        return 1;
+    }
+    int width = img.width, height = img.height;
+    bmp_fast_close(&img);
+
+    int pixels = width * height;
+    uint16_t *expected = malloc(pixels * 2);
+    uint16_t *actual = malloc(pixels * 2);
+    if (!expected || !actual) {
+        perror("Error allocating buffers");
+        return 1;
+    }
+
+    // 先确认快速路径与原路径结果一致
+    load_stb(path, expected);
+    load_fast(path, actual);
+    if (memcmp(expected, actual, pixels * 2) != 0) {
+        fprintf(stderr, "Fast path output differs from stb_image\n");
+        return 1;
+    }
+
+    printf("Image: %s (%dx%d), %d iterations, kernel: %s\n",
+           path, width, height, iterations, bmp_fast_kernel_name());
+    double base = bench("stb_image + scalar", load_stb, path, expected, pixels, iterations);
+    bench("mmap + scalar", load_fast_scalar, path, actual, pixels, iterations);
+    double fast = bench("mmap + simd", load_fast, path, actual, pixels, iterations);
+    printf("Speedup: %.1fx\n", base / fast);
+
+    free(expected);
+    free(actual);
+    return 0;
+}
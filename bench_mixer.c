@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "mixer.h"
+#include "event_loop.h"
+
+// 音量按键基准测试：比较 sys_boot 原来每次按键的 amixer 流程
+// （popen 一个 get | grep | awk 管道，再 system 一次 set）与 mixer.c 的直接访问
+// 原流程用 echo 代替 amixer 输出，只计算进程创建开销，没有声卡也能运行
+// 用法: ./bench_mixer [presses] [burst]
+// 混音器后端按 AKU_MIXER 选择，默认用模拟后端 fake:0,63,31
+
+#define PRESS_INTERVAL_MS 15     // 连按时两次按键的间隔（按住音量键的自动重复）
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// 原路径：读取一次当前值、写入一次新值
+static int legacy_press(int volume) {
+    char cmd[128];
+    char result[32];
+    int current = 0;
+    snprintf(cmd, sizeof(cmd), "echo '  Mono: %d [49%%]' | grep 'Mono:' | awk '{print $2}'", volume);
+    FILE *fp = popen(cmd, "r");
+    if (fp) {
+        if (fgets(result, sizeof(result), fp)) {
+            current = atoi(result);
+        }
+        pclose(fp);
+    }
+    snprintf(cmd, sizeof(cmd), "true %d > /dev/null 2>&1", current + 1);
+    system(cmd);
+    return current;
+}
+
+typedef struct {
+    mixer *m;
+    event_loop *loop;
+    int press_timer;
+    int done_timer;
+    int remaining;
+    int direction;
+    double press_ns;
+} burst_state;
+
+static void on_press(void *arg) {
+    burst_state *b = arg;
+    double start = now_ns();
+    long value = mixer_get(b->m) + b->direction;
+    if (value > b->m->max || value < b->m->min) {
+        b->direction = -b->direction;
+        value = mixer_get(b->m) + b->direction;
+    }
+    mixer_set(b->m, value);
+    b->press_ns += now_ns() - start;
+    if (--b->remaining > 0) {
+        event_loop_timer_start(b->loop, b->press_timer, PRESS_INTERVAL_MS);
+    } else {
+        // 等合并窗口结束，最后一个值写入
+        event_loop_timer_start(b->loop, b->done_timer, 3 * MIXER_COALESCE_MS);
+    }
+}
+
+static void on_done(void *arg) {
+    burst_state *b = arg;
+    b->loop->stop = 1;
+}
+
+int main(int argc, char *argv[]) {
+    int presses = argc > 1 ? atoi(argv[1]) : 200;
+    int burst = argc > 2 ? atoi(argv[2]) : 20;
+    if (presses <= 0 || burst <= 0) {
+        fprintf(stderr, "Usage: %s [presses] [burst]\n", argv[0]);
+        return 1;
+    }
+    const char *spec = getenv(MIXER_ENV);
+    if (!spec || !spec[0]) {
+        spec = "fake:0,63,31";
+    }
+
+    printf("%d presses, bursts of %d every %d ms, mixer %s\n",
+           presses, burst, PRESS_INTERVAL_MS, spec);
+
+    // 原流程
+    double start = now_ns();
+    int volume = 31;
+    for (int i = 0; i < presses; i++) {
+        volume = legacy_press(volume) + 1;
+        if (volume >= 63) {
+            volume = 0;
+        }
+    }
+    double legacy = (now_ns() - start) / presses;
+
+    // 直接访问，每次按键立即写入
+    mixer m;
+    if (mixer_open(&m, spec) == -1) {
+        return 1;
+    }
+    start = now_ns();
+    for (int i = 0; i < presses; i++) {
+        long value = mixer_get(&m) + 1;
+        mixer_set(&m, value > m.max ? m.min : value);
+    }
+    double direct = (now_ns() - start) / presses;
+    uint64_t direct_writes = m.writes;
+    mixer_close(&m);
+
+    // 接入事件循环：按键间隔小于合并窗口，一串按键合并写入
+    event_loop loop;
+    if (event_loop_init(&loop) == -1 || mixer_open(&m, spec) == -1) {
+        return 1;
+    }
+    if (mixer_attach(&m, &loop) == -1) {
+        return 1;
+    }
+    burst_state b = {.m = &m, .loop = &loop, .direction = 1};
+    b.press_timer = event_loop_add_timer(&loop, on_press, &b);
+    b.done_timer = event_loop_add_timer(&loop, on_done, &b);
+    int bursts = (presses + burst - 1) / burst;
+    for (int i = 0; i < bursts; i++) {
+        b.remaining = burst;
+        loop.stop = 0;
+        event_loop_timer_start(&loop, b.press_timer, 0);
+        event_loop_run(&loop);
+    }
+    double coalesced = b.press_ns / ((double)bursts * burst);
+    uint64_t coalesced_writes = m.writes;
+    mixer_report(&m);
+    mixer_close(&m);
+    event_loop_destroy(&loop);
+
+    printf("%-10s %14s %14s\n", "path", "ns/press", "writes/burst");
+    printf("%-10s %14.0f %14.1f\n", "legacy", legacy, (double)burst);
+    printf("%-10s %14.0f %14.1f\n", "direct", direct,
+           (double)direct_writes * burst / presses);
+    printf("%-10s %14.0f %14.1f\n", "coalesced", coalesced,
+           (double)coalesced_writes / bursts);
+    printf("Speedup (legacy / coalesced): %.0fx\n", legacy / coalesced);
+    return 0;
+}
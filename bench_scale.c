@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#include "image_scale.h"
+
+// 缩放旋转基准测试：比较 show_image 原来的逐像素浮点除法 + 旋转分支循环
+// 与定点查表 + 分块转置实现，输出每个输出像素的耗时（ns）
+// 用法: ./bench_scale [image.jpg] [fb_width] [fb_height] [iterations]
+// 不给图像或图像为 - 时生成 4000x3000 的测试图
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// 原实现的旋转映射（90/270度按源图像实际宽高取坐标）
+static void get_rotated_pixel(int x, int y, int width, int height, int rotation,
+                              int *out_x, int *out_y) {
+    switch (rotation) {
+        case 90:
+            *out_x = width - 1 - y;
+            *out_y = x;
+            break;
+        case 180:
+            *out_x = width - 1 - x;
+            *out_y = height - 1 - y;
+            break;
+        case 270:
+            *out_x = y;
+            *out_y = height - 1 - x;
+            break;
+        default:
+            *out_x = x;
+            *out_y = y;
+            break;
+    }
+}
+
+typedef struct {
+    const unsigned char *img;
+    int img_width;
+    int img_height;
+    int rotation;
+    float scale;
+    int display_width;
+    int display_height;
+    unsigned char *out;
+} scale_job;
+
+// 原路径：每个像素两次浮点除法和一次旋转分支
+static void scale_legacy(const scale_job *job) {
+    for (int y = 0; y < job->display_height; y++) {
+        unsigned char *row = job->out + (size_t)y * job->display_width * 3;
+        for (int x = 0; x < job->display_width; x++) {
+            float src_x = x / job->scale;
+            float src_y = y / job->scale;
+            int rotated_x, rotated_y;
+            get_rotated_pixel((int)src_x, (int)src_y, job->img_width, job->img_height,
+                              job->rotation, &rotated_x, &rotated_y);
+            int src_pos = (rotated_y * job->img_width + rotated_x) * 3;
+            row[x * 3] = job->img[src_pos];
+            row[x * 3 + 1] = job->img[src_pos + 1];
+            row[x * 3 + 2] = job->img[src_pos + 2];
+        }
+    }
+}
+
+// 校验用参考实现：与原路径相同，但用双精度除法，没有 float 商的舍入误差
+static void scale_reference(const scale_job *job) {
+    for (int y = 0; y < job->display_height; y++) {
+        unsigned char *row = job->out + (size_t)y * job->display_width * 3;
+        for (int x = 0; x < job->display_width; x++) {
+            double src_x = x / (double)job->scale;
+            double src_y = y / (double)job->scale;
+            int rotated_x, rotated_y;
+            get_rotated_pixel((int)src_x, (int)src_y, job->img_width, job->img_height,
+                              job->rotation, &rotated_x, &rotated_y);
+            int src_pos = (rotated_y * job->img_width + rotated_x) * 3;
+            row[x * 3] = job->img[src_pos];
+            row[x * 3 + 1] = job->img[src_pos + 1];
+            row[x * 3 + 2] = job->img[src_pos + 2];
+        }
+    }
+}
+
+// 新路径：包含建表开销，与 show_image 一样按行带输出
+static void scale_tables(const scale_job *job) {
+    image_scaler scaler;
+    if (image_scaler_init(&scaler, job->img_width, job->img_height,
+                          job->rotation, job->scale) == -1) {
+        return;
+    }
+    for (int y0 = 0; y0 < scaler.dst_height; y0 += IMAGE_SCALE_TILE) {
+        int rows = scaler.dst_height - y0 < IMAGE_SCALE_TILE ? scaler.dst_height - y0 : IMAGE_SCALE_TILE;
+        image_scaler_rows(&scaler, job->img, y0, rows,
+                          job->out + (size_t)y0 * scaler.dst_width * 3);
+    }
+    image_scaler_destroy(&scaler);
+}
+
+static double bench(void (*run)(const scale_job *), const scale_job *job, int iterations) {
+    run(job);  // 预热
+    double start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        run(job);
+    }
+    return (now_ns() - start) / iterations / ((double)job->display_width * job->display_height);
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = argc > 1 && strcmp(argv[1], "-") != 0 ? argv[1] : NULL;
+    int fb_width = argc > 2 ? atoi(argv[2]) : 320;
+    int fb_height = argc > 3 ? atoi(argv[3]) : 240;
+    int iterations = argc > 4 ? atoi(argv[4]) : 200;
+
+    int img_width, img_height, channels;
+    unsigned char *img;
+    if (path) {
+        img = stbi_load(path, &img_width, &img_height, &channels, 3);
+        if (!img) {
+            fprintf(stderr, "Error loading image: %s\n", stbi_failure_reason());
+            return 1;
+        }
+    } else {
+        path = "(generated)";
+        img_width = 4000;
+        img_height = 3000;
+        img = malloc((size_t)img_width * img_height * 3);
+        if (!img) {
+            perror("Error allocating test image");
+            return 1;
+        }
+        for (size_t i = 0; i < (size_t)img_width * img_height * 3; i++) {
+            img[i] = (i * 7 + i / 4093) & 0xFF;
+        }
+    }
+
+    printf("Image: %s (%dx%d), screen %dx%d, %d iterations\n",
+           path, img_width, img_height, fb_width, fb_height, iterations);
+    printf("%-8s %12s %12s %8s %12s\n", "rotation", "legacy ns/px", "table ns/px", "speedup", "legacy diff");
+
+    static const int rotations[] = {0, 90, 180, 270};
+    int failed = 0;
+    for (size_t r = 0; r < sizeof(rotations) / sizeof(rotations[0]); r++) {
+        int rotation = rotations[r];
+        int transposed = rotation == 90 || rotation == 270;
+        int target_width = transposed ? img_height : img_width;
+        int target_height = transposed ? img_width : img_height;
+        float scale_x = (float)fb_width / target_width;
+        float scale_y = (float)fb_height / target_height;
+
+        scale_job job = {img, img_width, img_height, rotation,
+                         scale_x < scale_y ? scale_x : scale_y, 0, 0, NULL};
+        job.display_width = (int)(target_width * job.scale);
+        job.display_height = (int)(target_height * job.scale);
+        size_t out_size = (size_t)job.display_width * job.display_height * 3;
+        unsigned char *expected = malloc(out_size);
+        unsigned char *actual = malloc(out_size);
+        if (!expected || !actual) {
+            perror("Error allocating output buffers");
+            return 1;
+        }
+
+        // 查表结果必须与双精度参考完全一致；原路径的 float 商在整数边界附近
+        // 可能舍入到相邻源像素，只统计其不一致的像素数
+        job.out = expected;
+        scale_reference(&job);
+        job.out = actual;
+        scale_tables(&job);
+        if (memcmp(expected, actual, out_size) != 0) {
+            fprintf(stderr, "Rotation %d: table scaler output differs from reference\n", rotation);
+            failed = 1;
+        }
+        scale_legacy(&job);
+        size_t legacy_diff = 0;
+        for (size_t i = 0; i < out_size; i += 3) {
+            legacy_diff += memcmp(expected + i, actual + i, 3) != 0;
+        }
+
+        job.out = expected;
+        double legacy = bench(scale_legacy, &job, iterations);
+        job.out = actual;
+        double tables = bench(scale_tables, &job, iterations);
+        printf("%-8d %12.2f %12.2f %7.1fx %12zu\n", rotation, legacy, tables, legacy / tables, legacy_diff);
+
+        free(expected);
+        free(actual);
+    }
+
+    stbi_image_free(img);
+    return failed;
+}
@@ -0,0 +1,358 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <wchar.h>
+#include <locale.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include "glyph_cache.h"
+#include "glyph_blit.h"
+#include "pixel_format.h"
+#include "text_layout.h"
+
+// 文字绘制基准测试：
+// 1. show_text 原来的逐字符 FT_Load_Char（测量一次、绘制一次，每个字符光栅化两次）与字形缓存，
+//    两种路径都画到内存中的 8 位缓冲区，只计算测量和绘制本身
+// 2. 字形写入 RGB565 画布：原来逐像素 draw_pixel（覆盖度>0 即写入，无抗锯齿）与
+//    glyph_blit 的按行混合（标量参考和 SSE2/NEON），并检查 SIMD 与标量结果一致
+// 3. 排版：原来的 mbstowcs + 逐字符测量行宽，与 text_layout 第一次排版（断行、字距）和缓存命中
+// 输出每个字符串的耗时（us）
+// 用法: ./bench_text <font.ttf> [font_size] [iterations]
+
+#define SCREEN_W 240
+#define SCREEN_H 135
+
+static unsigned char screen[SCREEN_H][SCREEN_W];
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// 屏幕内容的校验和，用于确认两种路径画出的结果相同
+static uint32_t screen_sum(void) {
+    uint32_t sum = 0;
+    for (int y = 0; y < SCREEN_H; y++) {
+        for (int x = 0; x < SCREEN_W; x++) {
+            sum = sum * 31 + screen[y][x];
+        }
+    }
+    memset(screen, 0, sizeof(screen));
+    return sum;
+}
+
+static void plot(int x, int y) {
+    if (x >= 0 && x < SCREEN_W && y >= 0 && y < SCREEN_H) {
+        screen[y][x] = 1;
+    }
+}
+
+// 原路径：测量时光栅化一次，绘制时再光栅化一次
+static void draw_legacy(FT_Face face, const wchar_t *str, int font_size) {
+    int width = 0;
+    for (const wchar_t *p = str; *p; p++) {
+        if (*p != L'\n') {
+            FT_Load_Char(face, *p, FT_LOAD_RENDER);
+            width += face->glyph->advance.x >> 6;
+        }
+    }
+    int start_x = (SCREEN_W - width) / 2;
+    int x = start_x;
+    int y = font_size;
+    for (const wchar_t *p = str; *p; p++) {
+        if (*p == L'\n') {
+            y += font_size + 2;
+            x = start_x;
+            continue;
+        }
+        if (FT_Load_Char(face, *p, FT_LOAD_RENDER)) {
+            continue;
+        }
+        FT_GlyphSlot slot = face->glyph;
+        for (unsigned i = 0; i < slot->bitmap.rows; i++) {
+            for (unsigned j = 0; j < slot->bitmap.width; j++) {
+                if (slot->bitmap.buffer[i * slot->bitmap.pitch + j]) {
+                    plot(x + j + slot->bitmap_left, y + i - slot->bitmap_top);
+                }
+            }
+        }
+        x += slot->advance.x >> 6;
+    }
+}
+
+// 缓存路径：测量只读 advance，绘制用缓存的位图
+static void draw_cached(glyph_cache *cache, const wchar_t *str, int font_size) {
+    int width = 0;
+    for (const wchar_t *p = str; *p; p++) {
+        if (*p != L'\n') {
+            const glyph *g = glyph_cache_get(cache, *p, font_size);
+            width += g ? g->advance : 0;
+        }
+    }
+    int start_x = (SCREEN_W - width) / 2;
+    int x = start_x;
+    int y = font_size;
+    for (const wchar_t *p = str; *p; p++) {
+        if (*p == L'\n') {
+            y += font_size + 2;
+            x = start_x;
+            continue;
+        }
+        const glyph *g = glyph_cache_get(cache, *p, font_size);
+        if (!g) {
+            continue;
+        }
+        const unsigned char *bitmap = glyph_bitmap(cache, g);
+        for (int i = 0; i < g->rows; i++) {
+            for (int j = 0; j < g->width; j++) {
+                if (bitmap[i * g->width + j]) {
+                    plot(x + j + g->left, y + i - g->top);
+                }
+            }
+        }
+        x += g->advance;
+    }
+}
+
+static uint16_t canvas[SCREEN_H][SCREEN_W];
+
+// 原实现：每个像素单独检查边界、计算偏移、调用 fill_row
+static void draw_pixel(const pixel_format *format, int x, int y, uint32_t color) {
+    if (x >= 0 && x < SCREEN_W && y >= 0 && y < SCREEN_H) {
+        long location = (long)y * sizeof(canvas[0]) + x * format->bytes_per_pixel;
+        if (location >= 0 && location < (long)sizeof(canvas)) {
+            format->fill_row((unsigned char *)canvas + location, color, 1);
+        }
+    }
+}
+
+typedef void (*span_fn)(uint16_t *dst, const unsigned char *coverage, int count, uint16_t color);
+
+// 把字符串的字形逐个画到画布，span 为 NULL 时走原来的逐像素路径
+static void blit_string(glyph_cache *cache, const pixel_format *format, const wchar_t *str,
+                        int font_size, span_fn span) {
+    int x = 4;
+    int y = font_size;
+    uint16_t color = 0xFFFF;
+    for (const wchar_t *p = str; *p; p++) {
+        if (*p == L'\n') {
+            y += font_size + 2;
+            x = 4;
+            continue;
+        }
+        const glyph *g = glyph_cache_get(cache, *p, font_size);
+        const unsigned char *bitmap = glyph_bitmap(cache, g);
+        for (int i = 0; i < g->rows; i++) {
+            if (span) {
+                span(&canvas[y + i - g->top][x + g->left], bitmap + i * g->width, g->width, color);
+                continue;
+            }
+            for (int j = 0; j < g->width; j++) {
+                if (bitmap[i * g->width + j] > 0) {
+                    draw_pixel(format, x + j + g->left, y + i - g->top, color);
+                }
+            }
+        }
+        x += g->advance;
+    }
+}
+
+static double time_blit(glyph_cache *cache, const pixel_format *format, const wchar_t *str,
+                        int font_size, span_fn span, int iterations) {
+    double start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        // 每次都在灰色背景上混合，避免结果饱和后走捷径
+        for (int y = 0; y < SCREEN_H; y++) {
+            for (int x = 0; x < SCREEN_W; x++) {
+                canvas[y][x] = 0x4208;
+            }
+        }
+        blit_string(cache, format, str, font_size, span);
+    }
+    return (now_ns() - start) / iterations / 1000;
+}
+
+// 原实现的测量：转换为宽字符后逐字符累加 advance，得到最宽一行的宽度
+static int measure_legacy(glyph_cache *cache, const char *text, int font_size) {
+    wchar_t wtext[256];
+    if (mbstowcs(wtext, text, 256) == (size_t)-1) {
+        return 0;
+    }
+    wtext[255] = L'\0';
+    int max_width = 0;
+    int current_width = 0;
+    for (const wchar_t *p = wtext; *p; p++) {
+        if (*p == L'\n') {
+            current_width = 0;
+            continue;
+        }
+        current_width += glyph_cache_get(cache, *p, font_size)->advance;
+        if (current_width > max_width) {
+            max_width = current_width;
+        }
+    }
+    return max_width;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <font.ttf> [font_size] [iterations]\n", argv[0]);
+        return 1;
+    }
+    int font_size = argc > 2 ? atoi(argv[2]) : 24;
+    int iterations = argc > 3 ? atoi(argv[3]) : 200;
+    if (font_size < 8 || font_size > 72 || iterations <= 0) {
+        fprintf(stderr, "Invalid font size or iteration count\n");
+        return 1;
+    }
+
+    FT_Library library;
+    FT_Face face;
+    if (FT_Init_FreeType(&library) || FT_New_Face(library, argv[1], 0, &face) ||
+        FT_Set_Pixel_Sizes(face, 0, font_size)) {
+        fprintf(stderr, "Could not load font: %s\n", argv[1]);
+        return 1;
+    }
+
+    static const wchar_t *const strings[] = {
+        L"Battery: 87%\n(Charging)",
+        L"12:34:56",
+        L"Volume 31",
+    };
+
+    printf("Font %s, size %d, %d iterations\n", argv[1], font_size, iterations);
+    printf("%-26s %12s %12s %12s %8s\n", "string", "legacy us", "cold us", "cached us", "speedup");
+    for (size_t s = 0; s < sizeof(strings) / sizeof(strings[0]); s++) {
+        const wchar_t *str = strings[s];
+
+        double start = now_ns();
+        for (int i = 0; i < iterations; i++) {
+            draw_legacy(face, str, font_size);
+        }
+        double legacy = (now_ns() - start) / iterations / 1000;
+        uint32_t legacy_sum = screen_sum();
+
+        // 第一次绘制（show_text 每次启动时的情况）：每个不同的字形光栅化一次
+        glyph_cache cache;
+        double cold = 0;
+        for (int i = 0; i < iterations; i++) {
+            glyph_cache_init(&cache, face);
+            start = now_ns();
+            draw_cached(&cache, str, font_size);
+            cold += now_ns() - start;
+            glyph_cache_destroy(&cache);
+        }
+        cold /= iterations * 1000.0;
+
+        // 缓存已有全部字形（常驻进程重复绘制的情况）
+        glyph_cache_init(&cache, face);
+        draw_cached(&cache, str, font_size);
+        start = now_ns();
+        for (int i = 0; i < iterations; i++) {
+            draw_cached(&cache, str, font_size);
+        }
+        double cached = (now_ns() - start) / iterations / 1000;
+        glyph_cache_destroy(&cache);
+        if (screen_sum() != legacy_sum) {
+            fprintf(stderr, "%ls: cached output differs from legacy\n", str);
+        }
+
+        char label[64];
+        snprintf(label, sizeof(label), "%ls", str);
+        for (char *p = label; *p; p++) {
+            if (*p == '\n') *p = ' ';
+        }
+        printf("%-26s %12.1f %12.1f %12.2f %7.1fx\n", label, legacy, cold, cached, legacy / cold);
+    }
+
+    const pixel_format *format = pixel_format_by_name("rgb565");
+    printf("\nGlyph blit to RGB565 (%s kernel, includes %dx%d background fill)\n",
+           glyph_blit_kernel_name(), SCREEN_W, SCREEN_H);
+    printf("%-26s %12s %12s %12s\n", "string", "draw_pixel", "scalar AA", "simd AA");
+    glyph_cache cache;
+    glyph_cache_init(&cache, face);
+    static uint16_t reference[SCREEN_H][SCREEN_W];
+    for (size_t s = 0; s < sizeof(strings) / sizeof(strings[0]); s++) {
+        const wchar_t *str = strings[s];
+        blit_string(&cache, format, str, font_size, NULL);
+        double legacy = time_blit(&cache, format, str, font_size, NULL, iterations);
+        double scalar = time_blit(&cache, format, str, font_size, glyph_blend_span16_scalar, iterations);
+        memcpy(reference, canvas, sizeof(canvas));
+        double simd = time_blit(&cache, format, str, font_size, glyph_blend_span16, iterations);
+        if (memcmp(reference, canvas, sizeof(canvas)) != 0) {
+            fprintf(stderr, "%ls: SIMD blend differs from scalar reference\n", str);
+        }
+
+        char label[64];
+        snprintf(label, sizeof(label), "%ls", str);
+        for (char *p = label; *p; p++) {
+            if (*p == '\n') *p = ' ';
+        }
+        printf("%-26s %12.2f %12.2f %12.2f\n", label, legacy, scalar, simd);
+    }
+
+    static char paragraph[4096];
+    for (size_t len = 0; len + 28 < sizeof(paragraph); len += 27) {
+        memcpy(paragraph + len, "lorem ipsum dolor sit amet ", 28);
+    }
+    const char *texts[] = {"Battery: 87%\n(Charging)", "12:34:56", "Volume 31", paragraph};
+    setlocale(LC_ALL, "C.UTF-8");
+    printf("\nLayout in a %dx%d box (glyphs already cached)\n", SCREEN_W, SCREEN_H);
+    printf("%-26s %12s %12s %12s\n", "string", "legacy us", "layout us", "cached us");
+    int sink = 0;
+    for (size_t s = 0; s < sizeof(texts) / sizeof(texts[0]); s++) {
+        const char *text = texts[s];
+        size_t len = strlen(text);
+        double start = now_ns();
+        for (int i = 0; i < iterations; i++) {
+            sink += measure_legacy(&cache, text, font_size);
+        }
+        double legacy = (now_ns() - start) / iterations / 1000;
+
+        // 每次都用新的排版缓存：完整的解码、字距和断行
+        double cold = 0;
+        text_layout_cache layouts;
+        for (int i = 0; i < iterations; i++) {
+            text_layout_cache_init(&layouts);
+            start = now_ns();
+            sink += text_layout_get(&layouts, &cache, text, len, font_size, ALIGN_CENTER,
+                                    ALIGN_MIDDLE, SCREEN_W, SCREEN_H)->count;
+            cold += now_ns() - start;
+            text_layout_cache_destroy(&layouts);
+        }
+        cold /= iterations * 1000.0;
+
+        // 同一标签重复绘制：直接命中缓存
+        text_layout_cache_init(&layouts);
+        start = now_ns();
+        for (int i = 0; i < iterations; i++) {
+            sink += text_layout_get(&layouts, &cache, text, len, font_size, ALIGN_CENTER,
+                                    ALIGN_MIDDLE, SCREEN_W, SCREEN_H)->count;
+        }
+        double cached = (now_ns() - start) / iterations / 1000;
+        text_layout_cache_destroy(&layouts);
+
+        char label[48];
+        if (text == paragraph) {
+            snprintf(label, sizeof(label), "paragraph (%zu bytes)", len);
+        } else {
+            snprintf(label, sizeof(label), "%s", text);
+        }
+        for (char *p = label; *p; p++) {
+            if (*p == '\n') *p = ' ';
+        }
+        printf("%-26s %12.2f %12.2f %12.2f\n", label, legacy, cold, cached);
+    }
+    if (sink == 42) {
+        printf("\n");
+    }
+    glyph_cache_destroy(&cache);
+
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+    return 0;
+}
@@ -0,0 +1,203 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "bmp_fast.h"
+
+// 小端读取（BMP头字段都是小端）
+static uint32_t read_u32(const unsigned char *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t read_u16(const unsigned char *p) {
+    return p[0] | (p[1] << 8);
+}
+
+int bmp_fast_open(bmp_image *img, const char *path) {
+    memset(img, 0, sizeof(*img));
+    img->fd = -1;
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size < 54) {
+        close(fd);
+        return -1;
+    }
+
+    unsigned char *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+
+    uint32_t data_offset = read_u32(map + 10);
+    uint32_t header_size = read_u32(map + 14);
+    int32_t width = (int32_t)read_u32(map + 18);
+    int32_t height = (int32_t)read_u32(map + 22);
+    uint16_t bpp = read_u16(map + 28);
+    uint32_t compression = read_u32(map + 30);
+
+    // 只处理 BITMAPINFOHEADER 及以上版本的24位 BI_RGB
+    if (map[0] != 'B' || map[1] != 'M' || header_size < 40 ||
+        bpp != 24 || compression != 0 || width <= 0 || height == 0 ||
+        width > 16384 || height > 16384 || height < -16384) {
+        munmap(map, st.st_size);
+        close(fd);
+        return -1;
+    }
+
+    int bottom_up = height > 0;
+    if (height < 0) {
+        height = -height;
+    }
+    size_t row_stride = ((size_t)width * 3 + 3) & ~(size_t)3;
+    if ((size_t)data_offset + row_stride * height > (size_t)st.st_size) {
+        munmap(map, st.st_size);
+        close(fd);
+        return -1;
+    }
+
+    // 顺序读取，提示内核预读
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+    img->fd = fd;
+    img->map = map;
+    img->map_size = st.st_size;
+    img->width = width;
+    img->height = height;
+    img->bottom_up = bottom_up;
+    img->row_stride = row_stride;
+    img->pixels = map + data_offset;
+    return 0;
+}
+
+void bmp_fast_close(bmp_image *img) {
+    if (img->map) {
+        munmap(img->map, img->map_size);
+    }
+    if (img->fd != -1) {
+        close(img->fd);
+    }
+    memset(img, 0, sizeof(*img));
+    img->fd = -1;
+}
+
+const unsigned char *bmp_fast_row(const bmp_image *img, int y) {
+    int row = img->bottom_up ? img->height - 1 - y : y;
+    return img->pixels + (size_t)row * img->row_stride;
+}
+
+void bgr888_to_rgb565_row_scalar(const unsigned char *src, uint16_t *dst, int count) {
+    for (int i = 0; i < count; i++) {
+        unsigned char b = src[i * 3];
+        unsigned char g = src[i * 3 + 1];
+        unsigned char r = src[i * 3 + 2];
+        dst[i] = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+    }
+}
+
+#if defined(__SSE2__)
+
+// 读取一个像素的4字节（BGR加下一个字节），第4字节在计算中被屏蔽
+static inline int load_pixel32(const unsigned char *p) {
+    int v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+// 32位通道中的BGRX转换为RGB565：
+//   R: (v >> 8) & 0xF800   G: (v >> 5) & 0x07E0   B: (v >> 3) & 0x001F
+static inline __m128i bgrx_to_rgb565_epi32(__m128i v) {
+    __m128i r = _mm_and_si128(_mm_srli_epi32(v, 8), _mm_set1_epi32(0xF800));
+    __m128i g = _mm_and_si128(_mm_srli_epi32(v, 5), _mm_set1_epi32(0x07E0));
+    __m128i b = _mm_and_si128(_mm_srli_epi32(v, 3), _mm_set1_epi32(0x001F));
+    __m128i c = _mm_or_si128(_mm_or_si128(r, g), b);
+    // 符号扩展后用有符号饱和打包，保证高位为1的值不被截断
+    return _mm_srai_epi32(_mm_slli_epi32(c, 16), 16);
+}
+
+void bgr888_to_rgb565_row(const unsigned char *src, uint16_t *dst, int count) {
+    int i = 0;
+    // 每次8个像素；保留至少一个像素给标量尾部，4字节读取不会越过最后一个像素
+    for (; i + 8 < count; i += 8) {
+        const unsigned char *p = src + i * 3;
+        __m128i lo = _mm_set_epi32(load_pixel32(p + 9), load_pixel32(p + 6),
+                                   load_pixel32(p + 3), load_pixel32(p));
+        __m128i hi = _mm_set_epi32(load_pixel32(p + 21), load_pixel32(p + 18),
+                                   load_pixel32(p + 15), load_pixel32(p + 12));
+        __m128i packed = _mm_packs_epi32(bgrx_to_rgb565_epi32(lo), bgrx_to_rgb565_epi32(hi));
+        _mm_storeu_si128((__m128i *)(dst + i), packed);
+    }
+    bgr888_to_rgb565_row_scalar(src + i * 3, dst + i, count - i);
+}
+
+const char *bmp_fast_kernel_name(void) {
+    return "sse2";
+}
+
+#elif defined(__ARM_NEON)
+
+void bgr888_to_rgb565_row(const unsigned char *src, uint16_t *dst, int count) {
+    int i = 0;
+    // 每次16个像素，vld3 直接把BGR拆成三个通道
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x3_t bgr = vld3q_u8(src + i * 3);
+        uint16x8_t lo = vshll_n_u8(vget_low_u8(bgr.val[2]), 8);
+        lo = vsriq_n_u16(lo, vshll_n_u8(vget_low_u8(bgr.val[1]), 8), 5);
+        lo = vsriq_n_u16(lo, vshll_n_u8(vget_low_u8(bgr.val[0]), 8), 11);
+        uint16x8_t hi = vshll_n_u8(vget_high_u8(bgr.val[2]), 8);
+        hi = vsriq_n_u16(hi, vshll_n_u8(vget_high_u8(bgr.val[1]), 8), 5);
+        hi = vsriq_n_u16(hi, vshll_n_u8(vget_high_u8(bgr.val[0]), 8), 11);
+        vst1q_u16(dst + i, lo);
+        vst1q_u16(dst + i + 8, hi);
+    }
+    bgr888_to_rgb565_row_scalar(src + i * 3, dst + i, count - i);
+}
+
+const char *bmp_fast_kernel_name(void) {
+    return "neon";
+}
+
+#else
+
+void bgr888_to_rgb565_row(const unsigned char *src, uint16_t *dst, int count) {
+    bgr888_to_rgb565_row_scalar(src, dst, count);
+}
+
+const char *bmp_fast_kernel_name(void) {
+    return "scalar";
+}
+
+#endif
+
+void bmp_fast_to_rgb565(const bmp_image *img, uint16_t *dst, int dst_stride) {
+    for (int y = 0; y < img->height; y++) {
+        bgr888_to_rgb565_row(bmp_fast_row(img, y), dst + (size_t)y * dst_stride, img->width);
+    }
+}
+
+void bmp_fast_to_rgb888(const bmp_image *img, unsigned char *dst) {
+    for (int y = 0; y < img->height; y++) {
+        const unsigned char *src = bmp_fast_row(img, y);
+        unsigned char *out = dst + (size_t)y * img->width * 3;
+        for (int x = 0; x < img->width; x++) {
+            out[x * 3] = src[x * 3 + 2];
+            out[x * 3 + 1] = src[x * 3 + 1];
+            out[x * 3 + 2] = src[x * 3];
+        }
+    }
+}
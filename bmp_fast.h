@@ -0,0 +1,41 @@
+#ifndef BMP_FAST_H
+#define BMP_FAST_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 24位未压缩BMP快速读取：mmap文件后按行直接转换到目标缓冲区
+// 不经过 stb_image 的通用读取流程，也不分配中间RGB缓冲
+// 其它格式（压缩、调色板、32位等）打开失败，由调用者回退到 stb_image
+
+typedef struct {
+    int fd;
+    unsigned char *map;
+    size_t map_size;
+    int width;
+    int height;
+    int bottom_up;           // BMP默认自下而上存储
+    size_t row_stride;       // 每行字节数（含4字节对齐填充）
+    const unsigned char *pixels;
+} bmp_image;
+
+// 打开并映射BMP，不是24位未压缩格式时返回-1（不打印错误）
+int bmp_fast_open(bmp_image *img, const char *path);
+void bmp_fast_close(bmp_image *img);
+
+// 第 y 行（自上而下计数）的BGR像素
+const unsigned char *bmp_fast_row(const bmp_image *img, int y);
+
+// 整幅图像转换为RGB565，dst_stride 为目标每行像素数
+void bmp_fast_to_rgb565(const bmp_image *img, uint16_t *dst, int dst_stride);
+// 整幅图像转换为自上而下的RGB888（与 stbi_load(..., 3) 的输出布局相同）
+void bmp_fast_to_rgb888(const bmp_image *img, unsigned char *dst);
+
+// 一行BGR888转换为RGB565，根据编译目标选择 SSE2/NEON/标量实现
+void bgr888_to_rgb565_row(const unsigned char *src, uint16_t *dst, int count);
+// 标量参考实现
+void bgr888_to_rgb565_row_scalar(const unsigned char *src, uint16_t *dst, int count);
+// 当前使用的转换实现名称
+const char *bmp_fast_kernel_name(void);
+
+#endif
@@ -4,7 +4,8 @@
 #include <unistd.h>
 #include <linux/input.h>
 #include <string.h>
-#include <poll.h>
+#include <sys/signalfd.h>
+#include <sys/epoll.h>
 #include <signal.h>
 #include <time.h>
 #include <sys/types.h>
@@ -13,6 +14,14 @@
 #include <errno.h>
 #include <dirent.h>
 #include <json-c/json.h>  // 添加JSON支持
+#include "anim_engine.h"
+#include "event_loop.h"
+#include "job_runner.h"
+#include "mixer.h"
+#include "sysfs.h"
+#include "uevent.h"
+#include "led.h"
+#include "text_service.h"
 
 // 页面定义
 #define MAX_PAGES 4  // 最大页面数
@@ -39,30 +48,55 @@ void update_volume(int change);
 void check_battery_status(void);
 void handle_random_animation(void);
 void cleanup(int signum);
-int get_current_volume(void);
 void play_random_animation(const char *path);
 void handle_key_event(int key_code, int value);
-void execute_command(const char *command);
+static void schedule_gesture_timer(void);
+// 异步任务结束后的后续步骤
+typedef struct {
+    void (*next)(void);
+} boot_step;
+
+void execute_command(const char *command, const boot_step *then);
 void load_script_config(void);
 void cleanup_script_config(void);
-void led_on(void);
-void led_off(void);
-void led_blink(void);
-void display_text(const char *text);
+void display_text(const char *text, const boot_step *then);
 void display_current_page(void);
 void switch_to_next_page(void);
 
 // 全局变量
-#define VOLUME_MIN 0
-#define VOLUME_MAX 63
 #define VOLUME_STEP 1
-#define BATTERY_CHECK_INTERVAL 5  // 电池检查间隔(秒)
+#define BATTERY_CHECK_INTERVAL 5  // 收不到 uevent 时轮询充电状态的间隔(秒)
+#define BATTERY_SAFETY_POLL_INTERVAL 60  // 有 uevent 时兜底读取状态的间隔(秒)
 #define DOUBLE_CLICK_THRESHOLD 300  // 双击时间阈值(毫秒)
 #define LONG_PRESS_THRESHOLD 800  // 长按时间阈值(毫秒)
-
-static int current_volume = 0;
-static int charging_status = 0;
-static int animation_pid = -1;
+#define OSD_DISMISS_MS 1000  // 提示文字显示时长(毫秒)
+#define SHOW_TEXT_TIMEOUT_MS 5000  // show_text 超时(毫秒)，也是等待文字服务应答的时间
+
+static mixer volume_mixer;           // 音量控制（直接访问 ALSA 控制设备，值缓存在内存中）
+static int mixer_ready = 0;          // 打开失败时为0，音量键无效
+static int charging_status = 0;      // 充电动画对应的状态
+static int battery_charging = 0;     // 最近一次读到的充电状态
+static uevent_monitor power_events;  // power_supply uevent，充电状态变化时立即读取
+static int power_events_ready = 0;
+static anim_engine engine;           // 进程内动画引擎（渲染线程）
+static int engine_ready = 0;         // 帧缓冲打开失败时为0，不播放动画
+
+// 事件循环及其定时器：按键手势、电池检查、提示文字消失（LED 灯效的定时器在 led.c 中）
+static event_loop loop;
+static int gesture_timer = -1;
+static int battery_timer = -1;
+static int osd_timer = -1;
+static int text_timer = -1;
+
+// 子进程（脚本、show_text）由任务表管理，在事件循环中回收，不阻塞按键处理
+static job_runner jobs;
+static pid_t text_job = 0;             // 正在绘制的 show_text，新的文字会取代它
+static const boot_step *text_step;     // 文字画完后的步骤
+// 文字服务（text_server，开机时启动）：字体一直加载着，运行时文字直接发给它，不再启动 show_text
+static pid_t text_server_job = 0;
+static text_client text_service = {-1, 0};
+static uint32_t text_pending = 0;      // 等待应答的请求编号，0 表示没有
+static int page_switch_pending = 0;    // 正在等待页面停止命令结束
 static int animation_enabled = 1;  // 是否允许播放动画 1 为允许 0 为禁止
 
 // 为每个按键设置独立的长按计数器
@@ -97,42 +131,15 @@ static struct {
     struct timespec last_release_time;  // 最后一次释放时间
 } key_state = {0, 0, 0, {0, 0}, {0, 0}};
 
-// LED 控制相关定义
-#define LED_PATH "/sys/class/leds/aku-logo"
-#define LED_TRIGGER_PATH LED_PATH "/trigger"
-#define LED_BRIGHTNESS_PATH LED_PATH "/brightness"
-
-// LED 控制函数
-void led_on(void) {
-    FILE *fp = fopen(LED_BRIGHTNESS_PATH, "w");
-    if (fp) {
-        fprintf(fp, "1");
-        fclose(fp);
-    }
-}
-
-void led_off(void) {
-    FILE *fp = fopen(LED_BRIGHTNESS_PATH, "w");
-    if (fp) {
-        fprintf(fp, "0");
-        fclose(fp);
-    }
-}
+// LED 和电池的 sysfs 属性（相对 sysfs 根目录，见 sysfs.h），启动时打开一次
+#define LED_PATH "class/leds/aku-logo"
+#define BATTERY_PATH "class/power_supply/axp20x-battery"
+#define BATTERY_STATUS_PATH BATTERY_PATH "/status"
+#define BATTERY_CAPACITY_PATH BATTERY_PATH "/capacity"
 
-// LED 闪烁函数
-void led_blink(void) {
-    // 先设置为 none 触发模式
-    FILE *fp = fopen(LED_TRIGGER_PATH, "w");
-    if (fp) {
-        fprintf(fp, "none");
-        fclose(fp);
-    }
-    
-    // 闪烁一次
-    led_off();
-    usleep(100000);  // 100ms
-    led_on();
-}
+static led status_led;               // 灯效在事件循环中逐步推进，不阻塞
+static sysfs_attr battery_status;
+static sysfs_attr battery_capacity;
 
 // 加载配置文件
 void load_script_config(void) {
@@ -206,43 +213,165 @@ void cleanup_script_config(void) {
     }
 }
 
-// 执行命令函数
-void execute_command(const char *command) {
+// 命令结束：再次闪烁LED指示命令执行完成（失败或超时时闪两次），然后执行后续步骤
+static void on_command_done(void *arg, pid_t pid, int status, int timed_out) {
+    const boot_step *then = arg;
+    (void)pid;
+    int ok = !timed_out && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    led_play(&status_led, ok ? LED_PATTERN_BLINK : LED_PATTERN_DOUBLE_BLINK, 1);
+    if (then) {
+        then->next();
+    }
+}
+
+// 执行命令函数：异步执行，结束后执行 then（可为 NULL）
+void execute_command(const char *command, const boot_step *then) {
     if (!command) return;
     
     // 闪烁LED指示命令开始执行
-    led_blink();
+    led_play(&status_led, LED_PATTERN_BLINK, 1);
     
-    pid_t pid = fork();
-    if (pid == 0) {
-        // 重定向输出到/dev/null
-        int devnull = open("/dev/null", O_WRONLY);
-        if (devnull >= 0) {
-            dup2(devnull, STDOUT_FILENO);
-            dup2(devnull, STDERR_FILENO);
-            close(devnull);
+    // 输出重定向到/dev/null
+    if (job_runner_shell(&jobs, command, JOB_QUIET, 0, on_command_done, (void *)then) == -1 &&
+        then) {
+        then->next();
+    }
+}
+
+// 文字画完（或放弃等待），执行后续步骤
+static void finish_text(void) {
+    const boot_step *then = text_step;
+    text_step = NULL;
+    if (then) {
+        then->next();
+    }
+}
+
+static void on_text_done(void *arg, pid_t pid, int status, int timed_out) {
+    (void)arg;
+    (void)status;
+    (void)timed_out;
+    if (pid != text_job) {
+        return;  // 已被新的文字取代
+    }
+    text_job = 0;
+    finish_text();
+}
+
+static void close_text_service(void) {
+    if (text_service.fd >= 0) {
+        event_loop_remove_fd(&loop, text_service.fd);
+        text_client_close(&text_service);
+    }
+}
+
+// 文字服务的应答：只有最新一段文字的应答会执行后续步骤，被取代的忽略
+static void on_text_reply(void *arg, int fd, uint32_t events) {
+    (void)arg;
+    (void)fd;
+    (void)events;
+    text_reply reply;
+    while (text_client_recv(&text_service, &reply) == 0) {
+        if (text_pending && reply.seq == text_pending) {
+            text_pending = 0;
+            event_loop_timer_cancel(&loop, text_timer);
+            finish_text();
         }
-        
-        execl("/bin/sh", "sh", "-c", command, NULL);
-        exit(1);
     }
-    
-    // 等待命令执行完成
-    waitpid(pid, NULL, 0);
-    
-    // 再次闪烁LED指示命令执行完成
-    led_blink();
+    if (errno != EAGAIN) {
+        // 服务已退出：之后改用 show_text，正在等待的文字不再等
+        close_text_service();
+        if (text_pending) {
+            text_pending = 0;
+            event_loop_timer_cancel(&loop, text_timer);
+            finish_text();
+        }
+    }
+}
+
+// 文字服务没有按时应答：断开连接，照常执行后续步骤
+static void on_text_timer(void *arg) {
+    (void)arg;
+    fprintf(stderr, "文字服务无应答\n");
+    close_text_service();
+    if (text_pending) {
+        text_pending = 0;
+        finish_text();
+    }
+}
+
+// 把文字发给文字服务，服务未运行或发送失败时返回-1
+static int send_text_request(const char *text) {
+    if (text_service.fd < 0) {
+        if (text_client_open(&text_service, 0) == -1) {
+            return -1;
+        }
+        if (event_loop_add_fd(&loop, text_service.fd, EPOLLIN, on_text_reply, NULL) == -1) {
+            text_client_close(&text_service);
+            return -1;
+        }
+    }
+    static text_request req;
+    size_t len = text_request_init(&req, text);
+    if (text_client_send(&text_service, &req, len) == -1) {
+        close_text_service();
+        return -1;
+    }
+    text_pending = req.seq;
+    event_loop_timer_start(&loop, text_timer, SHOW_TEXT_TIMEOUT_MS);
+    return 0;
+}
+
+// 显示文字，画完后执行 then（可为 NULL）；还在绘制的上一段文字被取代
+// 优先发给文字服务，服务不可用时启动 show_text
+static void show_text_async(const char *text, const boot_step *then) {
+    if (text_job > 0) {
+        job_runner_kill(&jobs, text_job);
+        text_job = 0;
+    }
+    text_step = then;
+    if (!text) {
+        text = "";  // 页面没有配置名称
+    }
+    if (send_text_request(text) == 0) {
+        return;
+    }
+    text_pending = 0;
+    event_loop_timer_cancel(&loop, text_timer);
+    char *argv[] = {"./show_text", (char *)text, "24", "0xFFFF", "1", "1", NULL};
+    text_job = job_runner_spawn(&jobs, argv, 0, SHOW_TEXT_TIMEOUT_MS, on_text_done, NULL);
+    if (text_job == -1) {
+        text_job = 0;
+        finish_text();
+    }
+}
+
+static void on_text_server_exit(void *arg, pid_t pid, int status, int timed_out) {
+    (void)arg;
+    (void)pid;
+    (void)timed_out;
+    printf("文字服务已退出 (状态 %d)，改用 show_text\n", status);
+    text_server_job = 0;
+}
+
+// 启动文字服务；在它开始监听之前显示的文字仍由 show_text 绘制
+static void start_text_server(void) {
+    char *argv[] = {"./text_server", NULL};
+    text_server_job = job_runner_spawn(&jobs, argv, 0, 0, on_text_server_exit, NULL);
+    if (text_server_job == -1) {
+        text_server_job = 0;
+    }
 }
 
 // 显示文字的辅助函数
-void display_text(const char *text) {
-    if (!animation_enabled) return;  // 如果显示被禁用，直接返回
-    pid_t pid = fork();
-    if (pid == 0) {
-        execl("./show_text", "./show_text", text, "24", "0xFFFF", "1", "1", NULL);
-        exit(1);
+void display_text(const char *text, const boot_step *then) {
+    if (!animation_enabled) {  // 如果显示被禁用，直接执行后续步骤
+        if (then) {
+            then->next();
+        }
+        return;
     }
-    waitpid(pid, NULL, 0);
+    show_text_async(text, then);
 }
 
 // 处理实际的按键动作
@@ -270,25 +399,12 @@ void process_key_action(int key_code, int action_type) {
                 animation_enabled = !animation_enabled;
                 printf("显示状态: %s\n", animation_enabled ? "启用" : "禁用");
                 
-                pid_t status_pid = fork();
-                if (status_pid == 0) {
-                    char text[128];
-                    snprintf(text, sizeof(text), "Animation: \n%s", 
-                            animation_enabled ? "Enabled" : "Disabled");
-                    execl("./show_text", "./show_text", text, "24", "0xFFFF", "1", "1", NULL);
-                    exit(1);
-                }
-                waitpid(status_pid, NULL, 0);
-                sleep(1);
-                
-                pid_t clear_pid = fork();
-                if (clear_pid == 0) {
-                    execl("./show_text", "./show_text", "", "24", "0xFFFF", "1", "1", NULL);
-                    exit(1);
-                }
-                if(animation_enabled){
-                    display_current_page();
-                }
+                char text[128];
+                snprintf(text, sizeof(text), "Animation: \n%s", 
+                        animation_enabled ? "Enabled" : "Disabled");
+                show_text_async(text, NULL);
+                // 提示显示 OSD_DISMISS_MS 后由定时器清除，期间照常处理按键
+                event_loop_timer_start(&loop, osd_timer, OSD_DISMISS_MS);
             }
             else if (action_type == 3) {
                 // 长按：根据计数器执行不同脚本
@@ -304,7 +420,7 @@ void process_key_action(int key_code, int action_type) {
                 }
                 if (command) {
                     printf("电源键长按 - 执行命令: %s\n", command);
-                    execute_command(command);
+                    execute_command(command, NULL);
                 }
             }
             break;
@@ -320,7 +436,7 @@ void process_key_action(int key_code, int action_type) {
                 char *command = script_config.volup_scripts[script_idx];
                 if (command) {
                     printf("音量加长按 - 执行命令: %s\n", command);
-                    execute_command(command);
+                    execute_command(command, NULL);
                 }
             }
             break;
@@ -336,7 +452,7 @@ void process_key_action(int key_code, int action_type) {
                 char *command = script_config.voldown_scripts[script_idx];
                 if (command) {
                     printf("音量减长按 - 执行命令: %s\n", command);
-                    execute_command(command);
+                    execute_command(command, NULL);
                 }
             }
             break;
@@ -376,9 +492,10 @@ void handle_key_event(int key_code, int value) {
         key_state.is_pressed = 0;
         key_state.last_release_time = current_time;
     }
+    schedule_gesture_timer();
 }
 
-// 在主循环中检查事件
+// 检查长按和单击是否已经成立（由手势定时器在阈值时刻调用）
 void check_pending_clicks(void) {
     if (key_state.is_pressed) {
         struct timespec current_time;
@@ -406,55 +523,49 @@ void check_pending_clicks(void) {
     }
 }
 
-// 播放动画
+static uint64_t timespec_to_ns(struct timespec ts) {
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// 按当前按键状态设置手势定时器：按住时在长按阈值触发，
+// 单击松开后在双击窗口结束时触发，其它情况不需要定时器
+static void schedule_gesture_timer(void) {
+    if (key_state.is_pressed) {
+        event_loop_timer_at(&loop, gesture_timer, timespec_to_ns(key_state.last_press_time) +
+                            LONG_PRESS_THRESHOLD * 1000000ULL);
+    } else if (key_state.click_count == 1) {
+        event_loop_timer_at(&loop, gesture_timer, timespec_to_ns(key_state.last_release_time) +
+                            DOUBLE_CLICK_THRESHOLD * 1000000ULL);
+    } else {
+        event_loop_timer_cancel(&loop, gesture_timer);
+    }
+}
+
+static void on_gesture_timer(void *arg) {
+    (void)arg;
+    check_pending_clicks();
+    schedule_gesture_timer();
+}
+
+// 播放动画：交给渲染线程切换，当前动画在下一帧之前结束
 void play_animation(const char *animation_name, int loop_once, int delay) {
     if (!animation_name) {
         printf("错误：动画名称为空\n");
         return;
     }
-
-    // 停止当前动画
-    if (animation_pid > 0) {
-        kill(animation_pid, SIGTERM);
-        waitpid(animation_pid, NULL, 0);
+    if (!engine_ready) {
+        return;
     }
-    
-    // 创建新进程
-    pid_t pid = fork();
-    if (pid < 0) {
-        printf("错误：无法创建动画进程\n");
+
+    if (anim_engine_play(&engine, animation_name, loop_once, delay) == -1) {
+        printf("错误：无法播放动画 %s\n", animation_name);
         return;
     }
-    
-    if (pid == 0) {
-        // 子进程
-        // 重定向输出到/dev/null
-        int devnull = open("/dev/null", O_WRONLY);
-        if (devnull >= 0) {
-            dup2(devnull, STDOUT_FILENO);
-            dup2(devnull, STDERR_FILENO);
-            close(devnull);
-        }
-        
-        char delay_str[16];
-        snprintf(delay_str, sizeof(delay_str), "%d", delay);
-        
-        if (loop_once) {
-            execlp("./play_bmp_sequence", "./play_bmp_sequence", "-d", delay_str, "-l", animation_name, NULL);
-        } else {
-            execlp("./play_bmp_sequence", "./play_bmp_sequence", "-d", delay_str, animation_name, NULL);
-        }
-        exit(1);
-    } else {
-        // 父进程
-        animation_pid = pid;
-        printf("启动动画进程，PID: %d\n", pid);
-        // 如果是只播放一次的动画，等待它结束并重置 PID
-        if (loop_once) {
-            waitpid(pid, NULL, 0);
-            animation_pid = -1;
-            printf("动画播放结束，PID: %d\n", pid);
-        }
+    printf("播放动画: %s\n", animation_name);
+    // 只播放一次的动画，等待它结束
+    if (loop_once) {
+        anim_engine_wait(&engine);
+        printf("动画播放结束: %s\n", animation_name);
     }
 }
 
@@ -465,130 +576,162 @@ void show_battery_info() {
 
     char status[32];
     char capacity[32];
-    FILE *fp;
     
     printf("开始读取电池信息...\n");
     
     // 读取充电状态
-    fp = fopen("/sys/class/power_supply/axp20x-battery/status", "r");
-    if (fp) {
-        fgets(status, sizeof(status), fp);
-        // 移除换行符
-        status[strcspn(status, "\n")] = 0;
-        fclose(fp);
+    if (sysfs_read(&battery_status, status, sizeof(status)) >= 0) {
         printf("读取到充电状态: %s\n", status);
     } else {
-        printf("无法打开充电状态文件\n");
+        printf("无法读取充电状态文件\n");
         return;
     }
     
     // 读取电量
-    fp = fopen("/sys/class/power_supply/axp20x-battery/capacity", "r");
-    if (fp) {
-        fgets(capacity, sizeof(capacity), fp);
-        // 移除换行符
-        capacity[strcspn(capacity, "\n")] = 0;
-        fclose(fp);
+    if (sysfs_read(&battery_capacity, capacity, sizeof(capacity)) >= 0) {
         printf("读取到电池电量: %s\n", capacity);
     } else {
-        printf("无法打开电池电量文件\n");
+        printf("无法读取电池电量文件\n");
         return;
     }
     
     char text[128];
     snprintf(text, sizeof(text), "Battery: %s%%\n(%s)", capacity, status);
-    display_text(text);
+    display_text(text, NULL);
 }
 
-// 更新音量
+// 更新音量：只改缓存中的目标值，连续按键由混音器合并写入
 void update_volume(int change) {
     // 停止动画
     stop_animation();
 
-    char cmd[128];
-    
-    // 先获取当前实际音量
-    current_volume = get_current_volume();
-    
-    int new_volume = current_volume + change;
-    
-    // 边界检查
-    if (new_volume < VOLUME_MIN) new_volume = VOLUME_MIN;
-    if (new_volume > VOLUME_MAX) new_volume = VOLUME_MAX;
-    
-    if (new_volume != current_volume) {
-        // 重定向标准输出和错误输出到/dev/null
-        snprintf(cmd, sizeof(cmd), "amixer set 'Power Amplifier' %d > /dev/null 2>&1", new_volume);
-        system(cmd);
-        current_volume = new_volume;
+    if (!mixer_ready) {
+        return;
     }
-    printf("当前音量: %d\n", new_volume);
+    long new_volume = mixer_set(&volume_mixer, mixer_get(&volume_mixer) + change);
+    printf("当前音量: %ld\n", new_volume);
 }
 
 // 检查电池状态
 void check_battery_status() {
-    FILE *fp = fopen("/sys/class/power_supply/axp20x-battery/status", "r");
-    if (fp) {
-        char status[32];
-        fgets(status, sizeof(status), fp);
-        fclose(fp);
-        
-        int new_status = strstr(status, "Charging") != NULL;
-        if (new_status != charging_status) {
-            charging_status = new_status;
-            if (charging_status&&animation_enabled) {
-                play_animation("charging", 0, 100);  // 充电动画无限循环
-            } else {
-                stop_animation();  // 停止充电动画
-            }
-        } else if (charging_status && animation_pid <= 0) {
-            // 如果正在充电但没有动画在运行，重新启动动画
-            play_animation("charging", 0, 100);
+    char status[32];
+    if (sysfs_read(&battery_status, status, sizeof(status)) >= 0) {
+        battery_charging = strstr(status, "Charging") != NULL;
+    }
+}
+
+// 按最近读到的充电状态播放或停止充电动画，不读取 sysfs
+static void update_charging_animation(void) {
+    int new_status = battery_charging;
+    if (new_status != charging_status) {
+        charging_status = new_status;
+        if (charging_status&&animation_enabled) {
+            play_animation("charging", 0, 100);  // 充电动画无限循环
+        } else {
+            stop_animation();  // 停止充电动画
         }
     }
 }
 
-// 停止动画
+// 渲染线程通知动画自然结束：仍在充电且没有新动画时，重新启动充电动画
+static void on_animation_finished(void *arg, int fd, uint32_t events) {
+    (void)arg;
+    (void)events;
+    uint64_t count;
+    if (read(fd, &count, sizeof(count)) != sizeof(count)) {
+        return;
+    }
+    if (page_state.current_page == 0 && charging_status && animation_enabled &&
+        !anim_engine_busy(&engine)) {
+        play_animation("charging", 0, 100);
+    }
+}
+
+// power_supply uevent（电池或充电器）：立即重新读取充电状态
+static void on_power_uevent(void *arg, const uevent *ev) {
+    (void)arg;
+    printf("电源事件: %s %s\n", ev->action, ev->devpath);
+    check_battery_status();
+    if (page_state.current_page == 0) {
+        update_charging_animation();
+    }
+    // 刚读过状态，兜底读取从现在起重新计时
+    event_loop_timer_start(&loop, battery_timer, BATTERY_SAFETY_POLL_INTERVAL * 1000);
+}
+
+// 停止动画，返回时画面已交还，可以用 show_text 绘制
 void stop_animation(void) {
-    if (animation_pid > 0) {
-        kill(animation_pid, SIGTERM);
-        waitpid(animation_pid, NULL, 0);
-        animation_pid = -1;
+    if (engine_ready) {
+        anim_engine_stop(&engine);
     }
 }
 
-// 清理函数
-void cleanup(int signum) {
-    if (animation_pid > 0) {
-        kill(animation_pid, SIGTERM);
-        waitpid(animation_pid, NULL, 0);
+// 电池检查定时器，只在表情界面（页面0）检查：收不到 uevent 时每 BATTERY_CHECK_INTERVAL 秒轮询，
+// 有 uevent 时状态变化已经读过，只每 BATTERY_SAFETY_POLL_INTERVAL 秒兜底读取一次
+static void on_battery_timer(void *arg) {
+    (void)arg;
+    if (page_state.current_page == 0) {
+        check_battery_status();
+        update_charging_animation();
     }
-    cleanup_script_config();
-    exit(0);
+    int interval = power_events_ready ? BATTERY_SAFETY_POLL_INTERVAL : BATTERY_CHECK_INTERVAL;
+    event_loop_timer_start(&loop, battery_timer, interval * 1000);
 }
 
-// 获取当前音量
-int get_current_volume(void) {
-    FILE *fp;
-    char cmd[128];
-    char result[32];
-    int volume = 0;
-    
-    // 使用amixer命令获取当前音量
-    snprintf(cmd, sizeof(cmd), "amixer get 'Power Amplifier' | grep 'Mono:' | awk '{print $2}'");
-    fp = popen(cmd, "r");
-    if (fp) {
-        if (fgets(result, sizeof(result), fp)) {
-            volume = atoi(result);
+static void restore_page_after_osd(void) {
+    if (animation_enabled) {
+        display_current_page();
+    }
+}
+
+static const boot_step osd_cleared_step = {restore_page_after_osd};
+
+// 提示文字到时清除，清除后恢复当前页面
+static void on_osd_timer(void *arg) {
+    (void)arg;
+    show_text_async("", &osd_cleared_step);
+}
+
+// SIGINT/SIGTERM 通过 signalfd 送到事件循环，退出主循环后再清理
+static void on_signal(void *arg, int fd, uint32_t events) {
+    (void)arg;
+    (void)events;
+    struct signalfd_siginfo info;
+    if (read(fd, &info, sizeof(info)) == sizeof(info)) {
+        printf("收到信号 %u，退出\n", info.ssi_signo);
+        loop.stop = 1;
+    }
+}
+
+// 读取输入事件；power_only 非0时只处理电源键（event0）
+static void on_input(void *arg, int fd, uint32_t events) {
+    int power_only = arg != NULL;
+    struct input_event ev;
+    if (read(fd, &ev, sizeof(struct input_event)) != sizeof(struct input_event)) {
+        // 设备已移除：不再监视，避免 EPOLLHUP 反复唤醒
+        if (events & (EPOLLHUP | EPOLLERR)) {
+            printf("输入设备已断开\n");
+            event_loop_remove_fd(&loop, fd);
         }
-        pclose(fp);
+        return;
     }
-    
-    // 确保音量在有效范围内
-    if (volume < VOLUME_MIN) volume = VOLUME_MIN;
-    if (volume > VOLUME_MAX) volume = VOLUME_MAX;
+    if (ev.type != EV_KEY) {
+        return;
+    }
+    if (power_only && ev.code != KEY_POWER) {
+        return;
+    }
+    handle_key_event(ev.code, ev.value);
+}
 
-    return volume;
+// 清理函数
+void cleanup(int signum) {
+    if (engine_ready) {
+        anim_engine_destroy(&engine);
+        engine_ready = 0;
+    }
+    cleanup_script_config();
+    exit(0);
 }
 
 // 随机播放动画
@@ -673,6 +816,16 @@ void play_random_animation(const char *path) {
     free(folders);
 }
 
+// 页面标题画完后执行页面的启动命令
+static void run_page_start_cmd(void) {
+    const char *command = page_config[page_state.current_page].start_cmd;
+    if (command && command[0] != '\0') {
+        execute_command(command, NULL);
+    }
+}
+
+static const boot_step page_title_step = {run_page_start_cmd};
+
 // 显示当前页面
 void display_current_page(void) {
     switch (page_state.current_page) {
@@ -683,54 +836,108 @@ void display_current_page(void) {
             break;
         default:  // 其他页面
             printf("显示页面: %s\n", page_config[page_state.current_page].name);
-            display_text(page_config[page_state.current_page].name);
-            usleep(100000);
-            if (page_config[page_state.current_page].start_cmd && 
-                page_config[page_state.current_page].start_cmd[0] != '\0') {
-                execute_command(page_config[page_state.current_page].start_cmd);
-            }
+            display_text(page_config[page_state.current_page].name, &page_title_step);
             break;
     }
 }
 
+// 上一页面的停止命令结束后显示新页面
+static void finish_page_switch(void) {
+    page_switch_pending = 0;
+    display_current_page();
+}
+
+static const boot_step page_stopped_step = {finish_page_switch};
+
 // 切换到下一个页面
 void switch_to_next_page(void) {
-    // 如果当前页面有停止命令，执行它
-    if (page_state.current_page > 0 && 
-        page_config[page_state.current_page].stop_cmd && 
-        page_config[page_state.current_page].stop_cmd[0] != '\0') {
-        execute_command(page_config[page_state.current_page].stop_cmd);
+    if (page_switch_pending) {
+        printf("页面切换中，忽略\n");
+        return;
     }
     
+    // 切换页面后不再恢复提示前的页面
+    event_loop_timer_cancel(&loop, osd_timer);
+    int previous_page = page_state.current_page;
+    page_state.current_page = (page_state.current_page + 1) % MAX_PAGES;
+    
     // 如果当前是表情页面，先停止动画
-    if (page_state.current_page == 0) {
+    if (previous_page == 0) {
         stop_animation();
     }
     
-    page_state.current_page = (page_state.current_page + 1) % MAX_PAGES;
+    // 如果当前页面有停止命令，执行它，结束后再显示新页面
+    if (previous_page > 0 && 
+        page_config[previous_page].stop_cmd && 
+        page_config[previous_page].stop_cmd[0] != '\0') {
+        page_switch_pending = 1;
+        execute_command(page_config[previous_page].stop_cmd, &page_stopped_step);
+        return;
+    }
     display_current_page();
 }
 
 int main(int argc, char *argv[]) {
     int fd0, fd1;
-    struct input_event ev;
-    struct pollfd fds[2];
     char *device0 = "/dev/input/event0";
     char *device1 = "/dev/input/event1";
     
-    // 设置信号处理
-    signal(SIGINT, cleanup);
-    signal(SIGTERM, cleanup);
+    // 设置信号处理：屏蔽 SIGINT/SIGTERM，由事件循环通过 signalfd 处理
+    // （必须在创建渲染线程之前屏蔽，线程继承信号屏蔽）
+    sigset_t quit_signals;
+    sigemptyset(&quit_signals);
+    sigaddset(&quit_signals, SIGINT);
+    sigaddset(&quit_signals, SIGTERM);
+    sigprocmask(SIG_BLOCK, &quit_signals, NULL);
+    int signal_fd = signalfd(-1, &quit_signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signal_fd == -1) {
+        perror("signalfd");
+        return -1;
+    }
+
+    if (event_loop_init(&loop) == -1) {
+        return -1;
+    }
+    gesture_timer = event_loop_add_timer(&loop, on_gesture_timer, NULL);
+    battery_timer = event_loop_add_timer(&loop, on_battery_timer, NULL);
+    osd_timer = event_loop_add_timer(&loop, on_osd_timer, NULL);
+    text_timer = event_loop_add_timer(&loop, on_text_timer, NULL);
+    if (job_runner_init(&jobs, &loop) == -1) {
+        return -1;
+    }
+    start_text_server();
     
     // 初始化随机数生成器
     srand(time(NULL));
     
-    // 获取当前音量
-    current_volume = get_current_volume();
-    printf("当前音量: %d\n", current_volume);
+    // 打开 LED 和电池属性，之后每次访问只需一次 pread/pwrite
+    if (led_open(&status_led, LED_PATH, &loop) == -1) {
+        return -1;
+    }
+    sysfs_attr_open(&battery_status, BATTERY_STATUS_PATH, O_RDONLY);
+    sysfs_attr_open(&battery_capacity, BATTERY_CAPACITY_PATH, O_RDONLY);
+    
+    // 订阅 power_supply uevent；失败时按 BATTERY_CHECK_INTERVAL 轮询状态文件
+    power_events_ready = uevent_monitor_open(&power_events, "power_supply", on_power_uevent, NULL) == 0;
+    if (power_events_ready && uevent_monitor_attach(&power_events, &loop) == -1) {
+        uevent_monitor_close(&power_events);
+        power_events_ready = 0;
+    }
+    if (!power_events_ready) {
+        printf("无法订阅电源事件，改为轮询电池状态\n");
+    }
+    
+    // 打开混音器，读取当前音量
+    mixer_ready = mixer_open(&volume_mixer, NULL) == 0 &&
+                  mixer_attach(&volume_mixer, &loop) == 0;
+    if (mixer_ready) {
+        printf("当前音量: %ld\n", mixer_get(&volume_mixer));
+    } else {
+        printf("无法打开混音器，音量键无效\n");
+    }
     
     // 打开输入设备0
-    fd0 = open(device0, O_RDONLY);
+    fd0 = open(device0, O_RDONLY | O_CLOEXEC);
     if (fd0 == -1) {
         printf("无法打开输入设备 %s\n", device0);
         return -1;
@@ -738,7 +945,7 @@ int main(int argc, char *argv[]) {
     printf("成功打开设备 %s\n", device0);
     
     // 打开输入设备1
-    fd1 = open(device1, O_RDONLY);
+    fd1 = open(device1, O_RDONLY | O_CLOEXEC);
     if (fd1 == -1) {
         printf("无法打开输入设备 %s\n", device1);
         close(fd0);
@@ -746,60 +953,58 @@ int main(int argc, char *argv[]) {
     }
     printf("成功打开设备 %s\n", device1);
     
-    // 设置poll结构
-    fds[0].fd = fd0;
-    fds[0].events = POLLIN;
-    fds[1].fd = fd1;
-    fds[1].events = POLLIN;
+    // 电源键事件在event0，音量键在event1
+    if (event_loop_add_fd(&loop, fd0, EPOLLIN, on_input, (void *)1) == -1 ||
+        event_loop_add_fd(&loop, fd1, EPOLLIN, on_input, NULL) == -1 ||
+        event_loop_add_fd(&loop, signal_fd, EPOLLIN, on_signal, NULL) == -1) {
+        close(fd0);
+        close(fd1);
+        return -1;
+    }
     
-    // 播放开机动画
-    play_animation("booting", 1, 20);  // 开机动画只播放一次
-    // 等待开机动画结束
-    while (animation_pid > 0) {
-        usleep(100000);  // 等待 100ms
+    // 启动动画引擎：帧缓冲只打开一次，之后所有动画都在渲染线程中播放
+    engine_ready = anim_engine_start(&engine) == 0;
+    if (!engine_ready) {
+        printf("无法启动动画引擎，不播放动画\n");
+    } else if (event_loop_add_fd(&loop, engine.finished_fd, EPOLLIN, on_animation_finished, NULL) == -1) {
+        printf("无法监听动画结束事件，充电动画结束后不会自动重播\n");
     }
+
+    // 播放开机动画（只播放一次，返回时已播放结束）
+    play_animation("booting", 1, 20);
     
     printf("开始监控按键事件...\n");
     // 显示初始页面
     display_current_page();
+    // 立即做第一次电池检查，之后按间隔检查
+    event_loop_timer_start(&loop, battery_timer, 0);
     
-    // 循环读取输入事件
-    while (1) {
-        // 检查待处理的点击事件
-        check_pending_clicks();
-        
-        // 只在表情界面（页面0）检查电池状态
-        if (page_state.current_page == 0) {
-            check_battery_status();
-        }
-        
-        // 等待事件
-        int ret = poll(fds, 2, 100);  // 100毫秒超时
-        if (ret > 0) {
-            // 检查event0 ： 电源键事件在event0
-            if (fds[0].revents & POLLIN) {
-                if (read(fd0, &ev, sizeof(struct input_event)) == sizeof(struct input_event)) {
-                    if (ev.type == EV_KEY) {
-                        if (ev.code == KEY_POWER) {
-                            // printf("检测到电源键事件，value = %d\n", ev.value);
-                            handle_key_event(KEY_POWER, ev.value);
-                        }
-                    }
-                }
-            }
-            
-            // 检查event1 音量键在event1
-            if (fds[1].revents & POLLIN) {
-                if (read(fd1, &ev, sizeof(struct input_event)) == sizeof(struct input_event)) {
-                    if (ev.type == EV_KEY) {
-                        handle_key_event(ev.code, ev.value);
-                    }
-                }
-            }
-        }
-    }
+    // 处理输入事件和定时器，空闲时不唤醒
+    event_loop_run(&loop);
+    printf("事件循环唤醒次数: %llu\n", (unsigned long long)loop.wakeups);
     
     // 清理资源
+    close(fd0);
+    close(fd1);
+    close(signal_fd);
+    if (mixer_ready) {
+        mixer_report(&volume_mixer);
+        mixer_close(&volume_mixer);
+        mixer_ready = 0;
+    }
+    close_text_service();
+    if (text_server_job > 0) {
+        job_runner_kill(&jobs, text_server_job);
+    }
+    job_runner_destroy(&jobs);
+    event_loop_destroy(&loop);
+    if (power_events_ready) {
+        uevent_monitor_close(&power_events);
+        power_events_ready = 0;
+    }
+    led_close(&status_led);
+    sysfs_attr_close(&battery_status);
+    sysfs_attr_close(&battery_capacity);
     cleanup(0);
     return 0;
 }
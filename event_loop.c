@@ -0,0 +1,182 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+#include "event_loop.h"
+
+uint64_t event_loop_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// 按最早的截止时刻设置 timerfd，与当前设置相同时不调用系统调用
+static void rearm(event_loop *loop) {
+    uint64_t earliest = 0;
+    for (int i = 0; i < loop->timer_count; i++) {
+        uint64_t deadline = loop->timers[i].deadline_ns;
+        if (deadline && (!earliest || deadline < earliest)) {
+            earliest = deadline;
+        }
+    }
+    if (earliest == loop->armed_ns) {
+        return;
+    }
+
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = earliest / 1000000000ULL;
+    spec.it_value.tv_nsec = earliest % 1000000000ULL;
+    if (timerfd_settime(loop->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) == -1) {
+        perror("Error arming timer");
+        return;
+    }
+    loop->armed_ns = earliest;
+}
+
+// 触发所有已到期的定时器；回调中可以重新启动任何定时器
+static void run_timers(event_loop *loop) {
+    uint64_t expirations;
+    if (read(loop->timer_fd, &expirations, sizeof(expirations)) == -1 && errno != EAGAIN) {
+        perror("Error reading timer");
+    }
+    loop->armed_ns = 0;
+
+    uint64_t now = event_loop_now_ns();
+    for (int i = 0; i < loop->timer_count; i++) {
+        event_timer *timer = &loop->timers[i];
+        if (timer->deadline_ns && timer->deadline_ns <= now) {
+            timer->deadline_ns = 0;
+            timer->fn(timer->arg);
+        }
+    }
+}
+
+int event_loop_init(event_loop *loop) {
+    memset(loop, 0, sizeof(*loop));
+    loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (loop->epoll_fd == -1) {
+        perror("Error creating epoll");
+        return -1;
+    }
+    loop->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (loop->timer_fd == -1) {
+        perror("Error creating timerfd");
+        close(loop->epoll_fd);
+        return -1;
+    }
+
+    // timerfd 用 data.fd = -1 与普通文件描述符区分
+    struct epoll_event ev = {.events = EPOLLIN, .data.fd = -1};
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->timer_fd, &ev) == -1) {
+        perror("Error watching timerfd");
+        close(loop->timer_fd);
+        close(loop->epoll_fd);
+        return -1;
+    }
+    return 0;
+}
+
+void event_loop_destroy(event_loop *loop) {
+    close(loop->timer_fd);
+    close(loop->epoll_fd);
+    loop->timer_fd = loop->epoll_fd = -1;
+}
+
+int event_loop_add_fd(event_loop *loop, int fd, uint32_t events, event_fd_fn fn, void *arg) {
+    if (loop->watch_count >= EVENT_LOOP_MAX_FDS) {
+        fprintf(stderr, "Too many watched file descriptors\n");
+        return -1;
+    }
+    struct epoll_event ev = {.events = events, .data.fd = fd};
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        perror("Error watching file descriptor");
+        return -1;
+    }
+    event_watch *watch = &loop->watches[loop->watch_count++];
+    watch->fd = fd;
+    watch->fn = fn;
+    watch->arg = arg;
+    return 0;
+}
+
+void event_loop_remove_fd(event_loop *loop, int fd) {
+    for (int i = 0; i < loop->watch_count; i++) {
+        if (loop->watches[i].fd == fd) {
+            epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+            loop->watches[i] = loop->watches[--loop->watch_count];
+            return;
+        }
+    }
+}
+
+int event_loop_add_timer(event_loop *loop, event_timer_fn fn, void *arg) {
+    if (loop->timer_count >= EVENT_LOOP_MAX_TIMERS) {
+        fprintf(stderr, "Too many timers\n");
+        return -1;
+    }
+    event_timer *timer = &loop->timers[loop->timer_count];
+    timer->fn = fn;
+    timer->arg = arg;
+    timer->deadline_ns = 0;
+    return loop->timer_count++;
+}
+
+void event_loop_timer_at(event_loop *loop, int timer, uint64_t deadline_ns) {
+    if (timer < 0 || timer >= loop->timer_count) {
+        return;
+    }
+    loop->timers[timer].deadline_ns = deadline_ns ? deadline_ns : 1;
+    rearm(loop);
+}
+
+void event_loop_timer_start(event_loop *loop, int timer, int delay_ms) {
+    event_loop_timer_at(loop, timer, event_loop_now_ns() + (uint64_t)delay_ms * 1000000ULL);
+}
+
+void event_loop_timer_cancel(event_loop *loop, int timer) {
+    if (timer < 0 || timer >= loop->timer_count || !loop->timers[timer].deadline_ns) {
+        return;
+    }
+    loop->timers[timer].deadline_ns = 0;
+    rearm(loop);
+}
+
+int event_loop_run_once(event_loop *loop) {
+    struct epoll_event events[EVENT_LOOP_MAX_FDS + 1];
+    int count = epoll_wait(loop->epoll_fd, events, EVENT_LOOP_MAX_FDS + 1, -1);
+    if (count == -1) {
+        if (errno != EINTR) {
+            perror("Error waiting for events");
+        }
+        return -1;
+    }
+    loop->wakeups++;
+
+    for (int i = 0; i < count; i++) {
+        int fd = events[i].data.fd;
+        if (fd == -1) {
+            run_timers(loop);
+            continue;
+        }
+        // 回调可能移除监视，按 fd 重新查找
+        for (int j = 0; j < loop->watch_count; j++) {
+            if (loop->watches[j].fd == fd) {
+                loop->watches[j].fn(loop->watches[j].arg, fd, events[i].events);
+                break;
+            }
+        }
+    }
+    rearm(loop);
+    return 0;
+}
+
+void event_loop_run(event_loop *loop) {
+    while (!loop->stop) {
+        event_loop_run_once(loop);
+    }
+}
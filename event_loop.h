@@ -0,0 +1,64 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <stdint.h>
+
+// 事件循环：epoll 等待文件描述符，所有定时器共用一个 timerfd
+// timerfd 总是按最早的截止时刻（CLOCK_MONOTONIC 绝对时间）设置，没有定时器时不设置，
+// 空闲时不会被唤醒；定时器在截止时刻准时触发，不受轮询间隔影响
+
+#define EVENT_LOOP_MAX_FDS    16
+#define EVENT_LOOP_MAX_TIMERS 16
+
+typedef void (*event_fd_fn)(void *arg, int fd, uint32_t events);
+typedef void (*event_timer_fn)(void *arg);
+
+typedef struct {
+    int fd;
+    event_fd_fn fn;
+    void *arg;
+} event_watch;
+
+typedef struct {
+    event_timer_fn fn;
+    void *arg;
+    uint64_t deadline_ns;    // 0 表示未启动
+} event_timer;
+
+typedef struct {
+    int epoll_fd;
+    int timer_fd;
+    uint64_t armed_ns;       // timerfd 当前设置的截止时刻，0 表示未设置
+    event_watch watches[EVENT_LOOP_MAX_FDS];
+    int watch_count;
+    event_timer timers[EVENT_LOOP_MAX_TIMERS];
+    int timer_count;
+    int stop;
+    uint64_t wakeups;        // epoll_wait 返回次数
+} event_loop;
+
+// 成功返回0
+int event_loop_init(event_loop *loop);
+void event_loop_destroy(event_loop *loop);
+
+// 监视 fd（events 为 EPOLLIN 等），成功返回0
+int event_loop_add_fd(event_loop *loop, int fd, uint32_t events, event_fd_fn fn, void *arg);
+void event_loop_remove_fd(event_loop *loop, int fd);
+
+// 注册定时器，返回定时器编号（未启动），失败返回-1
+int event_loop_add_timer(event_loop *loop, event_timer_fn fn, void *arg);
+// 在 delay_ms 毫秒后触发（已启动时改为新的时刻），只触发一次
+void event_loop_timer_start(event_loop *loop, int timer, int delay_ms);
+// 在绝对时刻 deadline_ns（CLOCK_MONOTONIC）触发
+void event_loop_timer_at(event_loop *loop, int timer, uint64_t deadline_ns);
+void event_loop_timer_cancel(event_loop *loop, int timer);
+
+// 处理一轮事件（没有事件时一直等待），被信号打断时返回-1
+int event_loop_run_once(event_loop *loop);
+// 循环处理事件，直到 loop->stop 被置位
+void event_loop_run(event_loop *loop);
+
+// CLOCK_MONOTONIC 当前时刻（纳秒）
+uint64_t event_loop_now_ns(void);
+
+#endif
@@ -0,0 +1,457 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+
+#include "fb_backend.h"
+#include "pixel_format.h"
+
+// 解析 "offset:length" 形式的位域
+static int parse_bitfield(const char *value, struct fb_bitfield *field) {
+    unsigned offset, length;
+    if (sscanf(value, "%u:%u", &offset, &length) != 2 || offset + length > 32) {
+        return -1;
+    }
+    memset(field, 0, sizeof(*field));
+    field->offset = offset;
+    field->length = length;
+    return 0;
+}
+
+// 解析模拟设备参数，填写 vinfo/finfo；file 返回存储文件路径（可能为空）
+static int parse_emu_spec(const char *spec, struct fb_var_screeninfo *vinfo,
+                          struct fb_fix_screeninfo *finfo, char *file, size_t file_size, int *pan) {
+    char buf[512];
+    snprintf(buf, sizeof(buf), "%s", spec);
+    file[0] = '\0';
+    *pan = 1;
+
+    const pixel_format *format = pixel_format_by_name("rgb565");
+    memset(vinfo, 0, sizeof(*vinfo));
+    memset(finfo, 0, sizeof(*finfo));
+    vinfo->bits_per_pixel = format->bits_per_pixel;
+    vinfo->red = format->red;
+    vinfo->green = format->green;
+    vinfo->blue = format->blue;
+    vinfo->transp = format->transp;
+    unsigned line_length = 0;
+
+    char *save = NULL;
+    char *token = strtok_r(buf, ",", &save);
+    if (!token || sscanf(token, "%ux%u", &vinfo->xres, &vinfo->yres) != 2 ||
+        vinfo->xres == 0 || vinfo->yres == 0 || vinfo->xres > 8192 || vinfo->yres > 8192) {
+        fprintf(stderr, "Invalid emulated framebuffer size in \"%s\"\n", spec);
+        return -1;
+    }
+
+    while ((token = strtok_r(NULL, ",", &save)) != NULL) {
+        char *value = strchr(token, '=');
+        if (!value) {
+            fprintf(stderr, "Invalid emulated framebuffer option \"%s\"\n", token);
+            return -1;
+        }
+        *value++ = '\0';
+
+        int ok = 1;
+        if (strcmp(token, "format") == 0) {
+            format = pixel_format_by_name(value);
+            ok = format != NULL;
+            if (ok) {
+                vinfo->bits_per_pixel = format->bits_per_pixel;
+                vinfo->red = format->red;
+                vinfo->green = format->green;
+                vinfo->blue = format->blue;
+                vinfo->transp = format->transp;
+            }
+        } else if (strcmp(token, "bpp") == 0) {
+            vinfo->bits_per_pixel = atoi(value);
+            ok = vinfo->bits_per_pixel == 16 || vinfo->bits_per_pixel == 24 ||
+                 vinfo->bits_per_pixel == 32;
+        } else if (strcmp(token, "red") == 0) {
+            ok = parse_bitfield(value, &vinfo->red) == 0;
+        } else if (strcmp(token, "green") == 0) {
+            ok = parse_bitfield(value, &vinfo->green) == 0;
+        } else if (strcmp(token, "blue") == 0) {
+            ok = parse_bitfield(value, &vinfo->blue) == 0;
+        } else if (strcmp(token, "transp") == 0) {
+            ok = parse_bitfield(value, &vinfo->transp) == 0;
+        } else if (strcmp(token, "line") == 0) {
+            line_length = atoi(value);
+        } else if (strcmp(token, "file") == 0) {
+            snprintf(file, file_size, "%s", value);
+        } else if (strcmp(token, "pan") == 0) {
+            *pan = atoi(value) != 0;
+        } else {
+            ok = 0;
+        }
+        if (!ok) {
+            fprintf(stderr, "Invalid emulated framebuffer option %s=%s\n", token, value);
+            return -1;
+        }
+    }
+
+    unsigned min_line = vinfo->xres * (vinfo->bits_per_pixel / 8);
+    if (line_length == 0) {
+        line_length = min_line;
+    } else if (line_length < min_line) {
+        fprintf(stderr, "Emulated line length %u is shorter than a row (%u bytes)\n",
+                line_length, min_line);
+        return -1;
+    }
+
+    vinfo->xres_virtual = vinfo->xres;
+    vinfo->yres_virtual = vinfo->yres;
+    snprintf(finfo->id, sizeof(finfo->id), "aku-emu");
+    finfo->ypanstep = *pan;
+    finfo->type = FB_TYPE_PACKED_PIXELS;
+    finfo->visual = FB_VISUAL_TRUECOLOR;
+    finfo->line_length = line_length;
+    finfo->smem_len = line_length * vinfo->yres_virtual;
+    return 0;
+}
+
+static int open_emulated(fb_device *dev, const char *spec) {
+    char file[256];
+    if (parse_emu_spec(spec, &dev->vinfo, &dev->finfo, file, sizeof(file), &dev->emu_pan) == -1) {
+        return -1;
+    }
+
+    if (file[0]) {
+        dev->fd = open(file, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    } else {
+        dev->fd = memfd_create("aku_fb", MFD_CLOEXEC);
+    }
+    if (dev->fd == -1) {
+        perror("Error creating emulated framebuffer");
+        return -1;
+    }
+
+    // 文件已存在且大小足够时保留原内容
+    struct stat st;
+    if (fstat(dev->fd, &st) == -1 ||
+        ((size_t)st.st_size < dev->finfo.smem_len && ftruncate(dev->fd, dev->finfo.smem_len) == -1)) {
+        perror("Error sizing emulated framebuffer");
+        close(dev->fd);
+        dev->fd = -1;
+        return -1;
+    }
+    dev->emulated = 1;
+    return 0;
+}
+
+static int open_device(fb_device *dev, const char *path) {
+    dev->fd = open(path, O_RDWR | O_CLOEXEC);
+    if (dev->fd == -1) {
+        fprintf(stderr, "Error opening %s: ", path);
+        perror(NULL);
+        return -1;
+    }
+    if (ioctl(dev->fd, FBIOGET_VSCREENINFO, &dev->vinfo)) {
+        perror("Error reading variable information");
+        close(dev->fd);
+        dev->fd = -1;
+        return -1;
+    }
+    if (ioctl(dev->fd, FBIOGET_FSCREENINFO, &dev->finfo)) {
+        perror("Error reading fixed information");
+        close(dev->fd);
+        dev->fd = -1;
+        return -1;
+    }
+
+    // 上一个程序可能停在第二页后被结束，平移回第一页，保证绘制到可见区域
+    if (dev->vinfo.yoffset != 0) {
+        dev->vinfo.yoffset = 0;
+        ioctl(dev->fd, FBIOPAN_DISPLAY, &dev->vinfo);
+    }
+    dev->vsync = 1;
+    return 0;
+}
+
+// 映射全部虚拟分辨率（至少一屏），驱动报告的显存更小时以显存为准
+static int map_framebuffer(fb_device *dev) {
+    size_t screen_size = (size_t)dev->finfo.line_length * dev->vinfo.yres;
+    size_t map_size = (size_t)dev->finfo.line_length * dev->vinfo.yres_virtual;
+    if (dev->finfo.smem_len && map_size > dev->finfo.smem_len) {
+        map_size = dev->finfo.smem_len;
+    }
+    if (map_size < screen_size) {
+        map_size = screen_size;
+    }
+    dev->map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, dev->fd, 0);
+    if (dev->map == MAP_FAILED) {
+        perror("Error mapping framebuffer");
+        dev->map = NULL;
+        return -1;
+    }
+    dev->map_size = map_size;
+    return 0;
+}
+
+static void unmap_framebuffer(fb_device *dev) {
+    if (dev->map) {
+        munmap(dev->map, dev->map_size);
+    }
+    dev->map = NULL;
+    dev->map_size = 0;
+}
+
+// 逐级创建目录（已存在时忽略）
+static void make_dirs(const char *path) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", path);
+    for (char *p = buf + 1; *p; p++) {
+        if (*p == '/') {
+            *p = '\0';
+            mkdir(buf, 0755);
+            *p = '/';
+        }
+    }
+    mkdir(buf, 0755);
+}
+
+// 目录中已有的 frame_NNNNN.ppm 的最大编号加1，接着编号而不覆盖其他进程保存的画面
+static int next_dump_index(const char *dir) {
+    DIR *d = opendir(dir);
+    if (!d) {
+        return 0;
+    }
+    int next = 0;
+    struct dirent *ent;
+    while ((ent = readdir(d)) != NULL) {
+        int index, len = 0;
+        if (sscanf(ent->d_name, "frame_%d.ppm%n", &index, &len) == 1 &&
+            len == (int)strlen(ent->d_name) && index >= next) {
+            next = index + 1;
+        }
+    }
+    closedir(d);
+    return next;
+}
+
+int fb_device_open(fb_device *dev, const char *spec) {
+    memset(dev, 0, sizeof(*dev));
+    dev->fd = -1;
+
+    if (!spec) {
+        spec = getenv(FB_BACKEND_ENV);
+    }
+    if (!spec || !spec[0]) {
+        spec = FB_BACKEND_DEFAULT_DEVICE;
+    }
+
+    size_t prefix_len = strlen(FB_BACKEND_EMU_PREFIX);
+    int ret = strncmp(spec, FB_BACKEND_EMU_PREFIX, prefix_len) == 0
+                  ? open_emulated(dev, spec + prefix_len)
+                  : open_device(dev, spec);
+    if (ret == -1) {
+        return -1;
+    }
+
+    if (map_framebuffer(dev) == -1) {
+        close(dev->fd);
+        dev->fd = -1;
+        return -1;
+    }
+
+    const char *dump_dir = getenv(FB_BACKEND_DUMP_ENV);
+    if (dump_dir && dump_dir[0]) {
+        snprintf(dev->dump_dir, sizeof(dev->dump_dir), "%s", dump_dir);
+        make_dirs(dev->dump_dir);
+        dev->dump_index = next_dump_index(dev->dump_dir);
+    }
+    return 0;
+}
+
+void fb_device_close(fb_device *dev) {
+    unmap_framebuffer(dev);
+    if (dev->vinfo_changed) {
+        ioctl(dev->fd, FBIOPUT_VSCREENINFO, &dev->saved_vinfo);
+    }
+    if (dev->fd != -1) {
+        close(dev->fd);
+    }
+    memset(dev, 0, sizeof(*dev));
+    dev->fd = -1;
+}
+
+// 修改模拟设备的虚拟高度：调整存储大小
+static int resize_emulated(fb_device *dev, unsigned yres_virtual) {
+    size_t size = (size_t)dev->finfo.line_length * yres_virtual;
+    struct stat st;
+    if (fstat(dev->fd, &st) == -1 ||
+        ((size_t)st.st_size < size && ftruncate(dev->fd, size) == -1)) {
+        perror("Error resizing emulated framebuffer");
+        return -1;
+    }
+    dev->vinfo.yres_virtual = yres_virtual;
+    dev->finfo.smem_len = size;
+    return 0;
+}
+
+int fb_device_enable_flip(fb_device *dev) {
+    if (dev->flip_enabled) {
+        return 0;
+    }
+    // 不支持垂直平移的驱动（ypanstep 和 ywrapstep 都为0）直接放弃
+    if (dev->finfo.ypanstep == 0 && dev->finfo.ywrapstep == 0) {
+        return -1;
+    }
+
+    unsigned yres_virtual = dev->vinfo.yres * 2;
+    if (dev->vinfo.yres_virtual < yres_virtual) {
+        unmap_framebuffer(dev);
+        if (dev->emulated) {
+            if (resize_emulated(dev, yres_virtual) == -1) {
+                map_framebuffer(dev);
+                return -1;
+            }
+        } else {
+            struct fb_var_screeninfo saved = dev->vinfo;
+            struct fb_var_screeninfo request = dev->vinfo;
+            request.yres_virtual = yres_virtual;
+            request.yoffset = 0;
+            if (ioctl(dev->fd, FBIOPUT_VSCREENINFO, &request) == -1 ||
+                ioctl(dev->fd, FBIOGET_VSCREENINFO, &dev->vinfo) == -1 ||
+                ioctl(dev->fd, FBIOGET_FSCREENINFO, &dev->finfo) == -1 ||
+                dev->vinfo.yres_virtual < yres_virtual ||
+                dev->finfo.smem_len < dev->finfo.line_length * yres_virtual) {
+                // 恢复原模式
+                ioctl(dev->fd, FBIOPUT_VSCREENINFO, &saved);
+                ioctl(dev->fd, FBIOGET_VSCREENINFO, &dev->vinfo);
+                ioctl(dev->fd, FBIOGET_FSCREENINFO, &dev->finfo);
+                map_framebuffer(dev);
+                return -1;
+            }
+            if (!dev->vinfo_changed) {
+                dev->saved_vinfo = saved;
+                dev->vinfo_changed = 1;
+            }
+        }
+        if (map_framebuffer(dev) == -1) {
+            return -1;
+        }
+    }
+
+    dev->flip_enabled = 1;
+    if (fb_device_pan(dev, 0) == -1) {
+        dev->flip_enabled = 0;
+        return -1;
+    }
+    return 0;
+}
+
+unsigned char *fb_device_page(const fb_device *dev, int page) {
+    return dev->map + (size_t)page * dev->vinfo.yres * dev->finfo.line_length;
+}
+
+int fb_device_pan(fb_device *dev, int page) {
+    if (!dev->flip_enabled) {
+        return -1;
+    }
+    unsigned yoffset = page * dev->vinfo.yres;
+    if (dev->emulated) {
+        if (!dev->emu_pan) {
+            return -1;
+        }
+        dev->vinfo.yoffset = yoffset;
+        return 0;
+    }
+
+    struct fb_var_screeninfo request = dev->vinfo;
+    request.xoffset = 0;
+    request.yoffset = yoffset;
+    if (ioctl(dev->fd, FBIOPAN_DISPLAY, &request) == -1) {
+        return -1;
+    }
+    dev->vinfo.yoffset = yoffset;
+
+    // 等到新页开始扫描后再返回，调用者随后写入的旧页已不可见
+    if (dev->vsync) {
+        __u32 crtc = 0;
+        if (ioctl(dev->fd, FBIO_WAITFORVSYNC, &crtc) == -1) {
+            dev->vsync = 0;
+        }
+    }
+    return 0;
+}
+
+void fb_device_present(fb_device *dev) {
+    if (!dev->dump_dir[0]) {
+        return;
+    }
+    // 用 O_EXCL 占用文件名：同时运行的进程从同一编号开始时跳过对方已保存的画面
+    char path[300];
+    for (;;) {
+        snprintf(path, sizeof(path), "%s/frame_%05d.ppm", dev->dump_dir, dev->dump_index++);
+        int fd = open(path, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd != -1) {
+            close(fd);
+            break;
+        }
+        if (errno != EEXIST) {
+            perror("Error creating frame dump");
+            return;
+        }
+    }
+    fb_device_dump(dev, path);
+}
+
+// 按位域取出一个分量并扩展为8位
+static unsigned char extract_component(uint32_t pixel, const struct fb_bitfield *field) {
+    if (field->length == 0) {
+        return 0;
+    }
+    uint32_t max = field->length >= 32 ? 0xFFFFFFFF : (1U << field->length) - 1;
+    uint32_t value = (pixel >> field->offset) & max;
+    return (uint64_t)value * 255 / max;
+}
+
+int fb_device_dump(const fb_device *dev, const char *path) {
+    const struct fb_var_screeninfo *vinfo = &dev->vinfo;
+    int bytes_per_pixel = vinfo->bits_per_pixel / 8;
+    size_t first_row = vinfo->yoffset;
+    if ((first_row + vinfo->yres) * dev->finfo.line_length > dev->map_size) {
+        first_row = 0;
+    }
+
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        perror("Error creating frame dump");
+        return -1;
+    }
+    unsigned char *row = malloc((size_t)vinfo->xres * 3);
+    if (!row) {
+        fclose(fp);
+        return -1;
+    }
+
+    fprintf(fp, "P6\n%u %u\n255\n", vinfo->xres, vinfo->yres);
+    for (unsigned y = 0; y < vinfo->yres; y++) {
+        const unsigned char *src = dev->map + (first_row + y) * dev->finfo.line_length;
+        for (unsigned x = 0; x < vinfo->xres; x++) {
+            uint32_t pixel = 0;
+            for (int b = 0; b < bytes_per_pixel; b++) {
+                pixel |= (uint32_t)src[x * bytes_per_pixel + b] << (8 * b);
+            }
+            row[x * 3] = extract_component(pixel, &vinfo->red);
+            row[x * 3 + 1] = extract_component(pixel, &vinfo->green);
+            row[x * 3 + 2] = extract_component(pixel, &vinfo->blue);
+        }
+        fwrite(row, 1, (size_t)vinfo->xres * 3, fp);
+    }
+    free(row);
+
+    if (fclose(fp) != 0) {
+        perror("Error writing frame dump");
+        return -1;
+    }
+    return 0;
+}
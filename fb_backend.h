@@ -0,0 +1,61 @@
+#ifndef FB_BACKEND_H
+#define FB_BACKEND_H
+
+#include <stddef.h>
+#include <linux/fb.h>
+
+// 帧缓冲后端：真实设备（/dev/fbN）或用文件/memfd 模拟的设备
+// 由环境变量 AKU_FB 选择，未设置时打开 /dev/fb0：
+//   AKU_FB=/dev/fb1
+//   AKU_FB=emu:320x240                        模拟设备，默认 rgb565，memfd 存储
+//   AKU_FB=emu:320x240,format=xrgb8888,line=1296,file=/tmp/fb.raw
+//   AKU_FB=emu:240x135,bpp=16,red=0:5,green=5:6,blue=11:5
+//   AKU_FB=emu:320x240,format=argb8888       带 alpha 的面板（或 bpp=32,...,transp=24:8）
+//   AKU_FB=emu:240x135,pan=0                 模拟不支持平移的驱动（如 fbtft）
+// 文件存储的模拟设备保留内容，多个程序可以依次在同一块“屏幕”上绘制
+// 设置 AKU_FB_DUMP=<目录> 时，每次 fb_device_present 把可见画面保存为 frame_NNNNN.ppm，
+// 编号接着目录中已有的画面，多个程序依次或同时绘制时互不覆盖，用于与基准图像逐字节比较
+
+#define FB_BACKEND_ENV "AKU_FB"
+#define FB_BACKEND_DUMP_ENV "AKU_FB_DUMP"
+#define FB_BACKEND_DEFAULT_DEVICE "/dev/fb0"
+#define FB_BACKEND_EMU_PREFIX "emu:"
+
+typedef struct {
+    int fd;
+    int emulated;
+    struct fb_var_screeninfo vinfo;
+    struct fb_fix_screeninfo finfo;
+    unsigned char *map;      // 映射的显存（模拟设备为 line_length * yres_virtual 字节）
+    size_t map_size;
+    char dump_dir[256];      // 为空时不保存画面
+    int dump_index;
+
+    int emu_pan;             // 模拟设备是否支持平移
+    int flip_enabled;        // 已启用双页（yres_virtual >= 2 * yres）
+    int vsync;               // 驱动支持 FBIO_WAITFORVSYNC，首次失败后清零
+    int vinfo_changed;       // 修改过显示模式，关闭时恢复 saved_vinfo
+    struct fb_var_screeninfo saved_vinfo;
+} fb_device;
+
+// 打开帧缓冲；spec 为 NULL 时读取 AKU_FB。失败时打印原因并返回-1
+int fb_device_open(fb_device *dev, const char *spec);
+void fb_device_close(fb_device *dev);
+
+// 启用双页翻转：把 yres_virtual 设为 2 * yres 并重新映射显存
+// 驱动不支持平移或显存不足时恢复原模式并返回-1，调用者改用拷贝方式显示
+int fb_device_enable_flip(fb_device *dev);
+
+// 第 page 页（0或1）的起始地址
+unsigned char *fb_device_page(const fb_device *dev, int page);
+
+// 用 FBIOPAN_DISPLAY 显示第 page 页，驱动支持时等待垂直同步，成功返回0
+int fb_device_pan(fb_device *dev, int page);
+
+// 一帧画面绘制完成，设置了 AKU_FB_DUMP 时保存该画面
+void fb_device_present(fb_device *dev);
+
+// 把当前可见画面按位域解码保存为PPM（P6），成功返回0
+int fb_device_dump(const fb_device *dev, const char *path);
+
+#endif
@@ -0,0 +1,283 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "fb_present.h"
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// 进入拷贝模式：画布取 frame 的内容，影子缓冲取当前可见页的内容
+static int start_copy_mode(fb_presenter *presenter, const unsigned char *frame) {
+    presenter->canvas = malloc(presenter->frame_size);
+    presenter->shadow = malloc(presenter->frame_size);
+    if (!presenter->canvas || !presenter->shadow) {
+        perror("Error allocating canvas");
+        free(presenter->canvas);
+        free(presenter->shadow);
+        presenter->canvas = presenter->shadow = NULL;
+        return -1;
+    }
+    const unsigned char *visible = fb_device_page(presenter->device, presenter->visible_page);
+    if (frame) {
+        memcpy(presenter->canvas, frame, presenter->frame_size);
+    } else {
+        pixel_format_clear(presenter->format, presenter->canvas, presenter->line_length,
+                           presenter->width, presenter->height);
+    }
+    memcpy(presenter->shadow, visible, presenter->frame_size);
+    presenter->flipping = 0;
+    return 0;
+}
+
+int fb_presenter_init(fb_presenter *presenter, fb_device *device, const pixel_format *format,
+                      fb_present_mode mode) {
+    memset(presenter, 0, sizeof(*presenter));
+    presenter->device = device;
+    presenter->format = format;
+    presenter->width = device->vinfo.xres;
+    presenter->height = device->vinfo.yres;
+    presenter->line_length = device->finfo.line_length;
+    presenter->frame_size = (size_t)presenter->height * presenter->line_length;
+    presenter->page_size = sysconf(_SC_PAGESIZE);
+    if (presenter->page_size == 0 || presenter->page_size == (size_t)-1) {
+        presenter->page_size = 4096;
+    }
+
+    if (mode != FB_PRESENT_COPY) {
+        presenter->flipping = fb_device_enable_flip(device) == 0;
+        if (!presenter->flipping && mode == FB_PRESENT_FLIP) {
+            fprintf(stderr, "Framebuffer does not support page flipping\n");
+            return -1;
+        }
+    }
+
+    presenter->page_count = (device->map_size + presenter->page_size - 1) / presenter->page_size;
+    presenter->page_marks = calloc(presenter->page_count, 1);
+    if (!presenter->page_marks) {
+        perror("Error allocating page marks");
+        return -1;
+    }
+
+    if (presenter->flipping) {
+        pixel_format_clear(format, fb_device_page(device, 1), presenter->line_length,
+                           presenter->width, presenter->height);
+    } else if (start_copy_mode(presenter, NULL) == -1) {
+        return -1;
+    }
+    fb_presenter_damage_all(presenter);
+    return 0;
+}
+
+void fb_presenter_destroy(fb_presenter *presenter) {
+    if (presenter->flipping && presenter->visible_page != 0) {
+        memcpy(fb_device_page(presenter->device, 0),
+               fb_device_page(presenter->device, presenter->visible_page), presenter->frame_size);
+        fb_device_pan(presenter->device, 0);
+    }
+    free(presenter->canvas);
+    free(presenter->shadow);
+    free(presenter->page_marks);
+    presenter->canvas = presenter->shadow = presenter->page_marks = NULL;
+}
+
+static void damage_add(fb_damage *damage, const fb_rect *rect) {
+    if (damage->count < FB_PRESENT_MAX_RECTS) {
+        damage->rects[damage->count++] = *rect;
+        return;
+    }
+    // 矩形过多时全部合并为外接矩形
+    fb_rect *box = &damage->rects[0];
+    for (int i = 1; i < damage->count; i++) {
+        const fb_rect *r = &damage->rects[i];
+        int x1 = box->x + box->w > r->x + r->w ? box->x + box->w : r->x + r->w;
+        int y1 = box->y + box->h > r->y + r->h ? box->y + box->h : r->y + r->h;
+        box->x = box->x < r->x ? box->x : r->x;
+        box->y = box->y < r->y ? box->y : r->y;
+        box->w = x1 - box->x;
+        box->h = y1 - box->y;
+    }
+    damage->count = 1;
+    damage_add(damage, rect);
+}
+
+void fb_presenter_damage(fb_presenter *presenter, int x, int y, int w, int h) {
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > presenter->width) w = presenter->width - x;
+    if (y + h > presenter->height) h = presenter->height - y;
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    fb_rect rect = {x, y, w, h};
+    damage_add(&presenter->damage, &rect);
+}
+
+void fb_presenter_damage_all(fb_presenter *presenter) {
+    presenter->damage.count = 0;
+    fb_presenter_damage(presenter, 0, 0, presenter->width, presenter->height);
+}
+
+static int rect_contains(const fb_rect *outer, const fb_rect *inner) {
+    return inner->x >= outer->x && inner->y >= outer->y &&
+           inner->x + inner->w <= outer->x + outer->w &&
+           inner->y + inner->h <= outer->y + outer->h;
+}
+
+// 记录写入显存 [dst, dst + size) 涉及的页
+static void mark_pages(fb_presenter *presenter, const unsigned char *dst, size_t size) {
+    size_t offset = dst - presenter->device->map;
+    size_t first = offset / presenter->page_size;
+    size_t last = (offset + size - 1) / presenter->page_size;
+    for (size_t page = first; page <= last && page < presenter->page_count; page++) {
+        if (!presenter->page_marks[page]) {
+            presenter->page_marks[page] = 1;
+            presenter->pages_written++;
+        }
+    }
+}
+
+// 把 src 中的矩形区域拷贝到 dst（相同行布局），跳过被 cover 完整覆盖的矩形
+static size_t copy_rects(fb_presenter *presenter, unsigned char *dst, const unsigned char *src,
+                         const fb_damage *damage, const fb_rect *cover) {
+    int bytes_per_pixel = presenter->format->bytes_per_pixel;
+    size_t written = 0;
+    for (int i = 0; i < damage->count; i++) {
+        const fb_rect *r = &damage->rects[i];
+        if (cover && rect_contains(cover, r)) {
+            continue;
+        }
+        size_t row_bytes = (size_t)r->w * bytes_per_pixel;
+        for (int y = r->y; y < r->y + r->h; y++) {
+            size_t offset = (size_t)y * presenter->line_length + (size_t)r->x * bytes_per_pixel;
+            memcpy(dst + offset, src + offset, row_bytes);
+            mark_pages(presenter, dst + offset, row_bytes);
+        }
+        written += row_bytes * r->h;
+    }
+    return written;
+}
+
+// 拷贝模式：变化区域逐行按 FB_PRESENT_CHUNK 字节与影子缓冲比较，
+// 只把内容不同的连续块写入显存；未变化的行和块不写，也就不会弄脏对应的页
+static size_t copy_changed_spans(fb_presenter *presenter, unsigned char *dst) {
+    int bytes_per_pixel = presenter->format->bytes_per_pixel;
+    const fb_damage *damage = &presenter->damage;
+    size_t written = 0;
+    for (int i = 0; i < damage->count; i++) {
+        const fb_rect *r = &damage->rects[i];
+        size_t row_bytes = (size_t)r->w * bytes_per_pixel;
+        for (int y = r->y; y < r->y + r->h; y++) {
+            size_t offset = (size_t)y * presenter->line_length + (size_t)r->x * bytes_per_pixel;
+            const unsigned char *src = presenter->canvas + offset;
+            unsigned char *old = presenter->shadow + offset;
+            size_t pos = 0;
+            while (pos < row_bytes) {
+                size_t n = row_bytes - pos < FB_PRESENT_CHUNK ? row_bytes - pos : FB_PRESENT_CHUNK;
+                if (memcmp(src + pos, old + pos, n) == 0) {
+                    pos += n;
+                    continue;
+                }
+                // 向后合并连续的变化块
+                size_t end = pos + n;
+                while (end < row_bytes) {
+                    n = row_bytes - end < FB_PRESENT_CHUNK ? row_bytes - end : FB_PRESENT_CHUNK;
+                    if (memcmp(src + end, old + end, n) == 0) {
+                        break;
+                    }
+                    end += n;
+                }
+                memcpy(dst + offset + pos, src + pos, end - pos);
+                memcpy(old + pos, src + pos, end - pos);
+                mark_pages(presenter, dst + offset + pos, end - pos);
+                written += end - pos;
+                pos = end;
+            }
+        }
+    }
+    return written;
+}
+
+unsigned char *fb_presenter_begin(fb_presenter *presenter, const fb_rect *cover) {
+    if (!presenter->flipping) {
+        return presenter->canvas;
+    }
+
+    // 隐藏页停留在上上帧：从可见页补上上一帧变化的区域，本帧会整块覆盖的部分不用补
+    uint64_t start = now_ns();
+    unsigned char *hidden = fb_device_page(presenter->device, !presenter->visible_page);
+    presenter->bytes_written += copy_rects(presenter, hidden,
+                                           fb_device_page(presenter->device, presenter->visible_page),
+                                           &presenter->previous, cover);
+    presenter->previous.count = 0;
+    presenter->present_ns += now_ns() - start;
+    return hidden;
+}
+
+unsigned char *fb_presenter_clear(fb_presenter *presenter) {
+    unsigned char *target = fb_presenter_begin(presenter, NULL);
+    pixel_format_clear(presenter->format, target, presenter->line_length,
+                       presenter->width, presenter->height);
+    fb_presenter_damage_all(presenter);
+    return target;
+}
+
+void fb_presenter_present(fb_presenter *presenter) {
+    uint64_t start = now_ns();
+
+    if (presenter->flipping) {
+        int page = !presenter->visible_page;
+        if (fb_device_pan(presenter->device, page) == 0) {
+            presenter->visible_page = page;
+            presenter->previous = presenter->damage;
+        } else {
+            // 平移在运行中失败：把隐藏页中的完整画面作为画布，之后改用拷贝模式
+            fprintf(stderr, "Page flip failed, falling back to copy\n");
+            if (start_copy_mode(presenter, fb_device_page(presenter->device, page)) == 0) {
+                fb_presenter_damage_all(presenter);
+            }
+        }
+    }
+    if (!presenter->flipping) {
+        unsigned char *visible = fb_device_page(presenter->device, presenter->visible_page);
+        presenter->bytes_written += copy_changed_spans(presenter, visible);
+    }
+
+    presenter->damage.count = 0;
+    memset(presenter->page_marks, 0, presenter->page_count);
+    presenter->frames++;
+    presenter->present_ns += now_ns() - start;
+
+    fb_device_present(presenter->device);
+}
+
+int fb_present_mode_parse(const char *name) {
+    if (strcmp(name, "auto") == 0) return FB_PRESENT_AUTO;
+    if (strcmp(name, "flip") == 0) return FB_PRESENT_FLIP;
+    if (strcmp(name, "copy") == 0) return FB_PRESENT_COPY;
+    return -1;
+}
+
+const char *fb_presenter_mode_name(const fb_presenter *presenter) {
+    if (!presenter->flipping) {
+        return "copy";
+    }
+    return presenter->device->vsync ? "page flip + vsync" : "page flip";
+}
+
+void fb_presenter_report(const fb_presenter *presenter) {
+    if (presenter->frames == 0) {
+        return;
+    }
+    printf("Present (%s): %llu frames, %.1f us/frame, %llu bytes/frame, %.1f pages/frame\n",
+           fb_presenter_mode_name(presenter),
+           (unsigned long long)presenter->frames,
+           presenter->present_ns / 1000.0 / presenter->frames,
+           (unsigned long long)(presenter->bytes_written / presenter->frames),
+           (double)presenter->pages_written / presenter->frames);
+}
@@ -0,0 +1,88 @@
+#ifndef FB_PRESENT_H
+#define FB_PRESENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "fb_backend.h"
+#include "pixel_format.h"
+
+// 画面提交：每帧先用 fb_presenter_begin 取得绘制目标，绘制并标记变化区域，
+// 再由 fb_presenter_present 显示：
+//   翻页模式：直接绘制到隐藏页，FBIOPAN_DISPLAY 切换显示，提交时没有拷贝，也没有撕裂
+//   拷贝模式：驱动不支持平移时绘制到内存画布，提交时变化区域逐行与上次提交的画面比较，
+//             只写入内容确实不同的字节段。fbtft 这类 deferred I/O 驱动按页把写过的显存
+//             通过SPI刷新到屏幕，少写一页就少传一页
+
+#define FB_PRESENT_MAX_RECTS 32
+// 拷贝模式比较粒度（字节），一行内相邻的变化块合并为一段写入
+#define FB_PRESENT_CHUNK 32
+
+typedef enum {
+    FB_PRESENT_AUTO = 0,    // 支持平移时翻页，否则拷贝
+    FB_PRESENT_FLIP,        // 要求翻页，不支持时初始化失败
+    FB_PRESENT_COPY,
+} fb_present_mode;
+
+typedef struct {
+    int x, y, w, h;
+} fb_rect;
+
+// 一帧内的变化区域，超过 FB_PRESENT_MAX_RECTS 个时合并为外接矩形
+typedef struct {
+    fb_rect rects[FB_PRESENT_MAX_RECTS];
+    int count;
+} fb_damage;
+
+typedef struct {
+    fb_device *device;
+    const pixel_format *format;
+    int width;
+    int height;
+    int line_length;
+    unsigned char *canvas;      // 拷贝模式的内存画布，与显存行布局相同
+    unsigned char *shadow;      // 拷贝模式：上次提交到显存的画面
+    size_t frame_size;
+    size_t page_size;
+    unsigned char *page_marks;  // 本帧已写过的显存页
+    size_t page_count;
+
+    int flipping;               // 1：翻页模式
+    int visible_page;
+    fb_damage damage;           // 本帧变化
+    fb_damage previous;         // 上一帧变化：翻页时隐藏页还缺少这些区域
+
+    // 统计
+    uint64_t frames;
+    uint64_t bytes_written;
+    uint64_t pages_written;     // 每帧写过的不同显存页数之和
+    uint64_t present_ns;
+} fb_presenter;
+
+// 初始化，mode 为 FB_PRESENT_FLIP 且不支持翻页时返回-1
+int fb_presenter_init(fb_presenter *presenter, fb_device *device, const pixel_format *format,
+                      fb_present_mode mode);
+// 翻页模式下把最后一帧留在第0页，其它程序打开设备时能直接在可见区域绘制
+void fb_presenter_destroy(fb_presenter *presenter);
+
+// 开始一帧，返回绘制目标（行跨度为 line_length，内容为上一帧画面）
+// cover 为本帧将完整覆盖的区域（可为 NULL）：翻页时隐藏页中被它覆盖的旧区域不再同步
+unsigned char *fb_presenter_begin(fb_presenter *presenter, const fb_rect *cover);
+
+// 把本帧的绘制目标清为黑色并标记整屏变化，切换到另一段动画时使用：
+// 新画面和清屏在同一次提交中显示，中间没有黑屏
+unsigned char *fb_presenter_clear(fb_presenter *presenter);
+
+// 标记本帧的变化区域（自动裁剪到屏幕范围）
+void fb_presenter_damage(fb_presenter *presenter, int x, int y, int w, int h);
+void fb_presenter_damage_all(fb_presenter *presenter);
+
+// 提交本帧
+void fb_presenter_present(fb_presenter *presenter);
+
+// 解析 -m 参数（auto、flip、copy），无效时返回-1
+int fb_present_mode_parse(const char *name);
+const char *fb_presenter_mode_name(const fb_presenter *presenter);
+void fb_presenter_report(const fb_presenter *presenter);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef FNV_HASH_H
+#define FNV_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// FNV-1a 64位哈希：源数据哈希和各种缓存键共用
+// 分段计算时把上一段的结果作为下一段的 hash 传入，第一段从 FNV_HASH_INIT 开始
+
+#define FNV_HASH_INIT 0xcbf29ce484222325ULL
+
+static inline uint64_t fnv_hash(uint64_t hash, const void *data, size_t size) {
+    const unsigned char *p = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= p[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+#endif
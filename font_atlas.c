@@ -0,0 +1,159 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "font_atlas.h"
+
+static int glyph_key_cmp(const glyph *g, uint32_t codepoint, int size) {
+    if (g->codepoint != codepoint) {
+        return g->codepoint < codepoint ? -1 : 1;
+    }
+    return g->size < size ? -1 : (g->size > size ? 1 : 0);
+}
+
+static int kern_key_cmp(const font_atlas_kern *k, uint32_t left, uint32_t right, int size) {
+    if (k->left != left) {
+        return k->left < left ? -1 : 1;
+    }
+    if (k->right != right) {
+        return k->right < right ? -1 : 1;
+    }
+    return k->size < size ? -1 : (k->size > size ? 1 : 0);
+}
+
+int font_atlas_open(font_atlas *atlas, const char *path) {
+    memset(atlas, 0, sizeof(*atlas));
+    atlas->fd = -1;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        if (errno != ENOENT) {
+            perror("Error opening font atlas");
+        }
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        perror("Error reading font atlas size");
+        close(fd);
+        return -1;
+    }
+    if ((size_t)st.st_size < sizeof(font_atlas_header)) {
+        fprintf(stderr, "Font atlas too small: %s\n", path);
+        close(fd);
+        return -1;
+    }
+
+    unsigned char *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        perror("Error mapping font atlas");
+        close(fd);
+        return -1;
+    }
+
+    const font_atlas_header *header = (const font_atlas_header *)map;
+    size_t index_end = (size_t)header->index_offset + (size_t)header->glyph_count * sizeof(glyph);
+    size_t kern_end = (size_t)header->kern_offset + (size_t)header->kern_count * sizeof(font_atlas_kern);
+    int valid = memcmp(header->magic, FONT_ATLAS_MAGIC, 4) == 0 &&
+                header->version == FONT_ATLAS_VERSION &&
+                header->index_offset % 4 == 0 &&
+                index_end <= (size_t)st.st_size &&
+                header->kern_offset % 4 == 0 &&
+                kern_end <= (size_t)st.st_size;
+
+    // 校验每个字形的位图范围和索引顺序，绘制时就不必再检查
+    const glyph *glyphs = valid ? (const glyph *)(map + header->index_offset) : NULL;
+    for (uint32_t i = 0; valid && i < header->glyph_count; i++) {
+        const glyph *g = &glyphs[i];
+        valid = (g->flags & GLYPH_ATLAS) &&
+                (size_t)g->offset + (size_t)g->width * g->rows <= (size_t)st.st_size &&
+                (i == 0 || glyph_key_cmp(&glyphs[i - 1], g->codepoint, g->size) < 0);
+    }
+    const font_atlas_kern *kerns = valid ? (const font_atlas_kern *)(map + header->kern_offset) : NULL;
+    for (uint32_t i = 1; valid && i < header->kern_count; i++) {
+        valid = kern_key_cmp(&kerns[i - 1], kerns[i].left, kerns[i].right, kerns[i].size) < 0;
+    }
+    if (!valid) {
+        fprintf(stderr, "Invalid font atlas: %s\n", path);
+        munmap(map, st.st_size);
+        close(fd);
+        return -1;
+    }
+
+    atlas->fd = fd;
+    atlas->map = map;
+    atlas->map_size = st.st_size;
+    atlas->header = header;
+    atlas->glyphs = glyphs;
+    atlas->kerns = kerns;
+    return 0;
+}
+
+void font_atlas_close(font_atlas *atlas) {
+    if (atlas->map) {
+        munmap(atlas->map, atlas->map_size);
+    }
+    if (atlas->fd >= 0) {
+        close(atlas->fd);
+    }
+    memset(atlas, 0, sizeof(*atlas));
+    atlas->fd = -1;
+}
+
+const glyph *font_atlas_find(const font_atlas *atlas, uint32_t codepoint, int size) {
+    uint32_t lo = 0;
+    uint32_t hi = atlas->header->glyph_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        int cmp = glyph_key_cmp(&atlas->glyphs[mid], codepoint, size);
+        if (cmp == 0) {
+            return &atlas->glyphs[mid];
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+
+int font_atlas_kerning(const font_atlas *atlas, uint32_t left, uint32_t right, int size) {
+    uint32_t lo = 0;
+    uint32_t hi = atlas->header->kern_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        int cmp = kern_key_cmp(&atlas->kerns[mid], left, right, size);
+        if (cmp == 0) {
+            return atlas->kerns[mid].value;
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return 0;
+}
+
+int font_atlas_read_source_hash(const char *path, uint64_t *hash) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        return -1;
+    }
+    font_atlas_header header;
+    int ok = fread(&header, sizeof(header), 1, fp) == 1 &&
+             memcmp(header.magic, FONT_ATLAS_MAGIC, 4) == 0 &&
+             header.version == FONT_ATLAS_VERSION;
+    fclose(fp);
+    if (!ok) {
+        return -1;
+    }
+    *hash = header.source_hash;
+    return 0;
+}
@@ -0,0 +1,60 @@
+#ifndef FONT_ATLAS_H
+#define FONT_ATLAS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "glyph_cache.h"
+
+// 字形图集格式（.akf），由 pack_font 离线生成
+// 文件布局：文件头 | 字形位图... | 字形索引表 | 字距表
+// 索引表是按 (码位, 像素大小) 排序的 glyph 数组（带 GLYPH_ATLAS 标志，offset 相对文件开头），
+// 运行时 mmap 后二分查找，直接使用映射中的位图，不调用 FreeType
+// 字距表是字符集内非零的字距调整，按 (左码位, 右码位, 像素大小) 排序
+#define FONT_ATLAS_MAGIC   "AKUF"
+#define FONT_ATLAS_VERSION 2
+#define FONT_ATLAS_EXT     ".akf"
+
+// 文件头（40字节）
+typedef struct {
+    char magic[4];           // "AKUF"
+    uint16_t version;
+    uint16_t size_count;     // 包含的像素大小个数（仅供查看）
+    uint32_t glyph_count;
+    uint32_t index_offset;   // 索引表在文件中的偏移
+    uint32_t bitmap_offset;  // 第一个位图的偏移
+    uint32_t bitmap_size;    // 位图总字节数
+    uint64_t source_hash;    // 字体文件、字符集和大小的哈希，用于跳过未变化的重建
+    uint32_t kern_offset;    // 字距表在文件中的偏移
+    uint32_t kern_count;
+} font_atlas_header;
+
+// 字距表项（12字节）
+typedef struct {
+    uint32_t left;
+    uint32_t right;
+    uint16_t size;
+    int16_t value;           // 像素
+} font_atlas_kern;
+
+// 只读映射的图集
+typedef struct font_atlas {
+    int fd;
+    unsigned char *map;
+    size_t map_size;
+    const font_atlas_header *header;
+    const glyph *glyphs;
+    const font_atlas_kern *kerns;
+} font_atlas;
+
+// 打开并映射图集，成功返回0；文件不存在时静默返回-1，其它错误打印原因
+int font_atlas_open(font_atlas *atlas, const char *path);
+void font_atlas_close(font_atlas *atlas);
+// 二分查找字形，图集中没有时返回 NULL
+const glyph *font_atlas_find(const font_atlas *atlas, uint32_t codepoint, int size);
+// 两个字符之间的字距调整（像素），表中没有时为0
+int font_atlas_kerning(const font_atlas *atlas, uint32_t left, uint32_t right, int size);
+// 只读取文件头中的源数据哈希，文件不存在或无效时返回-1
+int font_atlas_read_source_hash(const char *path, uint64_t *hash);
+
+#endif
@@ -0,0 +1,227 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+
+#include "frame_cache.h"
+#include "fnv_hash.h"
+
+#define STATS_FILE "stats"
+
+// 缓存目录中的条目
+typedef struct {
+    char name[64];
+    off_t size;
+    struct timespec mtime;
+} cache_entry;
+
+void frame_cache_init(frame_cache *cache, int budget_mb) {
+    const char *dir = getenv(FRAME_CACHE_DIR_ENV);
+    snprintf(cache->dir, sizeof(cache->dir), "%s", dir && dir[0] ? dir : FRAME_CACHE_DEFAULT_DIR);
+
+    if (budget_mb < 0) {
+        const char *mb = getenv(FRAME_CACHE_MB_ENV);
+        budget_mb = mb ? atoi(mb) : FRAME_CACHE_DEFAULT_MB;
+    }
+    cache->budget = budget_mb > 0 ? (size_t)budget_mb * 1024 * 1024 : 0;
+    cache->hits = 0;
+    cache->misses = 0;
+
+    if (cache->budget && mkdir(cache->dir, 0755) == -1 && errno != EEXIST) {
+        perror("Error creating frame cache directory");
+        cache->budget = 0;
+    }
+}
+
+int frame_cache_enabled(const frame_cache *cache) {
+    return cache->budget > 0;
+}
+
+uint64_t frame_cache_key(const char *const *paths, int count) {
+    uint64_t hash = FNV_HASH_INIT;
+
+    for (int i = 0; i < count; i++) {
+        char resolved[PATH_MAX];
+        const char *name = realpath(paths[i], resolved) ? resolved : paths[i];
+        struct stat st;
+        if (stat(paths[i], &st) == -1) {
+            memset(&st, 0, sizeof(st));
+        }
+        long long meta[3] = { st.st_size, st.st_mtim.tv_sec, st.st_mtim.tv_nsec };
+
+        hash = fnv_hash(hash, name, strlen(name));
+        hash = fnv_hash(hash, meta, sizeof(meta));
+    }
+    return hash;
+}
+
+static void entry_path(const frame_cache *cache, uint64_t key, char *path, size_t size) {
+    snprintf(path, size, "%s/%016llx%s", cache->dir, (unsigned long long)key, ANIM_PACK_EXT);
+}
+
+// 累加命中统计，多个播放器进程可能同时更新，用 flock 串行化
+static void update_stats(frame_cache *cache, int hit) {
+    char path[300];
+    snprintf(path, sizeof(path), "%s/%s", cache->dir, STATS_FILE);
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd == -1) {
+        return;
+    }
+    flock(fd, LOCK_EX);
+
+    char buf[64] = {0};
+    ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+    unsigned long hits = 0, misses = 0;
+    if (n > 0) {
+        sscanf(buf, "%lu %lu", &hits, &misses);
+    }
+    if (hit) hits++; else misses++;
+
+    int len = snprintf(buf, sizeof(buf), "%lu %lu\n", hits, misses);
+    if (pwrite(fd, buf, len, 0) == len) {
+        ftruncate(fd, len);
+    }
+    flock(fd, LOCK_UN);
+    close(fd);
+
+    cache->hits = hits;
+    cache->misses = misses;
+}
+
+int frame_cache_lookup(frame_cache *cache, uint64_t key, char *path, size_t size) {
+    if (!frame_cache_enabled(cache)) {
+        return 0;
+    }
+
+    entry_path(cache, key, path, size);
+    int hit = access(path, R_OK) == 0;
+    if (hit) {
+        // mtime 记录最近使用时间，淘汰时使用
+        utimensat(AT_FDCWD, path, NULL, 0);
+    }
+    update_stats(cache, hit);
+    return hit;
+}
+
+int frame_cache_store_begin(frame_cache *cache, uint64_t key, int width, int height,
+                            anim_pack_writer *writer) {
+    if (!frame_cache_enabled(cache)) {
+        return -1;
+    }
+    char path[300];
+    entry_path(cache, key, path, sizeof(path));
+    return anim_pack_writer_open(writer, path, width, height, 0);
+}
+
+static int compare_entries(const void *a, const void *b) {
+    const cache_entry *ea = a, *eb = b;
+    if (ea->mtime.tv_sec != eb->mtime.tv_sec) {
+        return ea->mtime.tv_sec < eb->mtime.tv_sec ? -1 : 1;
+    }
+    if (ea->mtime.tv_nsec != eb->mtime.tv_nsec) {
+        return ea->mtime.tv_nsec < eb->mtime.tv_nsec ? -1 : 1;
+    }
+    return 0;
+}
+
+// 按最近使用时间从旧到新删除条目，直到总大小不超过预算，keep 指定的条目不删除
+// 其它进程正在写入的临时文件（<key>.akp.XXXXXX）也占用预算，超过宽限时间的视为残留删除
+static void evict(frame_cache *cache, const char *keep) {
+    DIR *dir = opendir(cache->dir);
+    if (!dir) {
+        return;
+    }
+
+    cache_entry *entries = NULL;
+    int count = 0, capacity = 0;
+    size_t total = 0;
+    struct dirent *ent;
+    time_t now = time(NULL);
+    while ((ent = readdir(dir)) != NULL) {
+        size_t len = strlen(ent->d_name);
+        size_t ext_len = strlen(ANIM_PACK_EXT);
+        int temp = strstr(ent->d_name, ANIM_PACK_EXT ".") != NULL;
+        if (!temp && (len <= ext_len || len >= sizeof(entries->name) ||
+                      strcmp(ent->d_name + len - ext_len, ANIM_PACK_EXT) != 0)) {
+            continue;
+        }
+
+        char path[600];
+        struct stat st;
+        snprintf(path, sizeof(path), "%s/%s", cache->dir, ent->d_name);
+        if (stat(path, &st) == -1) {
+            continue;
+        }
+        if (temp) {
+            // 写入中的临时文件计入总大小；长时间没有写入的是被杀掉的播放器留下的，直接删除
+            if (now - st.st_mtim.tv_sec > FRAME_CACHE_TEMP_GRACE && unlink(path) == 0) {
+                printf("Frame cache removed stale %s (%lld bytes)\n", ent->d_name,
+                       (long long)st.st_size);
+            } else {
+                total += st.st_size;
+            }
+            continue;
+        }
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 32;
+            cache_entry *new_entries = realloc(entries, capacity * sizeof(cache_entry));
+            if (!new_entries) {
+                break;
+            }
+            entries = new_entries;
+        }
+        memcpy(entries[count].name, ent->d_name, len + 1);
+        entries[count].size = st.st_size;
+        entries[count].mtime = st.st_mtim;
+        total += st.st_size;
+        count++;
+    }
+    closedir(dir);
+
+    qsort(entries, count, sizeof(cache_entry), compare_entries);
+    for (int i = 0; i < count && total > cache->budget; i++) {
+        if (strcmp(entries[i].name, keep) == 0) {
+            continue;
+        }
+        char path[600];
+        snprintf(path, sizeof(path), "%s/%s", cache->dir, entries[i].name);
+        if (unlink(path) == 0) {
+            printf("Frame cache evicted %s (%lld bytes)\n", entries[i].name, (long long)entries[i].size);
+            total -= entries[i].size;
+        }
+    }
+    free(entries);
+}
+
+int frame_cache_store_commit(frame_cache *cache, anim_pack_writer *writer, char *path, size_t size) {
+    snprintf(path, size, "%s", writer->path);
+    if (anim_pack_writer_close(writer) == -1) {
+        return -1;
+    }
+
+    struct stat st;
+    if (stat(path, &st) == -1 || (size_t)st.st_size > cache->budget) {
+        // 单个动画就超过预算，不缓存
+        unlink(path);
+        return -1;
+    }
+
+    const char *name = strrchr(path, '/');
+    evict(cache, name ? name + 1 : path);
+    return 0;
+}
+
+void frame_cache_report(const frame_cache *cache) {
+    if (frame_cache_enabled(cache)) {
+        printf("Frame cache: %lu hits, %lu misses (budget %zu bytes)\n",
+               cache->hits, cache->misses, cache->budget);
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef FRAME_CACHE_H
+#define FRAME_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "anim_pack.h"
+
+// 解码帧缓存：把解码后的RGB565帧以动画包形式保存在 tmpfs（内存）中
+// 缓存放在进程外，play_bmp_sequence 的多次运行和 sys_boot 重启后都能复用
+// 命中时直接 mmap 缓存包播放，无需任何解码
+// 总大小超过预算时按最近使用时间（文件 mtime）淘汰最久未用的动画
+// 命中/未命中次数累计保存在缓存目录的 stats 文件中
+
+#define FRAME_CACHE_DEFAULT_DIR "/dev/shm/aku_frame_cache"
+#define FRAME_CACHE_DEFAULT_MB  16
+#define FRAME_CACHE_DIR_ENV     "AKU_FRAME_CACHE_DIR"
+#define FRAME_CACHE_MB_ENV      "AKU_FRAME_CACHE_MB"
+#define FRAME_CACHE_TEMP_GRACE  60      // 临时文件超过这么多秒没有写入视为残留
+
+typedef struct {
+    char dir[256];
+    size_t budget;           // 字节预算，0 表示禁用缓存
+    unsigned long hits;      // 累计命中次数（所有进程）
+    unsigned long misses;    // 累计未命中次数（所有进程）
+} frame_cache;
+
+// 初始化缓存，budget_mb < 0 时从环境变量读取（默认 FRAME_CACHE_DEFAULT_MB）
+void frame_cache_init(frame_cache *cache, int budget_mb);
+int frame_cache_enabled(const frame_cache *cache);
+
+// 计算缓存键：源文件路径、大小和修改时间，任一变化即失效
+uint64_t frame_cache_key(const char *const *paths, int count);
+
+// 查找缓存，命中时把缓存包路径写入 path 并返回1，同时更新使用时间
+int frame_cache_lookup(frame_cache *cache, uint64_t key, char *path, size_t size);
+
+// 开始写入缓存条目，成功返回0
+int frame_cache_store_begin(frame_cache *cache, uint64_t key, int width, int height,
+                            anim_pack_writer *writer);
+// 完成写入并按预算淘汰旧条目，成功时把缓存包路径写入 path 并返回0
+int frame_cache_store_commit(frame_cache *cache, anim_pack_writer *writer, char *path, size_t size);
+
+// 打印命中统计
+void frame_cache_report(const frame_cache *cache);
+
+#endif
@@ -0,0 +1,107 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "frame_clock.h"
+
+static int64_t timespec_diff_ns(const struct timespec *a, const struct timespec *b) {
+    return (int64_t)(a->tv_sec - b->tv_sec) * 1000000000LL + (a->tv_nsec - b->tv_nsec);
+}
+
+static void timespec_add_ms(struct timespec *ts, int ms) {
+    ts->tv_sec += ms / 1000;
+    ts->tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+void frame_clock_init(frame_clock *clock, frame_clock_policy policy) {
+    memset(clock, 0, sizeof(*clock));
+    clock->policy = policy;
+}
+
+int frame_clock_drop(frame_clock *clock, int delay_ms) {
+    if (clock->policy != FRAME_CLOCK_DROP || !clock->started) {
+        return 0;
+    }
+    struct timespec now, slot_end = clock->deadline;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    timespec_add_ms(&slot_end, delay_ms);
+    if (timespec_diff_ns(&now, &slot_end) < 0) {
+        return 0;
+    }
+    clock->deadline = slot_end;
+    clock->dropped++;
+    return 1;
+}
+
+static int sleep_until(frame_clock *clock) {
+    if (clock->sleep) {
+        return clock->sleep(clock->sleep_arg, &clock->deadline);
+    }
+    return clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &clock->deadline, NULL) == EINTR ? -1 : 0;
+}
+
+int frame_clock_wait(frame_clock *clock, int delay_ms) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (!clock->started) {
+        clock->deadline = now;
+        clock->started = 1;
+    }
+
+    int64_t behind = timespec_diff_ns(&now, &clock->deadline);
+    if (behind > 0) {
+        // 已经错过显示时刻：立即显示；STRETCH 策略把时间轴移到当前时刻
+        clock->late++;
+        if ((uint64_t)behind > clock->late_ns_max) {
+            clock->late_ns_max = behind;
+        }
+        if (clock->policy == FRAME_CLOCK_STRETCH) {
+            clock->deadline = now;
+        }
+    } else if (behind < 0) {
+        if (sleep_until(clock) != 0) {
+            return -1;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int64_t jitter = timespec_diff_ns(&now, &clock->deadline);
+        if (jitter < 0) {
+            jitter = -jitter;
+        }
+        clock->slept++;
+        clock->jitter_ns_sum += jitter;
+        if ((uint64_t)jitter > clock->jitter_ns_max) {
+            clock->jitter_ns_max = jitter;
+        }
+    }
+
+    clock->frames++;
+    timespec_add_ms(&clock->deadline, delay_ms);
+    return 0;
+}
+
+void frame_clock_restart(frame_clock *clock) {
+    clock->started = 0;
+}
+
+int frame_clock_policy_parse(const char *name) {
+    if (strcmp(name, "stretch") == 0) return FRAME_CLOCK_STRETCH;
+    if (strcmp(name, "drop") == 0) return FRAME_CLOCK_DROP;
+    return -1;
+}
+
+void frame_clock_report(const frame_clock *clock) {
+    if (clock->frames == 0) {
+        return;
+    }
+    printf("Frame clock (%s): %llu shown, %llu late (max %.1f ms), %llu dropped, "
+           "jitter avg %.1f us max %.1f us\n",
+           clock->policy == FRAME_CLOCK_DROP ? "drop" : "stretch",
+           (unsigned long long)clock->frames, (unsigned long long)clock->late,
+           clock->late_ns_max / 1e6, (unsigned long long)clock->dropped,
+           clock->slept ? clock->jitter_ns_sum / 1e3 / clock->slept : 0.0,
+           clock->jitter_ns_max / 1e3);
+}
@@ -0,0 +1,56 @@
+#ifndef FRAME_CLOCK_H
+#define FRAME_CLOCK_H
+
+#include <stdint.h>
+#include <time.h>
+
+// 帧时钟：按绝对时间轴安排每帧的显示时刻
+// 第 i+1 帧的显示时刻 = 第 i 帧的显示时刻 + 第 i 帧的延迟，用 clock_nanosleep(TIMER_ABSTIME)
+// 等待，解码和绘制的耗时不会累加到帧间隔里，长时间播放也不漂移
+// 落后于时间轴时的策略：
+//   DROP：丢弃显示时段已经过去的帧，保持总时长不变
+//   STRETCH：每帧都显示，落后时把时间轴整体后移，播放变慢
+
+typedef enum {
+    FRAME_CLOCK_STRETCH = 0,
+    FRAME_CLOCK_DROP,
+} frame_clock_policy;
+
+// 等待到 deadline（CLOCK_MONOTONIC 绝对时刻），返回非0表示等待被打断
+typedef int (*frame_clock_sleep_fn)(void *arg, const struct timespec *deadline);
+
+typedef struct {
+    frame_clock_policy policy;
+    struct timespec deadline;    // 下一帧的显示时刻
+    int started;
+    frame_clock_sleep_fn sleep;  // 为 NULL 时用 clock_nanosleep，被信号打断时返回
+    void *sleep_arg;
+
+    // 统计
+    uint64_t frames;             // 显示的帧数
+    uint64_t late;               // 到达显示时刻时还没准备好的帧数
+    uint64_t dropped;
+    uint64_t late_ns_max;        // 最大落后时间
+    uint64_t slept;              // 睡眠等到显示时刻的帧数，唤醒误差按它平均
+    uint64_t jitter_ns_sum;      // 睡眠帧的唤醒误差（实际唤醒时刻 - 显示时刻）
+    uint64_t jitter_ns_max;
+} frame_clock;
+
+void frame_clock_init(frame_clock *clock, frame_clock_policy policy);
+
+// DROP 策略下，若本帧的显示时段（延迟 delay_ms）已经整个过去，推进时间轴并返回1，
+// 调用者跳过本帧的提交；其它情况返回0
+int frame_clock_drop(frame_clock *clock, int delay_ms);
+
+// 等到本帧的显示时刻，并把时间轴推进 delay_ms，返回0后立即提交本帧
+// 第一次调用以当前时刻为时间轴起点；等待被打断时返回-1，本帧不提交
+int frame_clock_wait(frame_clock *clock, int delay_ms);
+
+// 下一次 frame_clock_wait 以当前时刻为新的时间轴起点（切换动画时调用），统计保留
+void frame_clock_restart(frame_clock *clock);
+
+// 解析 -p 参数（drop、stretch），无效时返回-1
+int frame_clock_policy_parse(const char *name);
+void frame_clock_report(const frame_clock *clock);
+
+#endif
@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#include "frame_queue.h"
+
+int frame_queue_init(frame_queue *queue, unsigned int depth, size_t slot_pixels) {
+    unsigned int size = 1;
+    while (size < depth) {
+        size <<= 1;
+    }
+
+    memset(queue, 0, sizeof(*queue));
+    queue->slots = calloc(size, sizeof(frame_slot));
+    if (!queue->slots) {
+        perror("Error allocating frame queue");
+        return -1;
+    }
+    queue->size = size;
+
+    for (unsigned int i = 0; i < size; i++) {
+        queue->slots[i].pixels = malloc(slot_pixels * 2);
+        if (!queue->slots[i].pixels) {
+            perror("Error allocating frame slot");
+            frame_queue_destroy(queue);
+            return -1;
+        }
+        queue->slots[i].capacity = slot_pixels;
+    }
+
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    atomic_init(&queue->underruns, 0);
+    atomic_init(&queue->full_waits, 0);
+    atomic_init(&queue->events, 0);
+    atomic_init(&queue->waiters, 0);
+    return 0;
+}
+
+void frame_queue_destroy(frame_queue *queue) {
+    if (queue->slots) {
+        for (unsigned int i = 0; i < queue->size; i++) {
+            free(queue->slots[i].pixels);
+        }
+        free(queue->slots);
+    }
+    queue->slots = NULL;
+    queue->size = 0;
+}
+
+frame_slot *frame_queue_producer_slot(frame_queue *queue) {
+    unsigned int head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    if (head - tail == queue->size) {
+        return NULL;
+    }
+    return &queue->slots[head & (queue->size - 1)];
+}
+
+void frame_queue_publish(frame_queue *queue) {
+    unsigned int head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    frame_queue_wake(queue);
+}
+
+frame_slot *frame_queue_consumer_slot(frame_queue *queue) {
+    unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    if (head == tail) {
+        return NULL;
+    }
+    return &queue->slots[tail & (queue->size - 1)];
+}
+
+void frame_queue_release(frame_queue *queue) {
+    unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    frame_queue_wake(queue);
+}
+
+unsigned int frame_queue_depth(frame_queue *queue) {
+    unsigned int head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    return head - tail;
+}
+
+unsigned int frame_queue_events(frame_queue *queue) {
+    return atomic_load(&queue->events);
+}
+
+void frame_queue_wait(frame_queue *queue, unsigned int events) {
+    // 先登记等待者再进入内核：唤醒方先改计数再读 waiters，两边至少有一方看到对方
+    atomic_fetch_add(&queue->waiters, 1);
+    syscall(SYS_futex, &queue->events, FUTEX_WAIT_PRIVATE, events, NULL, NULL, 0);
+    atomic_fetch_sub(&queue->waiters, 1);
+}
+
+void frame_queue_wake(frame_queue *queue) {
+    atomic_fetch_add(&queue->events, 1);
+    if (atomic_load(&queue->waiters)) {
+        syscall(SYS_futex, &queue->events, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef FRAME_QUEUE_H
+#define FRAME_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+// 单生产者/单消费者无锁帧队列
+// 解码线程把帧转换到预分配的RGB565槽位中后发布，显示线程取出后只做拷贝
+// head 只由生产者写，tail 只由消费者写，通过 acquire/release 保证槽位内容可见
+// 队列满或空时在 futex 上阻塞等待，发布、归还和 frame_queue_wake 唤醒对方，不轮询
+
+typedef struct {
+    uint16_t *pixels;
+    size_t capacity;         // 像素缓冲容量（像素个数）
+    int width;
+    int height;
+    int frame;               // 帧序号，FRAME_QUEUE_END 表示解码结束
+} frame_slot;
+
+#define FRAME_QUEUE_END (-1)
+#define FRAME_QUEUE_DEFAULT_DEPTH 4
+
+typedef struct {
+    frame_slot *slots;
+    unsigned int size;                 // 槽位数，2的幂
+    _Atomic unsigned int head;         // 下一个要写入的位置
+    _Atomic unsigned int tail;         // 下一个要读取的位置
+    _Atomic unsigned long underruns;   // 显示时队列为空的次数（解码跟不上）
+    _Atomic unsigned long full_waits;  // 解码时队列已满的次数（解码领先）
+    _Atomic unsigned int events;       // futex：每次发布、归还或唤醒加1
+    _Atomic unsigned int waiters;      // 正在等待的线程数，为0时发布和归还不进入内核
+} frame_queue;
+
+// depth 向上取整为2的幂，每个槽位预分配 slot_pixels 个像素
+int frame_queue_init(frame_queue *queue, unsigned int depth, size_t slot_pixels);
+void frame_queue_destroy(frame_queue *queue);
+
+// 生产者：获取可写槽位，队列满时返回 NULL
+frame_slot *frame_queue_producer_slot(frame_queue *queue);
+// 生产者：发布已写好的槽位
+void frame_queue_publish(frame_queue *queue);
+// 消费者：获取下一帧，队列空时返回 NULL
+frame_slot *frame_queue_consumer_slot(frame_queue *queue);
+// 消费者：归还已显示的槽位
+void frame_queue_release(frame_queue *queue);
+// 当前排队的帧数
+unsigned int frame_queue_depth(frame_queue *queue);
+
+// 等待：先用 frame_queue_events 取得计数，再检查槽位和停止条件，都不满足时调用
+// frame_queue_wait，计数变化（有发布、归还或唤醒）后返回；被信号打断时也返回
+unsigned int frame_queue_events(frame_queue *queue);
+void frame_queue_wait(frame_queue *queue, unsigned int events);
+// 唤醒所有等待者（停止播放时使用）
+void frame_queue_wake(frame_queue *queue);
+
+#endif
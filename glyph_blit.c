@@ -0,0 +1,169 @@
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "glyph_blit.h"
+
+static inline int blend_channel(int d, int c, int a) {
+    return d + (((c - d) * a + 128) >> 8);
+}
+
+// 16位像素的三个分量都在固定位置（5/6/5），RGB565 和 BGR565 的混合完全相同
+static inline uint16_t blend_pixel16(uint16_t d, uint16_t c, int a) {
+    int hi = blend_channel(d >> 11, c >> 11, a);
+    int mid = blend_channel((d >> 5) & 0x3F, (c >> 5) & 0x3F, a);
+    int lo = blend_channel(d & 0x1F, c & 0x1F, a);
+    return (hi << 11) | (mid << 5) | lo;
+}
+
+void glyph_blend_span16_scalar(uint16_t *dst, const unsigned char *coverage, int count, uint16_t color) {
+    for (int i = 0; i < count; i++) {
+        int a = coverage[i];
+        if (a == 255) {
+            dst[i] = color;
+        } else if (a) {
+            dst[i] = blend_pixel16(dst[i], color, a);
+        }
+    }
+}
+
+#if defined(__SSE2__)
+
+// 8个像素的一个分量：d + ((c - d) * a + 128) >> 8，差值在 ±63 以内，乘积不会溢出16位
+static inline __m128i blend_channel_epi16(__m128i d, __m128i c, __m128i a) {
+    __m128i diff = _mm_mullo_epi16(_mm_sub_epi16(c, d), a);
+    return _mm_add_epi16(d, _mm_srai_epi16(_mm_add_epi16(diff, _mm_set1_epi16(128)), 8));
+}
+
+void glyph_blend_span16(uint16_t *dst, const unsigned char *coverage, int count, uint16_t color) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mask5 = _mm_set1_epi16(0x1F);
+    const __m128i mask6 = _mm_set1_epi16(0x3F);
+    const __m128i c = _mm_set1_epi16(color);
+    const __m128i c_hi = _mm_srli_epi16(c, 11);
+    const __m128i c_mid = _mm_and_si128(_mm_srli_epi16(c, 5), mask6);
+    const __m128i c_lo = _mm_and_si128(c, mask5);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint64_t cov;
+        memcpy(&cov, coverage + i, 8);
+        if (cov == 0) {
+            continue;
+        }
+        __m128i *p = (__m128i *)(dst + i);
+        if (cov == UINT64_MAX) {
+            _mm_storeu_si128(p, c);
+            continue;
+        }
+        __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(coverage + i)), zero);
+        __m128i d = _mm_loadu_si128(p);
+        __m128i hi = blend_channel_epi16(_mm_srli_epi16(d, 11), c_hi, a);
+        __m128i mid = blend_channel_epi16(_mm_and_si128(_mm_srli_epi16(d, 5), mask6), c_mid, a);
+        __m128i lo = blend_channel_epi16(_mm_and_si128(d, mask5), c_lo, a);
+        __m128i out = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(hi, 11), _mm_slli_epi16(mid, 5)), lo);
+        _mm_storeu_si128(p, out);
+    }
+    glyph_blend_span16_scalar(dst + i, coverage + i, count - i, color);
+}
+
+const char *glyph_blit_kernel_name(void) {
+    return "sse2";
+}
+
+#elif defined(__ARM_NEON)
+
+// vrshrq_n_s16(x, 8) 即 (x + 128) >> 8，中间结果不会溢出
+static inline int16x8_t blend_channel_s16(int16x8_t d, int16x8_t c, int16x8_t a) {
+    return vaddq_s16(d, vrshrq_n_s16(vmulq_s16(vsubq_s16(c, d), a), 8));
+}
+
+void glyph_blend_span16(uint16_t *dst, const unsigned char *coverage, int count, uint16_t color) {
+    const uint16x8_t c = vdupq_n_u16(color);
+    const int16x8_t c_hi = vreinterpretq_s16_u16(vshrq_n_u16(c, 11));
+    const int16x8_t c_mid = vreinterpretq_s16_u16(vandq_u16(vshrq_n_u16(c, 5), vdupq_n_u16(0x3F)));
+    const int16x8_t c_lo = vreinterpretq_s16_u16(vandq_u16(c, vdupq_n_u16(0x1F)));
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint64_t cov;
+        memcpy(&cov, coverage + i, 8);
+        if (cov == 0) {
+            continue;
+        }
+        if (cov == UINT64_MAX) {
+            vst1q_u16(dst + i, c);
+            continue;
+        }
+        int16x8_t a = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(coverage + i)));
+        uint16x8_t d = vld1q_u16(dst + i);
+        int16x8_t hi = blend_channel_s16(vreinterpretq_s16_u16(vshrq_n_u16(d, 11)), c_hi, a);
+        int16x8_t mid = blend_channel_s16(
+            vreinterpretq_s16_u16(vandq_u16(vshrq_n_u16(d, 5), vdupq_n_u16(0x3F))), c_mid, a);
+        int16x8_t lo = blend_channel_s16(
+            vreinterpretq_s16_u16(vandq_u16(d, vdupq_n_u16(0x1F))), c_lo, a);
+        uint16x8_t out = vorrq_u16(vorrq_u16(vshlq_n_u16(vreinterpretq_u16_s16(hi), 11),
+                                             vshlq_n_u16(vreinterpretq_u16_s16(mid), 5)),
+                                   vreinterpretq_u16_s16(lo));
+        vst1q_u16(dst + i, out);
+    }
+    glyph_blend_span16_scalar(dst + i, coverage + i, count - i, color);
+}
+
+const char *glyph_blit_kernel_name(void) {
+    return "neon";
+}
+
+#else
+
+void glyph_blend_span16(uint16_t *dst, const unsigned char *coverage, int count, uint16_t color) {
+    glyph_blend_span16_scalar(dst, coverage, count, color);
+}
+
+const char *glyph_blit_kernel_name(void) {
+    return "scalar";
+}
+
+#endif
+
+// 24/32位格式：每个字节是一个8位分量（32位的填充或 alpha 字节随颜色一起混合；
+// 背景和颜色都不透明，混合结果仍然不透明）
+static void blend_span_bytes(unsigned char *dst, const unsigned char *coverage, int count,
+                             uint32_t pixel, int bytes) {
+    unsigned char c[4] = {pixel, pixel >> 8, pixel >> 16, pixel >> 24};
+    for (int i = 0; i < count; i++, dst += bytes) {
+        int a = coverage[i];
+        if (!a) {
+            continue;
+        }
+        for (int k = 0; k < bytes; k++) {
+            dst[k] = blend_channel(dst[k], c[k], a);
+        }
+    }
+}
+
+void glyph_blit(const glyph_target *target, int x, int y, const unsigned char *coverage,
+                int width, int rows, int pitch, uint32_t pixel) {
+    // 一次裁剪，之后每行都是完整的可见区间
+    int x0 = x < 0 ? -x : 0;
+    int y0 = y < 0 ? -y : 0;
+    int x1 = x + width > target->width ? target->width - x : width;
+    int y1 = y + rows > target->height ? target->height - y : rows;
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    int bytes = target->format->bytes_per_pixel;
+    int count = x1 - x0;
+    for (int i = y0; i < y1; i++) {
+        unsigned char *dst = target->base + (long)(y + i) * target->line_length + (long)(x + x0) * bytes;
+        const unsigned char *src = coverage + (long)i * pitch + x0;
+        if (bytes == 2) {
+            glyph_blend_span16((uint16_t *)dst, src, count, pixel);
+        } else {
+            blend_span_bytes(dst, src, count, pixel, bytes);
+        }
+    }
+}
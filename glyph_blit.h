@@ -0,0 +1,34 @@
+#ifndef GLYPH_BLIT_H
+#define GLYPH_BLIT_H
+
+#include <stdint.h>
+
+#include "pixel_format.h"
+
+// 字形混合：每个字形只裁剪一次，然后按行把8位覆盖度当作 alpha，与帧缓冲中的像素混合（抗锯齿）
+// 16位格式（RGB565/BGR565）按行使用 SSE2/NEON 内核，每次8个像素；其它格式逐字节混合
+// 每个分量：d + ((c - d) * a + 128) >> 8，a=255 时正好等于 c，a=0 时保持 d；
+// SIMD 内核与标量参考实现的结果逐位一致
+
+// 绘制目标（帧缓冲或内存画布）
+typedef struct {
+    unsigned char *base;
+    int line_length;         // 每行字节数
+    int width;
+    int height;
+    const pixel_format *format;
+} glyph_target;
+
+// 把 width x rows 的覆盖度位图（行距 pitch）画到 (x, y)（位图左上角），超出目标的部分裁掉
+// pixel 为已按目标格式打包的颜色
+void glyph_blit(const glyph_target *target, int x, int y, const unsigned char *coverage,
+                int width, int rows, int pitch, uint32_t pixel);
+
+// 一段16位像素按覆盖度与 color 混合，根据编译目标选择 SSE2/NEON/标量实现
+void glyph_blend_span16(uint16_t *dst, const unsigned char *coverage, int count, uint16_t color);
+// 标量参考实现
+void glyph_blend_span16_scalar(uint16_t *dst, const unsigned char *coverage, int count, uint16_t color);
+// 当前使用的混合实现名称
+const char *glyph_blit_kernel_name(void);
+
+#endif
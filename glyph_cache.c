@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "glyph_cache.h"
+#include "font_atlas.h"
+
+#define GLYPH_CACHE_INITIAL_SLOTS 64
+#define GLYPH_CACHE_INITIAL_ARENA 16384
+
+static uint32_t glyph_hash(uint32_t codepoint, int size) {
+    return (codepoint * 2654435761u) ^ ((uint32_t)size * 40503u);
+}
+
+static glyph *find_slot(glyph *slots, uint32_t capacity, uint32_t codepoint, int size) {
+    uint32_t i = glyph_hash(codepoint, size) & (capacity - 1);
+    while (slots[i].size != 0 &&
+           (slots[i].codepoint != codepoint || slots[i].size != size)) {
+        i = (i + 1) & (capacity - 1);
+    }
+    return &slots[i];
+}
+
+static int grow_table(glyph_cache *cache) {
+    uint32_t capacity = cache->capacity ? cache->capacity * 2 : GLYPH_CACHE_INITIAL_SLOTS;
+    glyph *slots = calloc(capacity, sizeof(*slots));
+    if (!slots) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < cache->capacity; i++) {
+        const glyph *g = &cache->slots[i];
+        if (g->size != 0) {
+            *find_slot(slots, capacity, g->codepoint, g->size) = *g;
+        }
+    }
+    free(cache->slots);
+    cache->slots = slots;
+    cache->capacity = capacity;
+    return 0;
+}
+
+static int reserve_arena(glyph_cache *cache, size_t bytes) {
+    if (cache->arena_used + bytes <= cache->arena_size) {
+        return 0;
+    }
+    size_t size = cache->arena_size ? cache->arena_size : GLYPH_CACHE_INITIAL_ARENA;
+    while (size < cache->arena_used + bytes) {
+        size *= 2;
+    }
+    unsigned char *arena = realloc(cache->arena, size);
+    if (!arena) {
+        return -1;
+    }
+    cache->arena = arena;
+    cache->arena_size = size;
+    return 0;
+}
+
+int glyph_cache_init(glyph_cache *cache, FT_Face face) {
+    memset(cache, 0, sizeof(*cache));
+    cache->face = face;
+    return grow_table(cache);
+}
+
+void glyph_cache_set_face_loader(glyph_cache *cache, glyph_face_fn fn, void *arg) {
+    cache->load_face = fn;
+    cache->load_arg = arg;
+}
+
+void glyph_cache_set_atlas(glyph_cache *cache, const struct font_atlas *atlas) {
+    cache->atlas = atlas;
+    cache->atlas_map = atlas ? atlas->map : NULL;
+}
+
+void glyph_cache_destroy(glyph_cache *cache) {
+    free(cache->slots);
+    free(cache->arena);
+    memset(cache, 0, sizeof(*cache));
+}
+
+// 需要 FreeType 时才加载字体，并设置像素大小；没有可用的字体时返回 NULL
+static FT_Face face_at_size(glyph_cache *cache, int size) {
+    if (!cache->face && cache->load_face) {
+        cache->face = cache->load_face(cache->load_arg);
+        cache->load_face = NULL;
+    }
+    FT_Face face = cache->face;
+    if (face && cache->face_size != size) {
+        if (FT_Set_Pixel_Sizes(face, 0, size)) {
+            fprintf(stderr, "Could not set font size %d\n", size);
+            return NULL;
+        }
+        cache->face_size = size;
+    }
+    return face;
+}
+
+// 光栅化一个字形，复制到 arena
+static int rasterize(glyph_cache *cache, glyph *g) {
+    FT_Face face = face_at_size(cache, g->size);
+    if (!face) {
+        g->flags = GLYPH_MISSING;
+        return 0;
+    }
+    if (FT_Load_Char(face, g->codepoint, FT_LOAD_RENDER)) {
+        fprintf(stderr, "Error loading character: 0x%x\n", g->codepoint);
+        g->flags = GLYPH_MISSING;
+        return 0;
+    }
+
+    FT_GlyphSlot slot = face->glyph;
+    g->left = slot->bitmap_left;
+    g->top = slot->bitmap_top;
+    g->advance = slot->advance.x >> 6;
+    g->width = slot->bitmap.width;
+    g->rows = slot->bitmap.rows;
+
+    size_t bytes = (size_t)g->width * g->rows;
+    if (reserve_arena(cache, bytes) == -1) {
+        return -1;
+    }
+    g->offset = cache->arena_used;
+    unsigned char *dst = cache->arena + cache->arena_used;
+    for (int i = 0; i < g->rows; i++) {
+        memcpy(dst + (size_t)i * g->width, slot->bitmap.buffer + (long)i * slot->bitmap.pitch, g->width);
+    }
+    cache->arena_used += bytes;
+    return 0;
+}
+
+const glyph *glyph_cache_get(glyph_cache *cache, uint32_t codepoint, int size) {
+    if (cache->atlas) {
+        const glyph *baked = font_atlas_find(cache->atlas, codepoint, size);
+        if (baked) {
+            cache->atlas_hits++;
+            return baked;
+        }
+    }
+
+    glyph *g = find_slot(cache->slots, cache->capacity, codepoint, size);
+    if (g->size != 0) {
+        cache->hits++;
+        return g;
+    }
+
+    // 装载率超过 3/4 时扩容，重新定位空槽
+    if ((cache->count + 1) * 4 > cache->capacity * 3) {
+        if (grow_table(cache) == -1) {
+            return NULL;
+        }
+        g = find_slot(cache->slots, cache->capacity, codepoint, size);
+    }
+    glyph entry = {.codepoint = codepoint, .size = size};
+    if (rasterize(cache, &entry) == -1) {
+        return NULL;
+    }
+    *g = entry;
+    cache->count++;
+    cache->misses++;
+    return g;
+}
+
+int glyph_cache_kerning(glyph_cache *cache, uint32_t left, uint32_t right, int size) {
+    if (cache->atlas && font_atlas_find(cache->atlas, left, size) &&
+        font_atlas_find(cache->atlas, right, size)) {
+        return font_atlas_kerning(cache->atlas, left, right, size);
+    }
+    // 有字形不在图集中时字体本来就要加载来光栅化它
+    FT_Face face = face_at_size(cache, size);
+    if (!face || !FT_HAS_KERNING(face)) {
+        return 0;
+    }
+    FT_Vector delta;
+    if (FT_Get_Kerning(face, FT_Get_Char_Index(face, left), FT_Get_Char_Index(face, right),
+                       FT_KERNING_DEFAULT, &delta)) {
+        return 0;
+    }
+    return delta.x >> 6;
+}
@@ -0,0 +1,76 @@
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+// 字形缓存：按 (码位, 像素大小) 缓存 FreeType 光栅化结果，每个字形只光栅化一次
+// 位图（8位覆盖度，行距等于宽度）连续存放在一块 arena 中，条目只记录偏移、尺寸、bearing 和 advance
+// 测量文字宽度只用缓存中的 advance，不再为测量单独光栅化
+// 可以挂一个预先光栅化的字形图集（font_atlas.h），图集中有的字形直接使用映射的位图，
+// 只有图集中没有的字形才用 FreeType 光栅化；FreeType 的字体可以在第一次需要时才加载
+// 字距调整同样优先取图集的字距表，两个字形都在图集中时不需要加载字体
+
+#define GLYPH_MISSING 0x1    // 字体中加载失败，按空白字形处理
+#define GLYPH_ATLAS   0x2    // 位图在图集文件中（offset 相对文件开头）
+
+// 字形（24字节），同时也是图集文件中的索引项
+typedef struct {
+    uint32_t codepoint;
+    uint16_t size;           // 像素大小，0 表示空槽
+    uint16_t flags;          // GLYPH_MISSING / GLYPH_ATLAS
+    int16_t left;            // bitmap_left
+    int16_t top;             // bitmap_top
+    int16_t advance;         // 水平前进（像素）
+    uint16_t width;
+    uint16_t rows;
+    uint16_t reserved;
+    uint32_t offset;         // 位图在 arena（或图集文件）中的偏移
+} glyph;
+
+struct font_atlas;
+
+// 第一次需要 FreeType 光栅化时调用，返回加载好的字体，失败返回 NULL
+typedef FT_Face (*glyph_face_fn)(void *arg);
+
+typedef struct {
+    FT_Face face;            // 可为 NULL，由 load_face 延迟加载
+    glyph_face_fn load_face;
+    void *load_arg;
+    int face_size;           // face 当前设置的像素大小
+    const struct font_atlas *atlas;
+    const unsigned char *atlas_map;
+    glyph *slots;            // 开放寻址哈希表
+    uint32_t capacity;       // 2 的幂
+    uint32_t count;
+    unsigned char *arena;
+    size_t arena_size;
+    size_t arena_used;
+    // 统计
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t atlas_hits;
+} glyph_cache;
+
+// 成功返回0；face（可为 NULL）由调用者管理，需在缓存销毁之后释放
+int glyph_cache_init(glyph_cache *cache, FT_Face face);
+void glyph_cache_destroy(glyph_cache *cache);
+// face 为 NULL 时，第一次需要光栅化才调用 fn 加载字体
+void glyph_cache_set_face_loader(glyph_cache *cache, glyph_face_fn fn, void *arg);
+// 优先从图集中取字形（图集需在缓存销毁之后关闭），atlas 为 NULL 时取消
+void glyph_cache_set_atlas(glyph_cache *cache, const struct font_atlas *atlas);
+
+// 查找字形，未缓存时光栅化并加入缓存；内存不足时返回 NULL
+// 返回的指针在下一次 glyph_cache_get 之前有效（表和 arena 可能扩容）
+const glyph *glyph_cache_get(glyph_cache *cache, uint32_t codepoint, int size);
+
+// left 后面紧跟 right 时的字距调整（像素，通常为负），字体没有字距表时为0
+int glyph_cache_kerning(glyph_cache *cache, uint32_t left, uint32_t right, int size);
+
+static inline const unsigned char *glyph_bitmap(const glyph_cache *cache, const glyph *g) {
+    return (g->flags & GLYPH_ATLAS ? cache->atlas_map : cache->arena) + g->offset;
+}
+
+#endif
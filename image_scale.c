@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "image_scale.h"
+
+// 定点数增量生成源索引：index = floor(i / scale)，小数部分32位
+// 步长向上取整，i / scale 恰好为整数时（如 scale 为 0.75）不会落到前一个像素
+// 超出范围的末尾索引截断到 limit - 1
+static void build_index(uint32_t *table, int count, float scale, int limit) {
+    uint64_t step = (uint64_t)ceil((double)(1ULL << 32) / scale);
+    uint64_t acc = 0;
+    for (int i = 0; i < count; i++) {
+        uint32_t index = acc >> 32;
+        table[i] = index < (uint32_t)limit ? index : (uint32_t)limit - 1;
+        acc += step;
+    }
+}
+
+int image_scaler_init(image_scaler *scaler, int src_width, int src_height,
+                      int rotation, float scale) {
+    memset(scaler, 0, sizeof(*scaler));
+    if (src_width <= 0 || src_height <= 0 || scale <= 0 ||
+        (uint64_t)src_width * src_height * 3 > UINT32_MAX) {
+        return -1;
+    }
+
+    int transposed = rotation == 90 || rotation == 270;
+    int target_width = transposed ? src_height : src_width;
+    int target_height = transposed ? src_width : src_height;
+
+    scaler->src_width = src_width;
+    scaler->src_height = src_height;
+    scaler->rotation = rotation;
+    scaler->dst_width = (int)(target_width * scale);
+    scaler->dst_height = (int)(target_height * scale);
+    if (scaler->dst_width <= 0 || scaler->dst_height <= 0) {
+        return -1;
+    }
+
+    scaler->row_offset = malloc(scaler->dst_height * sizeof(uint32_t));
+    scaler->col_offset = malloc(scaler->dst_width * sizeof(uint32_t));
+    if (!scaler->row_offset || !scaler->col_offset) {
+        perror("Error allocating scaler tables");
+        image_scaler_destroy(scaler);
+        return -1;
+    }
+
+    build_index(scaler->row_offset, scaler->dst_height, scale, target_height);
+    build_index(scaler->col_offset, scaler->dst_width, scale, target_width);
+
+    // 旋转后的坐标 (tx, ty) 对应源像素：
+    //   0:   (tx, ty)          180: (W-1-tx, H-1-ty)
+    //   90:  (W-1-ty, tx)      270: (ty, H-1-tx)
+    // 行、列偏移分量相加即为源像素的字节偏移
+    uint32_t stride = (uint32_t)src_width * 3;
+    for (int y = 0; y < scaler->dst_height; y++) {
+        uint32_t ty = scaler->row_offset[y];
+        switch (rotation) {
+            case 90:  scaler->row_offset[y] = (src_width - 1 - ty) * 3; break;
+            case 180: scaler->row_offset[y] = (src_height - 1 - ty) * stride; break;
+            case 270: scaler->row_offset[y] = ty * 3; break;
+            default:  scaler->row_offset[y] = ty * stride; break;
+        }
+    }
+    for (int x = 0; x < scaler->dst_width; x++) {
+        uint32_t tx = scaler->col_offset[x];
+        switch (rotation) {
+            case 90:  scaler->col_offset[x] = tx * stride; break;
+            case 180: scaler->col_offset[x] = (src_width - 1 - tx) * 3; break;
+            case 270: scaler->col_offset[x] = (src_height - 1 - tx) * stride; break;
+            default:  scaler->col_offset[x] = tx * 3; break;
+        }
+    }
+    return 0;
+}
+
+void image_scaler_destroy(image_scaler *scaler) {
+    free(scaler->row_offset);
+    free(scaler->col_offset);
+    memset(scaler, 0, sizeof(*scaler));
+}
+
+static inline void copy_pixel(unsigned char *dst, const unsigned char *src) {
+    dst[0] = src[0];
+    dst[1] = src[1];
+    dst[2] = src[2];
+}
+
+// 0/180度：每个输出行来自同一源行，按行顺序取样
+static void scale_rows(const image_scaler *scaler, const unsigned char *src,
+                       int y0, int rows, unsigned char *dst) {
+    const uint32_t *col_offset = scaler->col_offset;
+    int width = scaler->dst_width;
+    for (int y = 0; y < rows; y++) {
+        const unsigned char *src_row = src + scaler->row_offset[y0 + y];
+        unsigned char *out = dst + (size_t)y * width * 3;
+        for (int x = 0; x < width; x++) {
+            copy_pixel(out + x * 3, src_row + col_offset[x]);
+        }
+    }
+}
+
+// 90/270度：每个输出列来自同一源行，逐像素按行输出会跨行读取源图像
+// 按 TILE x TILE 分块，块内涉及的源行片段在处理整块期间都留在缓存中
+static void scale_rows_transposed(const image_scaler *scaler, const unsigned char *src,
+                                  int y0, int rows, unsigned char *dst) {
+    const uint32_t *row_offset = scaler->row_offset + y0;
+    const uint32_t *col_offset = scaler->col_offset;
+    int width = scaler->dst_width;
+    for (int by = 0; by < rows; by += IMAGE_SCALE_TILE) {
+        int y1 = by + IMAGE_SCALE_TILE < rows ? by + IMAGE_SCALE_TILE : rows;
+        for (int x0 = 0; x0 < width; x0 += IMAGE_SCALE_TILE) {
+            int x1 = x0 + IMAGE_SCALE_TILE < width ? x0 + IMAGE_SCALE_TILE : width;
+            for (int x = x0; x < x1; x++) {
+                const unsigned char *src_row = src + col_offset[x];
+                unsigned char *out = dst + x * 3;
+                for (int y = by; y < y1; y++) {
+                    copy_pixel(out + (size_t)y * width * 3, src_row + row_offset[y]);
+                }
+            }
+        }
+    }
+}
+
+void image_scaler_rows(const image_scaler *scaler, const unsigned char *src,
+                       int y0, int rows, unsigned char *dst) {
+    if (scaler->rotation == 90 || scaler->rotation == 270) {
+        scale_rows_transposed(scaler, src, y0, rows, dst);
+    } else {
+        scale_rows(scaler, src, y0, rows, dst);
+    }
+}
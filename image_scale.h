@@ -0,0 +1,33 @@
+#ifndef IMAGE_SCALE_H
+#define IMAGE_SCALE_H
+
+#include <stdint.h>
+
+// 图像缩放与旋转（最近邻）
+// 初始化时用定点数增量计算每个输出行、列对应的源偏移表，逐像素循环中只有查表和拷贝，
+// 没有除法和旋转分支。0/180度按行取样；90/270度沿源图像列方向读取，按块转置以保持缓存命中
+
+// 每次处理的输出行数（行带），也是90/270度转置块的边长
+#define IMAGE_SCALE_TILE 16
+
+typedef struct {
+    int src_width;
+    int src_height;
+    int rotation;             // 0、90、180、270
+    int dst_width;            // 旋转并缩放后的输出尺寸
+    int dst_height;
+    uint32_t *row_offset;     // 每个输出行在源图像中的字节偏移分量
+    uint32_t *col_offset;     // 每个输出列在源图像中的字节偏移分量
+} image_scaler;
+
+// 按缩放比例 scale 建立源偏移表，输出尺寸为旋转后尺寸乘以 scale（取整）
+// 源图像为自上而下的RGB888（stbi_load(..., 3) 的输出布局），失败返回-1
+int image_scaler_init(image_scaler *scaler, int src_width, int src_height,
+                      int rotation, float scale);
+void image_scaler_destroy(image_scaler *scaler);
+
+// 生成输出的第 y0 行起共 rows 行，写入 dst（RGB888，每行 dst_width * 3 字节）
+void image_scaler_rows(const image_scaler *scaler, const unsigned char *src,
+                       int y0, int rows, unsigned char *dst);
+
+#endif
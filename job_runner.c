@@ -0,0 +1,261 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#include "job_runner.h"
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+extern char **environ;
+
+static int pidfd_open(pid_t pid) {
+    return syscall(SYS_pidfd_open, pid, 0);
+}
+
+static job *find_job(job_runner *runner, pid_t pid) {
+    for (int i = 0; i < JOB_RUNNER_MAX_JOBS; i++) {
+        if (runner->jobs[i].pid == pid) {
+            return &runner->jobs[i];
+        }
+    }
+    return NULL;
+}
+
+// 回收后清理任务表项，再调用回调（回调中可以启动新任务）
+static void finish_job(job *j, int status) {
+    job_runner *runner = j->runner;
+    event_loop_timer_cancel(runner->loop, j->timer);
+    if (j->pidfd >= 0) {
+        event_loop_remove_fd(runner->loop, j->pidfd);
+        close(j->pidfd);
+    }
+    job finished = *j;
+    j->pid = 0;
+    j->pidfd = -1;
+    runner->reaped++;
+
+    if (finished.timed_out) {
+        printf("任务超时被终止: %s (PID %d)\n", finished.name, finished.pid);
+    }
+    if (finished.done) {
+        finished.done(finished.arg, finished.pid, status, finished.timed_out);
+    }
+}
+
+// 只回收任务表中的进程，不影响 popen/system 自己等待的子进程
+static void reap_job(job *j) {
+    int status;
+    pid_t ret = waitpid(j->pid, &status, WNOHANG);
+    if (ret == j->pid) {
+        finish_job(j, status);
+    } else if (ret == -1 && errno == ECHILD) {
+        finish_job(j, 0);
+    }
+}
+
+static void on_pidfd(void *arg, int fd, uint32_t events) {
+    (void)fd;
+    (void)events;
+    reap_job(arg);
+}
+
+static void on_sigchld(void *arg, int fd, uint32_t events) {
+    job_runner *runner = arg;
+    struct signalfd_siginfo info;
+    (void)events;
+    // 多个 SIGCHLD 可能合并成一次，读空后检查所有任务
+    while (read(fd, &info, sizeof(info)) == sizeof(info)) {
+    }
+    for (int i = 0; i < JOB_RUNNER_MAX_JOBS; i++) {
+        if (runner->jobs[i].pid > 0) {
+            reap_job(&runner->jobs[i]);
+        }
+    }
+}
+
+// 超时：先 SIGTERM，宽限期后 SIGKILL
+static void on_job_timer(void *arg) {
+    job *j = arg;
+    if (j->pid <= 0) {
+        return;
+    }
+    if (!j->killing) {
+        j->killing = 1;
+        j->timed_out = 1;
+        kill(-j->pid, SIGTERM);
+        event_loop_timer_start(j->runner->loop, j->timer, JOB_RUNNER_KILL_GRACE_MS);
+    } else {
+        kill(-j->pid, SIGKILL);
+    }
+}
+
+int job_runner_init(job_runner *runner, event_loop *loop) {
+    memset(runner, 0, sizeof(*runner));
+    runner->loop = loop;
+    runner->sigchld_fd = -1;
+    for (int i = 0; i < JOB_RUNNER_MAX_JOBS; i++) {
+        job *j = &runner->jobs[i];
+        j->runner = runner;
+        j->pidfd = -1;
+        j->timer = event_loop_add_timer(loop, on_job_timer, j);
+        if (j->timer == -1) {
+            return -1;
+        }
+    }
+
+    // 内核不支持 pidfd（5.3 之前）时改用 SIGCHLD 的 signalfd
+    int probe = pidfd_open(getpid());
+    if (probe >= 0) {
+        close(probe);
+        return 0;
+    }
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &mask, NULL);
+    runner->sigchld_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (runner->sigchld_fd == -1) {
+        perror("Error creating SIGCHLD signalfd");
+        return -1;
+    }
+    if (event_loop_add_fd(loop, runner->sigchld_fd, EPOLLIN, on_sigchld, runner) == -1) {
+        close(runner->sigchld_fd);
+        runner->sigchld_fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+void job_runner_destroy(job_runner *runner) {
+    for (int i = 0; i < JOB_RUNNER_MAX_JOBS; i++) {
+        job *j = &runner->jobs[i];
+        event_loop_timer_cancel(runner->loop, j->timer);
+        if (j->pidfd >= 0) {
+            event_loop_remove_fd(runner->loop, j->pidfd);
+            close(j->pidfd);
+            j->pidfd = -1;
+        }
+        j->pid = 0;
+    }
+    if (runner->sigchld_fd >= 0) {
+        event_loop_remove_fd(runner->loop, runner->sigchld_fd);
+        close(runner->sigchld_fd);
+        runner->sigchld_fd = -1;
+    }
+}
+
+pid_t job_runner_spawn(job_runner *runner, char *const argv[], int flags, int timeout_ms,
+                       job_done_fn done, void *arg) {
+    job *j = find_job(runner, 0);
+    if (!j) {
+        fprintf(stderr, "Too many running jobs, not starting %s\n", argv[0]);
+        return -1;
+    }
+
+    // 子进程：恢复默认信号屏蔽和处理方式，独立进程组（超时时整组终止）
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t mask;
+    sigemptyset(&mask);
+    posix_spawnattr_setsigmask(&attr, &mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGCHLD);
+    sigaddset(&mask, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attr, &mask);
+    posix_spawnattr_setpgroup(&attr, 0);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF |
+                                    POSIX_SPAWN_SETPGROUP);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if (flags & JOB_QUIET) {
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+        posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+    }
+
+    pid_t pid;
+    int err = posix_spawnp(&pid, argv[0], &actions, &attr, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+    if (err != 0) {
+        fprintf(stderr, "Error starting %s: %s\n", argv[0], strerror(err));
+        return -1;
+    }
+
+    j->pid = pid;
+    j->killing = 0;
+    j->timed_out = 0;
+    j->done = done;
+    j->arg = arg;
+    snprintf(j->name, sizeof(j->name), "%s", argv[0]);
+    runner->spawned++;
+
+    if (runner->sigchld_fd < 0) {
+        // 子进程在 pidfd_open 之前就退出也没关系：未回收的进程仍能打开，且立即可读
+        j->pidfd = pidfd_open(pid);
+        if (j->pidfd == -1 ||
+            event_loop_add_fd(runner->loop, j->pidfd, EPOLLIN, on_pidfd, j) == -1) {
+            perror("Error watching job");
+            if (j->pidfd >= 0) {
+                close(j->pidfd);
+                j->pidfd = -1;
+            }
+            // 无法异步回收：退化为同步等待
+            int status;
+            waitpid(pid, &status, 0);
+            finish_job(j, status);
+            return pid;
+        }
+    }
+    if (timeout_ms > 0) {
+        event_loop_timer_start(runner->loop, j->timer, timeout_ms);
+    }
+    return pid;
+}
+
+pid_t job_runner_shell(job_runner *runner, const char *command, int flags, int timeout_ms,
+                       job_done_fn done, void *arg) {
+    char *argv[] = {"/bin/sh", "-c", (char *)command, NULL};
+    pid_t pid = job_runner_spawn(runner, argv, flags, timeout_ms, done, arg);
+    if (pid > 0) {
+        job *j = find_job(runner, pid);
+        if (j) {
+            snprintf(j->name, sizeof(j->name), "%s", command);
+        }
+    }
+    return pid;
+}
+
+int job_runner_kill(job_runner *runner, pid_t pid) {
+    job *j = pid > 0 ? find_job(runner, pid) : NULL;
+    if (!j) {
+        return -1;
+    }
+    if (!j->killing) {
+        j->killing = 1;
+        kill(-j->pid, SIGTERM);
+        event_loop_timer_start(runner->loop, j->timer, JOB_RUNNER_KILL_GRACE_MS);
+    }
+    return 0;
+}
+
+int job_runner_count(const job_runner *runner) {
+    int count = 0;
+    for (int i = 0; i < JOB_RUNNER_MAX_JOBS; i++) {
+        if (runner->jobs[i].pid > 0) {
+            count++;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,62 @@
+#ifndef JOB_RUNNER_H
+#define JOB_RUNNER_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "event_loop.h"
+
+// 异步任务：用 posix_spawn 启动子进程（vfork 语义，不复制页表），登记到任务表后立即返回
+// 子进程结束由事件循环回收：内核支持时每个任务一个 pidfd，否则用 SIGCHLD 的 signalfd
+// 可选超时：到时向整个进程组发送 SIGTERM，JOB_RUNNER_KILL_GRACE_MS 后仍未退出则 SIGKILL
+
+#define JOB_RUNNER_MAX_JOBS       8
+#define JOB_RUNNER_KILL_GRACE_MS  1000
+
+// 子进程的标准输出和错误输出重定向到 /dev/null
+#define JOB_QUIET 0x1
+
+// 任务结束回调，status 为 waitpid 的状态，超时被终止时 timed_out 为1
+typedef void (*job_done_fn)(void *arg, pid_t pid, int status, int timed_out);
+
+typedef struct job_runner job_runner;
+
+typedef struct {
+    job_runner *runner;
+    pid_t pid;               // 0 表示空闲
+    int pidfd;               // -1 表示用 SIGCHLD 回收
+    int timer;               // 事件循环定时器编号
+    int killing;             // 已发送 SIGTERM，等待退出
+    int timed_out;
+    job_done_fn done;
+    void *arg;
+    char name[64];
+} job;
+
+struct job_runner {
+    event_loop *loop;
+    job jobs[JOB_RUNNER_MAX_JOBS];
+    int sigchld_fd;          // 不支持 pidfd 时的 SIGCHLD signalfd，-1 表示未使用
+    uint64_t spawned;
+    uint64_t reaped;
+};
+
+// 需要在创建其它线程之前调用（回退到 signalfd 时要屏蔽 SIGCHLD），成功返回0
+int job_runner_init(job_runner *runner, event_loop *loop);
+// 不再跟踪剩余任务（不终止它们），释放 pidfd 和定时器
+void job_runner_destroy(job_runner *runner);
+
+// 启动 argv[0]（按 PATH 查找），timeout_ms 为0表示不限时
+// 返回子进程 pid，失败返回-1；done 可为 NULL
+pid_t job_runner_spawn(job_runner *runner, char *const argv[], int flags, int timeout_ms,
+                       job_done_fn done, void *arg);
+// 用 /bin/sh -c 执行 command
+pid_t job_runner_shell(job_runner *runner, const char *command, int flags, int timeout_ms,
+                       job_done_fn done, void *arg);
+
+// 终止任务（整个进程组），结束时照常回调；pid 不在任务表中时返回-1
+int job_runner_kill(job_runner *runner, pid_t pid);
+// 正在运行的任务数
+int job_runner_count(const job_runner *runner);
+
+#endif
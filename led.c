@@ -0,0 +1,163 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "led.h"
+
+#define LED_FULL 1000
+#define LED_REST 0xffff     // 步骤亮度取常态亮度
+#define LED_DEFAULT_REST 1  // 默认常态亮度（设备原始值），与原来点亮时写入的 "1" 一致
+
+static const led_step blink_steps[] = {
+    {0, 100},
+};
+
+static const led_step double_blink_steps[] = {
+    {0, 80}, {LED_REST, 80}, {0, 80},
+};
+
+static const led_step breathe_steps[] = {
+    {0, 150}, {100, 80}, {250, 80}, {450, 80}, {700, 80}, {1000, 300},
+    {700, 80}, {450, 80}, {250, 80}, {100, 80},
+};
+
+static const led_step heartbeat_steps[] = {
+    {LED_FULL, 100}, {0, 100}, {LED_FULL, 100}, {0, 700},
+};
+
+static const struct {
+    const led_step *steps;
+    int count;
+} patterns[LED_PATTERN_COUNT] = {
+    [LED_PATTERN_BLINK] = {blink_steps, sizeof(blink_steps) / sizeof(blink_steps[0])},
+    [LED_PATTERN_DOUBLE_BLINK] = {double_blink_steps, sizeof(double_blink_steps) / sizeof(double_blink_steps[0])},
+    [LED_PATTERN_BREATHE] = {breathe_steps, sizeof(breathe_steps) / sizeof(breathe_steps[0])},
+    [LED_PATTERN_HEARTBEAT] = {heartbeat_steps, sizeof(heartbeat_steps) / sizeof(heartbeat_steps[0])},
+};
+
+// 千分比换算为设备亮度（四舍五入，非0的亮度至少为1）
+static int scale_level(const led *l, int level) {
+    int value = (level * l->max_brightness + LED_FULL / 2) / LED_FULL;
+    if (value == 0 && level > 0) {
+        value = 1;
+    }
+    return value;
+}
+
+// 步骤的设备亮度：LED_REST 直接用常态亮度，不换算
+static int step_value(const led *l, int step) {
+    int level = l->steps[step].level;
+    return level == LED_REST ? l->rest : scale_level(l, level);
+}
+
+static void write_level(led *l, int value) {
+    if (value == l->level) {
+        return;
+    }
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%d", value);
+    if (sysfs_write(&l->brightness, buf) == 0) {
+        l->level = value;
+        l->writes++;
+    } else {
+        l->level = -1;
+    }
+}
+
+// 写入当前步骤，并把之后亮度相同的步骤合并到同一次定时
+static void run_step(led *l) {
+    int value = step_value(l, l->step);
+    int ms = 0;
+    write_level(l, value);
+    while (l->steps) {
+        ms += l->steps[l->step].ms;
+        l->step++;
+        if (l->step == l->step_count) {
+            if (l->repeat == 1) {
+                // 最后一遍：结束时恢复常态亮度
+                l->steps = NULL;
+                break;
+            }
+            if (l->repeat > 1) {
+                l->repeat--;
+            }
+            l->step = 0;
+        }
+        if (step_value(l, l->step) != value || ms >= 10000) {
+            break;
+        }
+    }
+    event_loop_timer_start(l->loop, l->timer, ms);
+}
+
+static void on_led_timer(void *arg) {
+    led *l = arg;
+    if (l->steps) {
+        run_step(l);
+    } else {
+        write_level(l, l->rest);
+    }
+}
+
+int led_open(led *l, const char *rel, event_loop *loop) {
+    memset(l, 0, sizeof(*l));
+    l->loop = loop;
+    l->level = -1;
+    l->rest = LED_DEFAULT_REST;
+    l->max_brightness = 1;
+    l->timer = event_loop_add_timer(loop, on_led_timer, l);
+    if (l->timer == -1) {
+        return -1;
+    }
+
+    char path[192];
+    snprintf(path, sizeof(path), "%s/max_brightness", rel);
+    sysfs_attr max;
+    char buf[16];
+    if (sysfs_attr_open(&max, path, O_RDONLY) == 0 && sysfs_read(&max, buf, sizeof(buf)) > 0 &&
+        atoi(buf) > 0) {
+        l->max_brightness = atoi(buf);
+    }
+    sysfs_attr_close(&max);
+
+    snprintf(path, sizeof(path), "%s/trigger", rel);
+    sysfs_attr_open(&l->trigger, path, O_WRONLY);
+    snprintf(path, sizeof(path), "%s/brightness", rel);
+    sysfs_attr_open(&l->brightness, path, O_WRONLY);
+    return 0;
+}
+
+void led_close(led *l) {
+    event_loop_timer_cancel(l->loop, l->timer);
+    l->steps = NULL;
+    sysfs_attr_close(&l->trigger);
+    sysfs_attr_close(&l->brightness);
+}
+
+void led_play(led *l, led_pattern pattern, int repeat) {
+    if (pattern < 0 || pattern >= LED_PATTERN_COUNT) {
+        return;
+    }
+    // 先设置为 none 触发模式，内核的触发器（如 heartbeat）不再改写亮度
+    sysfs_write(&l->trigger, "none");
+    l->level = -1;
+    l->steps = patterns[pattern].steps;
+    l->step_count = patterns[pattern].count;
+    l->step = 0;
+    l->repeat = repeat > 0 ? repeat : 0;
+    run_step(l);
+}
+
+void led_stop(led *l) {
+    event_loop_timer_cancel(l->loop, l->timer);
+    l->steps = NULL;
+    write_level(l, l->rest);
+}
+
+void led_set(led *l, int level) {
+    if (level < 0) level = 0;
+    if (level > LED_FULL) level = LED_FULL;
+    l->rest = scale_level(l, level);
+    led_stop(l);
+}
@@ -0,0 +1,53 @@
+#ifndef LED_H
+#define LED_H
+
+#include <stdint.h>
+
+#include "event_loop.h"
+#include "sysfs.h"
+
+// LED 灯效：每种灯效是一张 {亮度, 时长} 步骤表，由事件循环的一个定时器逐步推进，不阻塞
+// trigger 和 brightness 属性启动时打开一次（见 sysfs.h），亮度不变的相邻步骤合并为一次定时，
+// 只在亮度变化时写入；只有亮/灭两档的 LED（max_brightness 为1）呼吸灯退化为慢闪
+
+typedef enum {
+    LED_PATTERN_BLINK,          // 熄灭 100ms 后恢复
+    LED_PATTERN_DOUBLE_BLINK,   // 快速闪两次
+    LED_PATTERN_BREATHE,        // 渐亮渐暗
+    LED_PATTERN_HEARTBEAT,      // 心跳：两次短亮后长暗
+    LED_PATTERN_COUNT
+} led_pattern;
+
+typedef struct {
+    uint16_t level;          // 亮度，千分比
+    uint16_t ms;
+} led_step;
+
+typedef struct {
+    sysfs_attr trigger;
+    sysfs_attr brightness;
+    int max_brightness;
+    event_loop *loop;
+    int timer;
+    const led_step *steps;   // NULL 表示没有播放灯效
+    int step_count;
+    int step;
+    int repeat;              // 剩余播放次数，0 表示一直循环
+    int level;               // 已写入的亮度，-1 表示未知
+    int rest;                // 灯效结束后的亮度（设备原始值），默认为1
+    uint64_t writes;
+} led;
+
+// 打开 LED（rel 相对 sysfs 根目录，如 "class/leds/aku-logo"），注册定时器
+// 属性打不开时仍返回0（访问时重试），定时器不够时返回-1
+int led_open(led *l, const char *rel, event_loop *loop);
+void led_close(led *l);
+
+// 播放灯效 repeat 次（0 表示一直循环，直到 led_stop 或新的灯效），取代正在播放的灯效
+void led_play(led *l, led_pattern pattern, int repeat);
+// 停止灯效，恢复常态亮度
+void led_stop(led *l);
+// 设置常态亮度（千分比）并停止灯效
+void led_set(led *l, int level);
+
+#endif
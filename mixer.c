@@ -0,0 +1,333 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+
+#include "mixer.h"
+
+// ---- ALSA 后端 ----
+
+// 按 amixer 简单控制名的习惯查找：先找 "<名称> Playback Volume"，再找 "<名称> Volume"，最后是 "<名称>"
+static int find_element(mixer *m, const char *control) {
+    struct snd_ctl_elem_list list;
+    memset(&list, 0, sizeof(list));
+    if (ioctl(m->fd, SNDRV_CTL_IOCTL_ELEM_LIST, &list) == -1) {
+        perror("Error listing mixer controls");
+        return -1;
+    }
+    list.space = list.count;
+    list.pids = calloc(list.count ? list.count : 1, sizeof(*list.pids));
+    if (!list.pids) {
+        perror("Error allocating mixer control list");
+        return -1;
+    }
+    if (ioctl(m->fd, SNDRV_CTL_IOCTL_ELEM_LIST, &list) == -1) {
+        perror("Error listing mixer controls");
+        free(list.pids);
+        return -1;
+    }
+
+    static const char *const suffixes[] = {" Playback Volume", " Volume", ""};
+    int found = 0;
+    for (size_t s = 0; s < sizeof(suffixes) / sizeof(suffixes[0]) && !found; s++) {
+        char name[sizeof(list.pids[0].name) + 32];
+        snprintf(name, sizeof(name), "%s%s", control, suffixes[s]);
+        for (unsigned i = 0; i < list.used; i++) {
+            if (list.pids[i].iface == SNDRV_CTL_ELEM_IFACE_MIXER &&
+                strcmp((const char *)list.pids[i].name, name) == 0) {
+                m->id = list.pids[i];
+                found = 1;
+                break;
+            }
+        }
+    }
+    free(list.pids);
+    if (!found) {
+        fprintf(stderr, "Mixer control \"%s\" not found\n", control);
+        return -1;
+    }
+
+    struct snd_ctl_elem_info info;
+    memset(&info, 0, sizeof(info));
+    info.id = m->id;
+    if (ioctl(m->fd, SNDRV_CTL_IOCTL_ELEM_INFO, &info) == -1) {
+        perror("Error reading mixer control info");
+        return -1;
+    }
+    if (info.type != SNDRV_CTL_ELEM_TYPE_INTEGER) {
+        fprintf(stderr, "Mixer control \"%s\" is not an integer control\n", control);
+        return -1;
+    }
+    m->id = info.id;
+    m->min = info.value.integer.min;
+    m->max = info.value.integer.max;
+    m->channels = info.count;
+    return 0;
+}
+
+static int alsa_open(mixer *m, const char *spec) {
+    int card = 0;
+    const char *control = spec + 3;
+    char *end;
+    card = strtol(control, &end, 10);
+    if (end == control || (*end != ',' && *end != '\0')) {
+        fprintf(stderr, "Invalid mixer spec \"%s\"\n", spec);
+        return -1;
+    }
+    snprintf(m->control, sizeof(m->control), "%s", *end == ',' ? end + 1 : "Power Amplifier");
+
+    char path[64];
+    snprintf(path, sizeof(path), "/dev/snd/controlC%d", card);
+    m->fd = open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (m->fd == -1) {
+        fprintf(stderr, "Error opening %s: ", path);
+        perror(NULL);
+        return -1;
+    }
+    if (find_element(m, m->control) == -1) {
+        close(m->fd);
+        m->fd = -1;
+        return -1;
+    }
+
+    // 订阅控制事件，其它程序修改音量时更新缓存
+    int subscribe = 1;
+    if (ioctl(m->fd, SNDRV_CTL_IOCTL_SUBSCRIBE_EVENTS, &subscribe) == -1) {
+        perror("Error subscribing to mixer events");
+    }
+    return 0;
+}
+
+static int alsa_read(mixer *m, long *value) {
+    struct snd_ctl_elem_value elem;
+    memset(&elem, 0, sizeof(elem));
+    elem.id = m->id;
+    if (ioctl(m->fd, SNDRV_CTL_IOCTL_ELEM_READ, &elem) == -1) {
+        perror("Error reading mixer control");
+        return -1;
+    }
+    *value = elem.value.integer.value[0];
+    return 0;
+}
+
+static int alsa_write(mixer *m, long value) {
+    struct snd_ctl_elem_value elem;
+    memset(&elem, 0, sizeof(elem));
+    elem.id = m->id;
+    for (unsigned i = 0; i < m->channels && i < 128; i++) {
+        elem.value.integer.value[i] = value;
+    }
+    if (ioctl(m->fd, SNDRV_CTL_IOCTL_ELEM_WRITE, &elem) == -1) {
+        perror("Error writing mixer control");
+        return -1;
+    }
+    return 0;
+}
+
+static int alsa_events(mixer *m) {
+    struct snd_ctl_event events[8];
+    int changed = 0;
+    ssize_t n;
+    while ((n = read(m->fd, events, sizeof(events))) > 0) {
+        for (size_t i = 0; i < (size_t)n / sizeof(events[0]); i++) {
+            if (events[i].type == SNDRV_CTL_EVENT_ELEM &&
+                events[i].data.elem.id.numid == m->id.numid &&
+                (events[i].data.elem.mask & SNDRV_CTL_EVENT_MASK_VALUE)) {
+                changed = 1;
+            }
+        }
+    }
+    return changed;
+}
+
+static void alsa_close(mixer *m) {
+    close(m->fd);
+    m->fd = -1;
+}
+
+const mixer_backend mixer_backend_alsa = {
+    .name = "alsa",
+    .open = alsa_open,
+    .read = alsa_read,
+    .write = alsa_write,
+    .events = alsa_events,
+    .close = alsa_close,
+};
+
+// ---- 模拟后端 ----
+
+static int fake_open(mixer *m, const char *spec) {
+    m->min = 0;
+    m->max = 63;
+    m->fake_value = 0;
+    m->channels = 1;
+    snprintf(m->control, sizeof(m->control), "fake");
+    if (spec[4] == ':' &&
+        sscanf(spec + 5, "%ld,%ld,%ld", &m->min, &m->max, &m->fake_value) < 2) {
+        fprintf(stderr, "Invalid mixer spec \"%s\"\n", spec);
+        return -1;
+    }
+    if (m->max < m->min) {
+        fprintf(stderr, "Invalid mixer range in \"%s\"\n", spec);
+        return -1;
+    }
+    return 0;
+}
+
+static int fake_read(mixer *m, long *value) {
+    *value = m->fake_value;
+    return 0;
+}
+
+static int fake_write(mixer *m, long value) {
+    m->fake_value = value;
+    return 0;
+}
+
+static int fake_events(mixer *m) {
+    (void)m;
+    return 0;
+}
+
+static void fake_close(mixer *m) {
+    (void)m;
+}
+
+const mixer_backend mixer_backend_fake = {
+    .name = "fake",
+    .open = fake_open,
+    .read = fake_read,
+    .write = fake_write,
+    .events = fake_events,
+    .close = fake_close,
+};
+
+// ---- 通用部分 ----
+
+static long clamp(const mixer *m, long value) {
+    if (value < m->min) return m->min;
+    if (value > m->max) return m->max;
+    return value;
+}
+
+int mixer_open(mixer *m, const char *spec) {
+    memset(m, 0, sizeof(*m));
+    m->fd = -1;
+    m->timer = -1;
+    if (!spec) {
+        spec = getenv(MIXER_ENV);
+    }
+    if (!spec || !spec[0]) {
+        spec = MIXER_DEFAULT_SPEC;
+    }
+
+    if (strncmp(spec, MIXER_FAKE_PREFIX, strlen(MIXER_FAKE_PREFIX)) == 0) {
+        m->backend = &mixer_backend_fake;
+    } else if (strncmp(spec, "hw:", 3) == 0) {
+        m->backend = &mixer_backend_alsa;
+    } else {
+        fprintf(stderr, "Invalid mixer spec \"%s\"\n", spec);
+        return -1;
+    }
+    if (m->backend->open(m, spec) == -1) {
+        return -1;
+    }
+    if (m->backend->read(m, &m->value) == -1) {
+        m->backend->close(m);
+        return -1;
+    }
+    m->reads++;
+    m->target = m->value;
+    return 0;
+}
+
+void mixer_close(mixer *m) {
+    mixer_flush(m);
+    if (m->loop) {
+        event_loop_timer_cancel(m->loop, m->timer);
+        if (m->fd >= 0) {
+            event_loop_remove_fd(m->loop, m->fd);
+        }
+    }
+    m->backend->close(m);
+}
+
+void mixer_flush(mixer *m) {
+    if (m->target == m->value) {
+        return;
+    }
+    if (m->backend->write(m, m->target) == 0) {
+        m->writes++;
+        m->value = m->target;
+    } else {
+        m->target = m->value;
+    }
+}
+
+// 合并窗口结束：窗口内有新请求时写入并再开一个窗口，否则关闭窗口
+static void on_coalesce_timer(void *arg) {
+    mixer *m = arg;
+    if (m->target != m->value) {
+        mixer_flush(m);
+        event_loop_timer_start(m->loop, m->timer, MIXER_COALESCE_MS);
+    } else {
+        m->window_open = 0;
+    }
+}
+
+// 控制事件：重新读取，值被外部修改且没有待写入的请求时更新缓存
+static void on_mixer_event(void *arg, int fd, uint32_t events) {
+    mixer *m = arg;
+    (void)fd;
+    (void)events;
+    long value;
+    if (!m->backend->events(m) || m->backend->read(m, &value) == -1) {
+        return;
+    }
+    m->reads++;
+    if (m->target == m->value) {
+        m->target = value;
+    }
+    m->value = value;
+}
+
+int mixer_attach(mixer *m, event_loop *loop) {
+    m->timer = event_loop_add_timer(loop, on_coalesce_timer, m);
+    if (m->timer == -1) {
+        return -1;
+    }
+    if (m->fd >= 0 && event_loop_add_fd(loop, m->fd, EPOLLIN, on_mixer_event, m) == -1) {
+        return -1;
+    }
+    m->loop = loop;
+    return 0;
+}
+
+long mixer_get(const mixer *m) {
+    return m->target;
+}
+
+long mixer_set(mixer *m, long value) {
+    m->target = clamp(m, value);
+    m->requests++;
+    if (!m->loop) {
+        mixer_flush(m);
+    } else if (!m->window_open) {
+        // 窗口外的第一次请求立即写入，按键响应不增加延迟
+        mixer_flush(m);
+        m->window_open = 1;
+        event_loop_timer_start(m->loop, m->timer, MIXER_COALESCE_MS);
+    }
+    return m->target;
+}
+
+void mixer_report(const mixer *m) {
+    printf("Mixer (%s, %s %ld..%ld): %llu requests, %llu writes, %llu reads\n",
+           m->backend->name, m->control, m->min, m->max,
+           (unsigned long long)m->requests, (unsigned long long)m->writes,
+           (unsigned long long)m->reads);
+}
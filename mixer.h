@@ -0,0 +1,77 @@
+#ifndef MIXER_H
+#define MIXER_H
+
+#include <stdint.h>
+#include <sound/asound.h>
+
+#include "event_loop.h"
+
+// 音量控制：直接通过 ALSA 控制设备（/dev/snd/controlCN）的 ioctl 读写混音器元素，
+// 不再为每次按键启动 amixer | grep | awk
+// 当前值缓存在内存中，订阅控制事件，其它程序修改音量时更新缓存
+// 接入事件循环后，一串连续的调整合并写入：窗口内第一次立即写入，之后只更新目标值，
+// 窗口结束时再写入一次最终值
+// 后端由环境变量 AKU_MIXER 选择，未设置时使用声卡0的 "Power Amplifier"：
+//   AKU_MIXER=hw:0,Power Amplifier      ALSA 后端，声卡编号和控制名
+//   AKU_MIXER=fake:0,63,20              内存中的模拟后端（最小值、最大值、初始值），用于测试和基准
+
+#define MIXER_ENV             "AKU_MIXER"
+#define MIXER_DEFAULT_SPEC    "hw:0,Power Amplifier"
+#define MIXER_FAKE_PREFIX     "fake"
+#define MIXER_COALESCE_MS     40     // 合并窗口
+
+typedef struct mixer mixer;
+
+// 后端接口
+typedef struct {
+    const char *name;
+    int (*open)(mixer *m, const char *spec);
+    int (*read)(mixer *m, long *value);
+    int (*write)(mixer *m, long value);
+    // 处理控制事件（fd 可读时调用），值可能被外部修改时返回1
+    int (*events)(mixer *m);
+    void (*close)(mixer *m);
+} mixer_backend;
+
+struct mixer {
+    const mixer_backend *backend;
+    char control[64];
+    long min;
+    long max;
+    long value;              // 已写入的值
+    long target;             // 请求的值，与 value 不同时表示还未写入
+    int fd;                  // ALSA 控制设备，模拟后端为 -1
+    struct snd_ctl_elem_id id;
+    unsigned int channels;
+    long fake_value;         // 模拟后端的“硬件”值
+
+    event_loop *loop;        // 为 NULL 时每次请求立即写入
+    int timer;
+    int window_open;         // 合并窗口进行中
+
+    // 统计
+    uint64_t requests;
+    uint64_t writes;
+    uint64_t reads;
+};
+
+extern const mixer_backend mixer_backend_alsa;
+extern const mixer_backend mixer_backend_fake;
+
+// 打开混音器；spec 为 NULL 时读取 AKU_MIXER。失败时打印原因并返回-1
+int mixer_open(mixer *m, const char *spec);
+void mixer_close(mixer *m);
+
+// 加入事件循环：监视控制事件，并启用合并写入，成功返回0
+int mixer_attach(mixer *m, event_loop *loop);
+
+// 当前音量（包括尚未写入的请求）
+long mixer_get(const mixer *m);
+// 请求新音量，限制到元素范围内并返回实际值
+long mixer_set(mixer *m, long value);
+// 立即写入尚未写入的请求
+void mixer_flush(mixer *m);
+
+void mixer_report(const mixer *m);
+
+#endif
@@ -0,0 +1,665 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <getopt.h>
+#include <stdint.h>
+#include <math.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#include "anim_pack.h"
+#include "thread_pool.h"
+#include "fnv_hash.h"
+
+// 动画资源编译器：将GIF文件或BMP序列目录打包为动画包（.akp），帧数据预先转换为RGB565
+// GIF按帧缩放到限定框内（与原 gif_to_bmp.py 的 max_width=162, max_height=132 一致）
+// 多个输入文件之间、同一文件的各帧之间都在线程池中并行处理
+// 源数据哈希写入包头，源文件未变化时跳过重建
+
+#define DEFAULT_MAX_WIDTH  162
+#define DEFAULT_MAX_HEIGHT 132
+
+// 编译参数
+static struct {
+    int delay_ms;
+    int keyframe_interval;
+    int max_width;
+    int max_height;
+    int force;
+} options = {
+    .delay_ms = 0,
+    .keyframe_interval = ANIM_PACK_DEFAULT_KEYFRAME_INTERVAL,
+    .max_width = DEFAULT_MAX_WIDTH,
+    .max_height = DEFAULT_MAX_HEIGHT,
+    .force = 0
+};
+
+static thread_pool pool;
+
+// 单个源文件
+typedef struct {
+    char *path;
+    unsigned char *data;
+    size_t size;
+} source_file;
+
+// 一个输入（GIF文件或BMP目录）对应一个编译任务
+typedef struct {
+    const char *input;
+    char output[512];
+    int is_gif;
+    int status;              // 0=已生成 1=已跳过 -1=失败
+} pack_job;
+
+// 一维重采样系数：每个输出坐标对应一段连续的源坐标及其权重
+typedef struct {
+    int *start;
+    int *count;
+    float *weights;          // 每个输出坐标占 max_count 个权重
+    int max_count;
+} resample_axis;
+
+// 单帧处理任务
+typedef struct {
+    // GIF帧：RGBA源像素，需要缩放
+    const unsigned char *rgba;
+    int src_width, src_height;
+    const resample_axis *axis_x;
+    const resample_axis *axis_y;
+    // BMP帧：需要解码的文件
+    const source_file *file;
+    int bmp_width, bmp_height;
+    // 输出
+    uint16_t *pixels;        // 由任务分配
+    int width, height;
+    int failed;
+} frame_task;
+
+void print_usage(const char* program_name) {
+    printf("Usage: %s [options] <input.gif|bmp_directory>...\n", program_name);
+    printf("Options:\n");
+    printf("  -o, --output    Output file (single input only)\n");
+    printf("                  (default: <name>/%s for GIFs, <dir>/%s for BMP directories)\n",
+           ANIM_PACK_DIR_FILE, ANIM_PACK_DIR_FILE);
+    printf("  -d, --delay     Per-frame delay for BMP directories (default: 0 = use player -d)\n");
+    printf("                  GIFs keep their own frame delays\n");
+    printf("  -k, --keyframe  Keyframe interval, other frames store changed rectangles only\n");
+    printf("                  (default: %d, 1 = keyframes only)\n", ANIM_PACK_DEFAULT_KEYFRAME_INTERVAL);
+    printf("  -W, --width     Max width GIF frames are scaled to (default: %d)\n", DEFAULT_MAX_WIDTH);
+    printf("  -H, --height    Max height GIF frames are scaled to (default: %d)\n", DEFAULT_MAX_HEIGHT);
+    printf("  -j, --jobs      Worker threads (default: number of CPUs)\n");
+    printf("  -f, --force     Rebuild even if the source is unchanged\n");
+    printf("Example:\n");
+    printf("  %s emotions/*.gif\n", program_name);
+    printf("  %s booting\n", program_name);
+}
+
+int compare_filenames(const void* a, const void* b) {
+    return strcmp(*(const char**)a, *(const char**)b);
+}
+
+// 读取整个文件
+static int read_file(source_file *file) {
+    FILE *fp = fopen(file->path, "rb");
+    if (!fp) {
+        fprintf(stderr, "Error opening %s: %s\n", file->path, strerror(errno));
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fileno(fp), &st) == -1 || st.st_size <= 0) {
+        fprintf(stderr, "Error reading size of %s\n", file->path);
+        fclose(fp);
+        return -1;
+    }
+    file->size = st.st_size;
+    file->data = malloc(file->size);
+    if (!file->data || fread(file->data, 1, file->size, fp) != file->size) {
+        fprintf(stderr, "Error reading %s\n", file->path);
+        free(file->data);
+        file->data = NULL;
+        fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+    return 0;
+}
+
+static void free_sources(source_file *files, int count) {
+    for (int i = 0; i < count; i++) {
+        free(files[i].path);
+        free(files[i].data);
+    }
+    free(files);
+}
+
+// 列出目录中的BMP文件（按文件名排序）
+static int list_bmp_files(const char *directory, source_file **out) {
+    DIR *dir = opendir(directory);
+    if (!dir) {
+        fprintf(stderr, "Error opening directory %s: %s\n", directory, strerror(errno));
+        return -1;
+    }
+
+    char **names = NULL;
+    int count = 0, capacity = 0;
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (strstr(ent->d_name, ".bmp") == NULL) {
+            continue;
+        }
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            char **new_names = realloc(names, capacity * sizeof(char*));
+            if (!new_names) {
+                break;
+            }
+            names = new_names;
+        }
+        names[count] = malloc(strlen(directory) + strlen(ent->d_name) + 2);
+        if (!names[count]) {
+            break;
+        }
+        sprintf(names[count], "%s/%s", directory, ent->d_name);
+        count++;
+    }
+    closedir(dir);
+
+    if (count == 0) {
+        fprintf(stderr, "No BMP files found in %s\n", directory);
+        free(names);
+        return -1;
+    }
+    qsort(names, count, sizeof(char*), compare_filenames);
+
+    source_file *files = calloc(count, sizeof(source_file));
+    if (!files) {
+        for (int i = 0; i < count; i++) free(names[i]);
+        free(names);
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        files[i].path = names[i];
+    }
+    free(names);
+    *out = files;
+    return count;
+}
+
+// 计算一维重采样系数（三角滤波，缩小时按比例放宽支撑范围以抗锯齿）
+static int resample_axis_init(resample_axis *axis, int src_size, int dst_size) {
+    float scale = (float)src_size / dst_size;
+    float support = scale > 1.0f ? scale : 1.0f;
+    axis->max_count = (int)ceilf(support) * 2 + 1;
+    axis->start = malloc(dst_size * sizeof(int));
+    axis->count = malloc(dst_size * sizeof(int));
+    axis->weights = malloc((size_t)dst_size * axis->max_count * sizeof(float));
+    if (!axis->start || !axis->count || !axis->weights) {
+        free(axis->start);
+        free(axis->count);
+        free(axis->weights);
+        return -1;
+    }
+
+    for (int i = 0; i < dst_size; i++) {
+        float center = (i + 0.5f) * scale;
+        int begin = (int)floorf(center - support);
+        int end = (int)ceilf(center + support);
+        if (begin < 0) begin = 0;
+        if (end > src_size) end = src_size;
+        if (end - begin > axis->max_count) end = begin + axis->max_count;
+
+        float *w = axis->weights + (size_t)i * axis->max_count;
+        float total = 0;
+        for (int j = begin; j < end; j++) {
+            float d = fabsf((j + 0.5f - center) / support);
+            w[j - begin] = d < 1.0f ? 1.0f - d : 0.0f;
+            total += w[j - begin];
+        }
+        if (total <= 0) {
+            // 极端情况下退化为最近邻
+            begin = (int)center < src_size ? (int)center : src_size - 1;
+            end = begin + 1;
+            w[0] = total = 1.0f;
+        }
+        for (int j = 0; j < end - begin; j++) {
+            w[j] /= total;
+        }
+        axis->start[i] = begin;
+        axis->count[i] = end - begin;
+    }
+    return 0;
+}
+
+static void resample_axis_free(resample_axis *axis) {
+    free(axis->start);
+    free(axis->count);
+    free(axis->weights);
+}
+
+static inline unsigned char clamp_channel(float v) {
+    if (v <= 0) return 0;
+    if (v >= 255) return 255;
+    return (unsigned char)(v + 0.5f);
+}
+
+// 缩放一帧RGBA（透明部分合成到黑色背景上）并转换为RGB565
+static void scale_gif_frame(frame_task *task) {
+    int dst_w = task->width, dst_h = task->height;
+    int src_w = task->src_width, src_h = task->src_height;
+
+    task->pixels = malloc((size_t)dst_w * dst_h * 2);
+    float *rows = malloc((size_t)dst_w * src_h * 3 * sizeof(float));
+    if (!task->pixels || !rows) {
+        free(rows);
+        task->failed = 1;
+        return;
+    }
+
+    // 横向缩放
+    const resample_axis *ax = task->axis_x;
+    for (int y = 0; y < src_h; y++) {
+        const unsigned char *src = task->rgba + (size_t)y * src_w * 4;
+        float *dst = rows + (size_t)y * dst_w * 3;
+        for (int x = 0; x < dst_w; x++) {
+            const float *w = ax->weights + (size_t)x * ax->max_count;
+            float r = 0, g = 0, b = 0;
+            for (int k = 0; k < ax->count[x]; k++) {
+                const unsigned char *p = src + (ax->start[x] + k) * 4;
+                float a = w[k] * p[3] / 255.0f;
+                r += p[0] * a;
+                g += p[1] * a;
+                b += p[2] * a;
+            }
+            dst[x * 3] = r;
+            dst[x * 3 + 1] = g;
+            dst[x * 3 + 2] = b;
+        }
+    }
+
+    // 纵向缩放并转换为RGB565
+    const resample_axis *ay = task->axis_y;
+    for (int y = 0; y < dst_h; y++) {
+        const float *w = ay->weights + (size_t)y * ay->max_count;
+        for (int x = 0; x < dst_w; x++) {
+            float r = 0, g = 0, b = 0;
+            for (int k = 0; k < ay->count[y]; k++) {
+                const float *p = rows + ((size_t)(ay->start[y] + k) * dst_w + x) * 3;
+                r += p[0] * w[k];
+                g += p[1] * w[k];
+                b += p[2] * w[k];
+            }
+            unsigned char r8 = clamp_channel(r), g8 = clamp_channel(g), b8 = clamp_channel(b);
+            task->pixels[y * dst_w + x] = ((r8 >> 3) << 11) | ((g8 >> 2) << 5) | (b8 >> 3);
+        }
+    }
+    free(rows);
+}
+
+// 解码一帧BMP并转换为RGB565（BMP序列已是目标尺寸，不缩放）
+static void decode_bmp_frame(frame_task *task) {
+    int width, height, channels;
+    unsigned char *img = stbi_load_from_memory(task->file->data, task->file->size,
+                                               &width, &height, &channels, 3);
+    if (!img) {
+        fprintf(stderr, "Error loading image %s: %s\n", task->file->path, stbi_failure_reason());
+        task->failed = 1;
+        return;
+    }
+
+    task->width = width;
+    task->height = height;
+    task->pixels = malloc((size_t)width * height * 2);
+    if (!task->pixels) {
+        stbi_image_free(img);
+        task->failed = 1;
+        return;
+    }
+    for (int i = 0; i < width * height; i++) {
+        unsigned char r = img[i * 3];
+        unsigned char g = img[i * 3 + 1];
+        unsigned char b = img[i * 3 + 2];
+        task->pixels[i] = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+    }
+    stbi_image_free(img);
+}
+
+static void frame_task_run(void *arg) {
+    frame_task *task = arg;
+    if (task->file) {
+        decode_bmp_frame(task);
+    } else {
+        scale_gif_frame(task);
+    }
+}
+
+// 写出动画包
+static int write_pack(const char *output, frame_task *tasks, int frame_count,
+                      const int *delays, uint64_t hash) {
+    int width = tasks[0].width, height = tasks[0].height;
+    for (int i = 0; i < frame_count; i++) {
+        if (tasks[i].failed) {
+            return -1;
+        }
+        if (tasks[i].width != width || tasks[i].height != height) {
+            fprintf(stderr, "Frame %d size mismatch: %dx%d (expected %dx%d)\n",
+                    i, tasks[i].width, tasks[i].height, width, height);
+            return -1;
+        }
+    }
+
+    anim_pack_writer writer;
+    if (anim_pack_writer_open(&writer, output, width, height, options.keyframe_interval) == -1) {
+        return -1;
+    }
+    writer.header.source_hash = hash;
+
+    for (int i = 0; i < frame_count; i++) {
+        int delay = delays ? delays[i] : options.delay_ms;
+        if (anim_pack_writer_add_frame(&writer, tasks[i].pixels, delay) == -1) {
+            anim_pack_writer_abort(&writer);
+            return -1;
+        }
+    }
+    return anim_pack_writer_close(&writer);
+}
+
+// 参数也计入哈希，修改缩放尺寸或关键帧间隔后会重新生成
+static uint64_t hash_options(int is_gif) {
+    uint64_t hash = FNV_HASH_INIT;
+    int params[5] = {
+        is_gif, options.keyframe_interval,
+        is_gif ? options.max_width : 0,
+        is_gif ? options.max_height : 0,
+        is_gif ? 0 : options.delay_ms
+    };
+    return fnv_hash(hash, params, sizeof(params));
+}
+
+// 源文件未变化且输出已存在时跳过
+static int is_up_to_date(const char *output, uint64_t hash) {
+    uint64_t existing;
+    return !options.force && anim_pack_read_source_hash(output, &existing) == 0 && existing == hash;
+}
+
+static int compile_gif(pack_job *job) {
+    source_file file = { .path = (char *)job->input };
+    if (read_file(&file) == -1) {
+        return -1;
+    }
+
+    uint64_t hash = fnv_hash(hash_options(1), file.data, file.size);
+    if (is_up_to_date(job->output, hash)) {
+        free(file.data);
+        return 1;
+    }
+
+    int *delays = NULL;
+    int width, height, frame_count, channels;
+    unsigned char *frames = stbi_load_gif_from_memory(file.data, file.size, &delays,
+                                                      &width, &height, &frame_count, &channels, 4);
+    free(file.data);
+    if (!frames) {
+        fprintf(stderr, "Error loading GIF %s: %s\n", job->input, stbi_failure_reason());
+        return -1;
+    }
+
+    // 等比缩放到限定框内
+    float scale_w = (float)options.max_width / width;
+    float scale_h = (float)options.max_height / height;
+    float scale = scale_w < scale_h ? scale_w : scale_h;
+    int new_width = (int)(width * scale);
+    int new_height = (int)(height * scale);
+    if (new_width < 1) new_width = 1;
+    if (new_height < 1) new_height = 1;
+
+    int ret = -1;
+    resample_axis axis_x, axis_y;
+    frame_task *tasks = calloc(frame_count, sizeof(frame_task));
+    if (!tasks || resample_axis_init(&axis_x, width, new_width) == -1) {
+        free(tasks);
+        stbi_image_free(frames);
+        free(delays);
+        return -1;
+    }
+    if (resample_axis_init(&axis_y, height, new_height) == -1) {
+        resample_axis_free(&axis_x);
+        free(tasks);
+        stbi_image_free(frames);
+        free(delays);
+        return -1;
+    }
+
+    thread_pool_group group;
+    thread_pool_group_init(&group);
+    for (int i = 0; i < frame_count; i++) {
+        tasks[i].rgba = frames + (size_t)i * width * height * 4;
+        tasks[i].src_width = width;
+        tasks[i].src_height = height;
+        tasks[i].axis_x = &axis_x;
+        tasks[i].axis_y = &axis_y;
+        tasks[i].width = new_width;
+        tasks[i].height = new_height;
+        if (thread_pool_submit(&pool, &group, frame_task_run, &tasks[i]) == -1) {
+            tasks[i].failed = 1;
+        }
+    }
+    thread_pool_group_wait(&pool, &group);
+
+    if (write_pack(job->output, tasks, frame_count, delays, hash) == 0) {
+        printf("%s -> %s: %d frames (%dx%d -> %dx%d)\n", job->input, job->output,
+               frame_count, width, height, new_width, new_height);
+        ret = 0;
+    }
+
+    for (int i = 0; i < frame_count; i++) {
+        free(tasks[i].pixels);
+    }
+    free(tasks);
+    resample_axis_free(&axis_x);
+    resample_axis_free(&axis_y);
+    stbi_image_free(frames);
+    free(delays);
+    return ret;
+}
+
+static int compile_bmp_dir(pack_job *job) {
+    source_file *files;
+    int frame_count = list_bmp_files(job->input, &files);
+    if (frame_count < 0) {
+        return -1;
+    }
+
+    // 文件名和内容都计入哈希
+    uint64_t hash = hash_options(0);
+    for (int i = 0; i < frame_count; i++) {
+        if (read_file(&files[i]) == -1) {
+            free_sources(files, frame_count);
+            return -1;
+        }
+        const char *name = strrchr(files[i].path, '/') + 1;
+        hash = fnv_hash(hash, name, strlen(name) + 1);
+        hash = fnv_hash(hash, files[i].data, files[i].size);
+    }
+    if (is_up_to_date(job->output, hash)) {
+        free_sources(files, frame_count);
+        return 1;
+    }
+
+    int ret = -1;
+    frame_task *tasks = calloc(frame_count, sizeof(frame_task));
+    if (!tasks) {
+        free_sources(files, frame_count);
+        return -1;
+    }
+
+    thread_pool_group group;
+    thread_pool_group_init(&group);
+    for (int i = 0; i < frame_count; i++) {
+        tasks[i].file = &files[i];
+        if (thread_pool_submit(&pool, &group, frame_task_run, &tasks[i]) == -1) {
+            tasks[i].failed = 1;
+        }
+    }
+    thread_pool_group_wait(&pool, &group);
+
+    if (write_pack(job->output, tasks, frame_count, NULL, hash) == 0) {
+        printf("%s -> %s: %d frames (%dx%d)\n", job->input, job->output,
+               frame_count, tasks[0].width, tasks[0].height);
+        ret = 0;
+    }
+
+    for (int i = 0; i < frame_count; i++) {
+        free(tasks[i].pixels);
+    }
+    free(tasks);
+    free_sources(files, frame_count);
+    return ret;
+}
+
+static void pack_job_run(void *arg) {
+    pack_job *job = arg;
+    job->status = job->is_gif ? compile_gif(job) : compile_bmp_dir(job);
+    if (job->status == 1) {
+        printf("%s: up to date\n", job->input);
+    } else if (job->status == -1) {
+        fprintf(stderr, "%s: failed\n", job->input);
+    }
+}
+
+// 确定输入类型和默认输出路径，GIF输出到同名目录下（便于 boot.c 按目录选择动画）
+static int prepare_job(pack_job *job, const char *input, const char *output) {
+    struct stat st;
+    if (stat(input, &st) == -1) {
+        fprintf(stderr, "Error reading %s: %s\n", input, strerror(errno));
+        return -1;
+    }
+    job->input = input;
+    job->is_gif = S_ISREG(st.st_mode);
+    job->status = -1;
+
+    if (output) {
+        snprintf(job->output, sizeof(job->output), "%s", output);
+        return 0;
+    }
+
+    if (!job->is_gif) {
+        snprintf(job->output, sizeof(job->output), "%s/%s", input, ANIM_PACK_DIR_FILE);
+        return 0;
+    }
+
+    char dir[sizeof(job->output) - sizeof(ANIM_PACK_DIR_FILE) - 1];
+    snprintf(dir, sizeof(dir), "%s", input);
+    char *ext = strrchr(dir, '.');
+    char *slash = strrchr(dir, '/');
+    if (ext && (!slash || ext > slash)) {
+        *ext = '\0';
+    }
+    if (mkdir(dir, 0755) == -1 && errno != EEXIST) {
+        fprintf(stderr, "Error creating directory %s: %s\n", dir, strerror(errno));
+        return -1;
+    }
+    snprintf(job->output, sizeof(job->output), "%s/%s", dir, ANIM_PACK_DIR_FILE);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *output = NULL;
+    int jobs = 0;
+    int opt;
+
+    static struct option long_options[] = {
+        {"output", required_argument, 0, 'o'},
+        {"delay", required_argument, 0, 'd'},
+        {"keyframe", required_argument, 0, 'k'},
+        {"width", required_argument, 0, 'W'},
+        {"height", required_argument, 0, 'H'},
+        {"jobs", required_argument, 0, 'j'},
+        {"force", no_argument, 0, 'f'},
+        {0, 0, 0, 0}
+    };
+
+    while ((opt = getopt_long(argc, argv, "o:d:k:W:H:j:f", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'o':
+                output = optarg;
+                break;
+            case 'd':
+                options.delay_ms = atoi(optarg);
+                if (options.delay_ms < 0) {
+                    fprintf(stderr, "Invalid delay value. Must not be negative.\n");
+                    return 1;
+                }
+                break;
+            case 'k':
+                options.keyframe_interval = atoi(optarg);
+                if (options.keyframe_interval <= 0) {
+                    fprintf(stderr, "Invalid keyframe interval. Must be positive.\n");
+                    return 1;
+                }
+                break;
+            case 'W':
+                options.max_width = atoi(optarg);
+                break;
+            case 'H':
+                options.max_height = atoi(optarg);
+                break;
+            case 'j':
+                jobs = atoi(optarg);
+                break;
+            case 'f':
+                options.force = 1;
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind >= argc) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (options.max_width <= 0 || options.max_height <= 0) {
+        fprintf(stderr, "Invalid max size. Must be positive.\n");
+        return 1;
+    }
+    int input_count = argc - optind;
+    if (output && input_count > 1) {
+        fprintf(stderr, "-o can only be used with a single input\n");
+        return 1;
+    }
+
+    pack_job *job_list = calloc(input_count, sizeof(pack_job));
+    if (!job_list) {
+        perror("Error allocating job list");
+        return 1;
+    }
+    if (thread_pool_init(&pool, jobs) == -1) {
+        free(job_list);
+        return 1;
+    }
+
+    thread_pool_group group;
+    thread_pool_group_init(&group);
+    for (int i = 0; i < input_count; i++) {
+        if (prepare_job(&job_list[i], argv[optind + i], output) == 0) {
+            thread_pool_submit(&pool, &group, pack_job_run, &job_list[i]);
+        }
+    }
+    thread_pool_group_wait(&pool, &group);
+    thread_pool_destroy(&pool);
+
+    int built = 0, skipped = 0, failed = 0;
+    for (int i = 0; i < input_count; i++) {
+        if (job_list[i].status == 0) built++;
+        else if (job_list[i].status == 1) skipped++;
+        else failed++;
+    }
+    printf("Built %d, up to date %d, failed %d\n", built, skipped, failed);
+
+    free(job_list);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,410 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include "glyph_cache.h"
+#include "font_atlas.h"
+#include "text_layout.h"
+#include "fnv_hash.h"
+
+// 字形图集编译器：把字体中选定字符集在选定像素大小下预先光栅化，写成可 mmap 的图集（.akf）
+// show_text 启动时映射图集，图集中有的字形不再初始化 FreeType、不再打开字体文件
+// 光栅化方式与 show_text 运行时完全相同（FT_LOAD_RENDER），输出逐像素一致
+// 字符集内两两之间的字距调整（字体的 kern 表）也写入图集，排版时不必为它加载字体
+// 字体文件、字符集和大小的哈希写入文件头，未变化时跳过重建
+
+#define MAX_SIZES 16
+
+static struct {
+    int sizes[MAX_SIZES];
+    int size_count;
+    int force;
+} options = {
+    .size_count = 0,
+    .force = 0
+};
+
+// 字符集（码位数组，排序去重后使用）
+static uint32_t *charset;
+static size_t charset_count;
+static size_t charset_capacity;
+
+void print_usage(const char *program_name) {
+    printf("Usage: %s [options] <font.ttf>\n", program_name);
+    printf("Options:\n");
+    printf("  -o, --output    Output file (default: font path with %s extension)\n", FONT_ATLAS_EXT);
+    printf("  -s, --sizes     Comma-separated pixel sizes (default: 24)\n");
+    printf("  -c, --chars     Characters to include (UTF-8, may be repeated)\n");
+    printf("  -t, --text      File whose characters are included (UTF-8, may be repeated)\n");
+    printf("                  Without -c/-t, printable ASCII is included\n");
+    printf("  -f, --force     Rebuild even if the source is unchanged\n");
+    printf("Example:\n");
+    printf("  %s -s 24 -c \"电量充电中\" -t key_config.json HarmonyOS_Sans_SC_Regular.ttf\n", program_name);
+}
+
+static int add_codepoint(uint32_t cp) {
+    // 跳过控制字符
+    if (cp < 0x20 || cp == 0x7f) {
+        return 0;
+    }
+    if (charset_count == charset_capacity) {
+        size_t capacity = charset_capacity ? charset_capacity * 2 : 256;
+        uint32_t *grown = realloc(charset, capacity * sizeof(*grown));
+        if (!grown) {
+            perror("Error allocating charset");
+            return -1;
+        }
+        charset = grown;
+        charset_capacity = capacity;
+    }
+    charset[charset_count++] = cp;
+    return 0;
+}
+
+// 解码 UTF-8 并加入字符集，非法字节跳过
+static int add_utf8(const unsigned char *s, size_t len) {
+    const unsigned char *end = s + len;
+    while (s < end) {
+        int32_t cp = utf8_next(&s, end);
+        if (cp >= 0 && add_codepoint(cp) == -1) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 读取整个文件
+static unsigned char *read_file(const char *path, size_t *size) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        fprintf(stderr, "Error opening %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    fseek(fp, 0, SEEK_END);
+    long len = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    unsigned char *data = len >= 0 ? malloc(len ? len : 1) : NULL;
+    if (!data || fread(data, 1, len, fp) != (size_t)len) {
+        fprintf(stderr, "Error reading %s\n", path);
+        free(data);
+        fclose(fp);
+        return NULL;
+    }
+    fclose(fp);
+    *size = len;
+    return data;
+}
+
+static int compare_codepoints(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static int compare_ints(const void *a, const void *b) {
+    return *(const int *)a - *(const int *)b;
+}
+
+static int compare_kerns(const void *a, const void *b) {
+    const font_atlas_kern *x = a;
+    const font_atlas_kern *y = b;
+    if (x->left != y->left) {
+        return x->left < y->left ? -1 : 1;
+    }
+    if (x->right != y->right) {
+        return x->right < y->right ? -1 : 1;
+    }
+    return x->size - y->size;
+}
+
+// 收集字符集内所有非零的字距调整，按 (左, 右, 大小) 排序；返回个数，失败返回-1
+static long collect_kerns(FT_Face face, const uint32_t *chars, size_t count, font_atlas_kern **out) {
+    *out = NULL;
+    if (!FT_HAS_KERNING(face)) {
+        return 0;
+    }
+    FT_UInt *indices = malloc(count * sizeof(*indices) + 1);
+    if (!indices) {
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        indices[i] = FT_Get_Char_Index(face, chars[i]);
+    }
+
+    font_atlas_kern *kerns = NULL;
+    size_t used = 0, capacity = 0;
+    for (int s = 0; s < options.size_count; s++) {
+        if (FT_Set_Pixel_Sizes(face, 0, options.sizes[s])) {
+            continue;
+        }
+        for (size_t i = 0; i < count; i++) {
+            for (size_t j = 0; j < count; j++) {
+                FT_Vector delta;
+                if (FT_Get_Kerning(face, indices[i], indices[j], FT_KERNING_DEFAULT, &delta) ||
+                    (delta.x >> 6) == 0) {
+                    continue;
+                }
+                if (used == capacity) {
+                    capacity = capacity ? capacity * 2 : 256;
+                    font_atlas_kern *grown = realloc(kerns, capacity * sizeof(*grown));
+                    if (!grown) {
+                        free(kerns);
+                        free(indices);
+                        return -1;
+                    }
+                    kerns = grown;
+                }
+                kerns[used++] = (font_atlas_kern){chars[i], chars[j], options.sizes[s], delta.x >> 6};
+            }
+        }
+    }
+    free(indices);
+    qsort(kerns, used, sizeof(*kerns), compare_kerns);
+    *out = kerns;
+    return used;
+}
+
+static int parse_sizes(const char *arg) {
+    char *end;
+    options.size_count = 0;
+    do {
+        long size = strtol(arg, &end, 10);
+        if (end == arg || size < 8 || size > 72 || options.size_count == MAX_SIZES) {
+            fprintf(stderr, "Invalid sizes: must be 8..72, at most %d\n", MAX_SIZES);
+            return -1;
+        }
+        options.sizes[options.size_count++] = size;
+        arg = end + 1;
+    } while (*end == ',');
+    return *end == '\0' ? 0 : -1;
+}
+
+// 写入图集：先写临时文件再重命名，避免 show_text 读到半成品
+static int write_atlas(const char *path, glyph_cache *cache, glyph *entries, uint32_t count,
+                       const font_atlas_kern *kerns, uint32_t kern_count, uint64_t hash) {
+    char tmp_path[512];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    FILE *fp = fopen(tmp_path, "wb");
+    if (!fp) {
+        fprintf(stderr, "Error creating %s: %s\n", tmp_path, strerror(errno));
+        return -1;
+    }
+
+    font_atlas_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FONT_ATLAS_MAGIC, 4);
+    header.version = FONT_ATLAS_VERSION;
+    header.size_count = options.size_count;
+    header.glyph_count = count;
+    header.bitmap_offset = sizeof(header);
+    header.source_hash = hash;
+
+    int ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+    uint32_t offset = header.bitmap_offset;
+    for (uint32_t i = 0; ok && i < count; i++) {
+        size_t bytes = (size_t)entries[i].width * entries[i].rows;
+        ok = fwrite(glyph_bitmap(cache, &entries[i]), 1, bytes, fp) == bytes;
+        entries[i].offset = offset;
+        entries[i].flags = GLYPH_ATLAS;
+        offset += bytes;
+    }
+    header.bitmap_size = offset - header.bitmap_offset;
+
+    // 索引表按4字节对齐
+    static const unsigned char pad[4];
+    uint32_t padding = (4 - offset % 4) % 4;
+    header.index_offset = offset + padding;
+    header.kern_offset = header.index_offset + count * sizeof(glyph);
+    header.kern_count = kern_count;
+    ok = ok && fwrite(pad, 1, padding, fp) == padding &&
+         fwrite(entries, sizeof(glyph), count, fp) == count &&
+         fwrite(kerns, sizeof(*kerns), kern_count, fp) == kern_count &&
+         fseek(fp, 0, SEEK_SET) == 0 &&
+         fwrite(&header, sizeof(header), 1, fp) == 1;
+    ok = fclose(fp) == 0 && ok;
+    if (!ok || rename(tmp_path, path) == -1) {
+        fprintf(stderr, "Error writing %s: %s\n", path, strerror(errno));
+        unlink(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *output = NULL;
+    int opt;
+
+    static struct option long_options[] = {
+        {"output", required_argument, 0, 'o'},
+        {"sizes", required_argument, 0, 's'},
+        {"chars", required_argument, 0, 'c'},
+        {"text", required_argument, 0, 't'},
+        {"force", no_argument, 0, 'f'},
+        {0, 0, 0, 0}
+    };
+
+    while ((opt = getopt_long(argc, argv, "o:s:c:t:f", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'o':
+                output = optarg;
+                break;
+            case 's':
+                if (parse_sizes(optarg) == -1) {
+                    return 1;
+                }
+                break;
+            case 'c':
+                if (add_utf8((const unsigned char *)optarg, strlen(optarg)) == -1) {
+                    return 1;
+                }
+                break;
+            case 't': {
+                size_t size;
+                unsigned char *text = read_file(optarg, &size);
+                if (!text || add_utf8(text, size) == -1) {
+                    free(text);
+                    return 1;
+                }
+                free(text);
+                break;
+            }
+            case 'f':
+                options.force = 1;
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind != argc - 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    const char *font_path = argv[optind];
+
+    char default_output[512];
+    if (!output) {
+        snprintf(default_output, sizeof(default_output), "%s", font_path);
+        char *dot = strrchr(default_output, '.');
+        char *slash = strrchr(default_output, '/');
+        if (dot && (!slash || dot > slash)) {
+            *dot = '\0';
+        }
+        strncat(default_output, FONT_ATLAS_EXT, sizeof(default_output) - strlen(default_output) - 1);
+        output = default_output;
+    }
+
+    if (options.size_count == 0) {
+        options.sizes[options.size_count++] = 24;
+    }
+    if (charset_count == 0) {
+        for (uint32_t cp = 0x20; cp < 0x7f; cp++) {
+            add_codepoint(cp);
+        }
+    }
+    // 排序并去重：图集中的字号和字符都必须严格递增
+    qsort(options.sizes, options.size_count, sizeof(int), compare_ints);
+    int unique_sizes = 0;
+    for (int i = 0; i < options.size_count; i++) {
+        if (unique_sizes == 0 || options.sizes[unique_sizes - 1] != options.sizes[i]) {
+            options.sizes[unique_sizes++] = options.sizes[i];
+        }
+    }
+    options.size_count = unique_sizes;
+    qsort(charset, charset_count, sizeof(uint32_t), compare_codepoints);
+    size_t unique = 0;
+    for (size_t i = 0; i < charset_count; i++) {
+        if (unique == 0 || charset[unique - 1] != charset[i]) {
+            charset[unique++] = charset[i];
+        }
+    }
+    charset_count = unique;
+
+    size_t font_size;
+    unsigned char *font_data = read_file(font_path, &font_size);
+    if (!font_data) {
+        return 1;
+    }
+    uint64_t hash = fnv_hash(FNV_HASH_INIT, font_data, font_size);
+    hash = fnv_hash(hash, charset, charset_count * sizeof(uint32_t));
+    hash = fnv_hash(hash, options.sizes, options.size_count * sizeof(int));
+    uint64_t existing;
+    if (!options.force && font_atlas_read_source_hash(output, &existing) == 0 && existing == hash) {
+        printf("%s is up to date\n", output);
+        free(font_data);
+        return 0;
+    }
+
+    FT_Library library;
+    FT_Face face;
+    if (FT_Init_FreeType(&library)) {
+        fprintf(stderr, "Could not initialize FreeType library\n");
+        free(font_data);
+        return 1;
+    }
+    if (FT_New_Memory_Face(library, font_data, font_size, 0, &face)) {
+        fprintf(stderr, "Could not open font file: %s\n", font_path);
+        FT_Done_FreeType(library);
+        free(font_data);
+        return 1;
+    }
+
+    glyph_cache cache;
+    glyph *entries = calloc(charset_count * options.size_count + 1, sizeof(glyph));
+    if (!entries || glyph_cache_init(&cache, face) == -1) {
+        perror("Error allocating glyph table");
+        return 1;
+    }
+
+    // 按 (码位, 大小) 顺序光栅化，正好是索引表的排序顺序；字体中没有的字符不写入
+    uint32_t count = 0;
+    size_t absent = 0;
+    for (size_t i = 0; i < charset_count; i++) {
+        if (FT_Get_Char_Index(face, charset[i]) == 0) {
+            absent++;
+            continue;
+        }
+        charset[i - absent] = charset[i];
+        for (int s = 0; s < options.size_count; s++) {
+            const glyph *g = glyph_cache_get(&cache, charset[i], options.sizes[s]);
+            if (!g) {
+                perror("Error rasterizing glyph");
+                return 1;
+            }
+            if (!(g->flags & GLYPH_MISSING)) {
+                entries[count++] = *g;
+            }
+        }
+    }
+
+    // 字体中有的字符已移到 charset 前部
+    font_atlas_kern *kerns;
+    long kern_count = collect_kerns(face, charset, charset_count - absent, &kerns);
+    if (kern_count == -1) {
+        perror("Error collecting kerning pairs");
+        return 1;
+    }
+
+    int status = write_atlas(output, &cache, entries, count, kerns, kern_count, hash);
+    if (status == 0) {
+        printf("%s: %u glyphs (%zu characters x %d sizes, %zu not in font), %zu bitmap bytes, %ld kerning pairs\n",
+               output, count, charset_count - absent, options.size_count, absent, cache.arena_used,
+               kern_count);
+    }
+    free(kerns);
+
+    glyph_cache_destroy(&cache);
+    free(entries);
+    free(charset);
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+    free(font_data);
+    return status == 0 ? 0 : 1;
+}
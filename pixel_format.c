@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "pixel_format.h"
+
+// 按字节宽度写入像素（帧缓冲为小端）
+static inline void store_pixel_2(unsigned char *dst, uint32_t pixel) {
+    *(uint16_t *)dst = pixel;
+}
+
+static inline void store_pixel_3(unsigned char *dst, uint32_t pixel) {
+    dst[0] = pixel;
+    dst[1] = pixel >> 8;
+    dst[2] = pixel >> 16;
+}
+
+static inline void store_pixel_4(unsigned char *dst, uint32_t pixel) {
+    *(uint32_t *)dst = pixel;
+}
+
+// RGB565 各分量扩展为8位
+static inline void expand_rgb565(uint16_t c, unsigned char *r, unsigned char *g, unsigned char *b) {
+    unsigned char r5 = c >> 11, g6 = (c >> 5) & 0x3F, b5 = c & 0x1F;
+    *r = (r5 << 3) | (r5 >> 2);
+    *g = (g6 << 2) | (g6 >> 4);
+    *b = (b5 << 3) | (b5 >> 2);
+}
+
+// 为每种格式生成一组特化函数，位移量都是编译期常量
+// 带 alpha 位域的格式 alpha 全部置1（不透明），否则部分驱动会把画面当作透明
+#define DEFINE_PIXEL_FORMAT(NAME, BYTES, ROFF, RLEN, GOFF, GLEN, BOFF, BLEN, TOFF, TLEN)            \
+    static inline uint32_t pack_##NAME(unsigned char r, unsigned char g, unsigned char b) {         \
+        return ((uint32_t)(r >> (8 - RLEN)) << ROFF) |                                              \
+               ((uint32_t)(g >> (8 - GLEN)) << GOFF) |                                              \
+               ((uint32_t)(b >> (8 - BLEN)) << BOFF) |                                              \
+               (((1u << TLEN) - 1) << TOFF);                                                        \
+    }                                                                                               \
+    static inline void from_rgb888_##NAME(const unsigned char *src, unsigned char *dst, int count) {\
+        for (int i = 0; i < count; i++) {                                                           \
+            store_pixel_##BYTES(dst + i * BYTES,                                                    \
+                                pack_##NAME(src[i * 3], src[i * 3 + 1], src[i * 3 + 2]));           \
+        }                                                                                           \
+    }                                                                                               \
+    static inline void from_rgb565_##NAME(const uint16_t *src, unsigned char *dst, int count) {     \
+        for (int i = 0; i < count; i++) {                                                           \
+            unsigned char r, g, b;                                                                  \
+            expand_rgb565(src[i], &r, &g, &b);                                                      \
+            store_pixel_##BYTES(dst + i * BYTES, pack_##NAME(r, g, b));                             \
+        }                                                                                           \
+    }                                                                                               \
+    static inline void fill_##NAME(unsigned char *dst, uint32_t pixel, int count) {                 \
+        for (int i = 0; i < count; i++) {                                                           \
+            store_pixel_##BYTES(dst + i * BYTES, pixel);                                            \
+        }                                                                                           \
+    }
+
+DEFINE_PIXEL_FORMAT(rgb565, 2, 11, 5, 5, 6, 0, 5, 0, 0)
+DEFINE_PIXEL_FORMAT(bgr565, 2, 0, 5, 5, 6, 11, 5, 0, 0)
+DEFINE_PIXEL_FORMAT(rgb888, 3, 16, 8, 8, 8, 0, 8, 0, 0)
+DEFINE_PIXEL_FORMAT(bgr888, 3, 0, 8, 8, 8, 16, 8, 0, 0)
+DEFINE_PIXEL_FORMAT(xrgb8888, 4, 16, 8, 8, 8, 0, 8, 0, 0)
+DEFINE_PIXEL_FORMAT(xbgr8888, 4, 0, 8, 8, 8, 16, 8, 0, 0)
+DEFINE_PIXEL_FORMAT(argb8888, 4, 16, 8, 8, 8, 0, 8, 24, 8)
+DEFINE_PIXEL_FORMAT(abgr8888, 4, 0, 8, 8, 8, 16, 8, 24, 8)
+
+// 源和目标都是RGB565时直接拷贝
+static void from_rgb565_copy(const uint16_t *src, unsigned char *dst, int count) {
+    memcpy(dst, src, count * 2);
+}
+
+#define PIXEL_FORMAT_ENTRY(NAME, BPP, ROFF, RLEN, GOFF, GLEN, BOFF, BLEN, TOFF, TLEN, FROM565)      \
+    { #NAME, BPP, BPP / 8,                                                                          \
+      { ROFF, RLEN, 0 }, { GOFF, GLEN, 0 }, { BOFF, BLEN, 0 }, { TOFF, TLEN, 0 },                   \
+      pack_##NAME, from_rgb888_##NAME, FROM565, fill_##NAME }
+
+static const pixel_format formats[] = {
+    PIXEL_FORMAT_ENTRY(rgb565, 16, 11, 5, 5, 6, 0, 5, 0, 0, from_rgb565_copy),
+    PIXEL_FORMAT_ENTRY(bgr565, 16, 0, 5, 5, 6, 11, 5, 0, 0, from_rgb565_bgr565),
+    PIXEL_FORMAT_ENTRY(rgb888, 24, 16, 8, 8, 8, 0, 8, 0, 0, from_rgb565_rgb888),
+    PIXEL_FORMAT_ENTRY(bgr888, 24, 0, 8, 8, 8, 16, 8, 0, 0, from_rgb565_bgr888),
+    PIXEL_FORMAT_ENTRY(xrgb8888, 32, 16, 8, 8, 8, 0, 8, 0, 0, from_rgb565_xrgb8888),
+    PIXEL_FORMAT_ENTRY(xbgr8888, 32, 0, 8, 8, 8, 16, 8, 0, 0, from_rgb565_xbgr8888),
+    PIXEL_FORMAT_ENTRY(argb8888, 32, 16, 8, 8, 8, 0, 8, 24, 8, from_rgb565_argb8888),
+    PIXEL_FORMAT_ENTRY(abgr8888, 32, 0, 8, 8, 8, 16, 8, 24, 8, from_rgb565_abgr8888),
+};
+
+static int bitfield_equal(const struct fb_bitfield *a, const struct fb_bitfield *b) {
+    return a->offset == b->offset && a->length == b->length;
+}
+
+// 没有 alpha 位域时驱动填写的 offset 无意义，只比较长度
+static int transp_equal(const struct fb_bitfield *a, const struct fb_bitfield *b) {
+    return a->length == 0 ? b->length == 0 : bitfield_equal(a, b);
+}
+
+const pixel_format *pixel_format_from_vinfo(const struct fb_var_screeninfo *vinfo) {
+    for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+        const pixel_format *format = &formats[i];
+        if (vinfo->bits_per_pixel == (unsigned)format->bits_per_pixel &&
+            bitfield_equal(&vinfo->red, &format->red) &&
+            bitfield_equal(&vinfo->green, &format->green) &&
+            bitfield_equal(&vinfo->blue, &format->blue) &&
+            transp_equal(&vinfo->transp, &format->transp)) {
+            return format;
+        }
+    }
+
+    // 部分驱动不填写16位模式的位域，按RGB565处理
+    if (vinfo->bits_per_pixel == 16 && vinfo->red.length == 0 &&
+        vinfo->green.length == 0 && vinfo->blue.length == 0 && vinfo->transp.length == 0) {
+        return &formats[0];
+    }
+
+    fprintf(stderr, "Unsupported pixel format: %d bpp, R %d/%d G %d/%d B %d/%d A %d/%d\n",
+            vinfo->bits_per_pixel,
+            vinfo->red.offset, vinfo->red.length,
+            vinfo->green.offset, vinfo->green.length,
+            vinfo->blue.offset, vinfo->blue.length,
+            vinfo->transp.offset, vinfo->transp.length);
+    return NULL;
+}
+
+const pixel_format *pixel_format_by_name(const char *name) {
+    for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+        if (strcmp(formats[i].name, name) == 0) {
+            return &formats[i];
+        }
+    }
+    return NULL;
+}
+
+uint32_t pixel_format_from_rgb565(const pixel_format *format, uint16_t color) {
+    unsigned char r, g, b;
+    expand_rgb565(color, &r, &g, &b);
+    return format->pack(r, g, b);
+}
+
+void pixel_format_clear(const pixel_format *format, unsigned char *dst, size_t line_length,
+                        int width, int height) {
+    uint32_t black = format->pack(0, 0, 0);
+    size_t row_bytes = (size_t)width * format->bytes_per_pixel;
+    if (black == 0 && row_bytes == line_length) {
+        memset(dst, 0, line_length * height);
+        return;
+    }
+    for (int y = 0; y < height; y++, dst += line_length) {
+        if (black == 0) {
+            memset(dst, 0, row_bytes);
+        } else {
+            format->fill_row(dst, black, width);
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef PIXEL_FORMAT_H
+#define PIXEL_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/fb.h>
+
+// 帧缓冲像素格式
+// 根据 fb_var_screeninfo 的 bits_per_pixel 和 red/green/blue/transp 位域选出一组
+// 编译期特化的转换函数，调用者只在初始化时选择一次，逐像素循环中没有格式分支
+
+typedef struct {
+    const char *name;
+    int bits_per_pixel;
+    int bytes_per_pixel;
+    struct fb_bitfield red, green, blue;
+    struct fb_bitfield transp;      // alpha 位域，长度为0表示没有（x 格式的填充字节）
+
+    // 把8位RGB打包为本格式的像素值（有 alpha 时为不透明）
+    uint32_t (*pack)(unsigned char r, unsigned char g, unsigned char b);
+    // 一行RGB888（R,G,B 字节顺序，与 stbi_load 输出一致）转换到帧缓冲
+    void (*from_rgb888_row)(const unsigned char *src, unsigned char *dst, int count);
+    // 一行RGB565（动画包格式）转换到帧缓冲
+    void (*from_rgb565_row)(const uint16_t *src, unsigned char *dst, int count);
+    // 用同一像素值填充一行
+    void (*fill_row)(unsigned char *dst, uint32_t pixel, int count);
+} pixel_format;
+
+// 按屏幕信息选择像素格式，不支持时返回 NULL
+const pixel_format *pixel_format_from_vinfo(const struct fb_var_screeninfo *vinfo);
+
+// 按名称（rgb565、xrgb8888 等）查找像素格式，不存在时返回 NULL
+const pixel_format *pixel_format_by_name(const char *name);
+
+// RGB565颜色值（show_text 的颜色参数格式）转换为本格式的像素值
+uint32_t pixel_format_from_rgb565(const pixel_format *format, uint16_t color);
+
+// 用黑色填充 height 行、每行 width 个像素；黑色为全0时直接 memset，argb 等格式按像素填写不透明黑色
+void pixel_format_clear(const pixel_format *format, unsigned char *dst, size_t line_length,
+                        int width, int height);
+
+#endif
@@ -1,33 +1,58 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <fcntl.h>
-#include <unistd.h>
-#include <sys/mman.h>
-#include <sys/ioctl.h>
-#include <linux/fb.h>
 #include <string.h>
-#include <dirent.h>
 #include <getopt.h>
+#include <signal.h>
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
+#include "anim_pack.h"
+#include "anim_player.h"
+#include "frame_cache.h"
+#include "frame_queue.h"
+#include "pixel_format.h"
+#include "fb_backend.h"
+#include "fb_present.h"
+#include "frame_clock.h"
 
 void print_usage(const char* program_name) {
-    printf("Usage: %s [-d delay_ms] [-l] <directory>\n", program_name);
+    printf("Usage: %s [-d delay_ms] [-l] <directory|file%s|file.gif>\n", program_name, ANIM_PACK_EXT);
     printf("Options:\n");
     printf("  -d, --delay  Delay between frames in milliseconds (default: 100)\n");
     printf("  -l, --loop   Play animation once (default: infinite loop)\n");
+    printf("  -s, --start  Start from this frame (animation packs only)\n");
+    printf("  -q, --queue  Decode-ahead queue depth for BMP sequences (default: %d)\n",
+           FRAME_QUEUE_DEFAULT_DEPTH);
+    printf("  -c, --cache  Decoded frame cache budget in MB, 0 disables (default: $%s or %d)\n",
+           FRAME_CACHE_MB_ENV, FRAME_CACHE_DEFAULT_MB);
+    printf("  -m, --present  auto, flip (FBIOPAN_DISPLAY page flip) or copy (default: auto)\n");
+    printf("  -p, --policy   When playback falls behind: stretch (show every frame later) or\n"
+           "                 drop (skip frames to keep the original duration) (default: stretch)\n");
+    printf("If the directory contains %s it is played instead of the BMP files.\n", ANIM_PACK_DIR_FILE);
+    printf("GIF files are played with their own frame delays (-d is used for frames without one).\n");
     printf("Example:\n");
     printf("  %s -d 200 -l bmp_sequence\n", program_name);
 }
 
-int compare_filenames(const void* a, const void* b) {
-    return strcmp(*(const char**)a, *(const char**)b);
+// 收到 SIGTERM/SIGINT 后播放结束，正常清理并输出统计
+static volatile sig_atomic_t stop_requested = 0;
+
+static void handle_stop_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static int check_stop_requested(void *arg) {
+    (void)arg;
+    return stop_requested;
 }
 
 int main(int argc, char *argv[]) {
     int delay_ms = 100;  // 默认帧延迟
     int loop_once = 0;   // 默认无限循环
+    int start_frame = 0; // 起始帧
+    int cache_mb = -1;   // 帧缓存预算，-1 表示使用环境变量或默认值
+    int queue_depth = FRAME_QUEUE_DEFAULT_DEPTH;  // 解码队列深度
+    int present_mode = FB_PRESENT_AUTO;            // 画面提交方式
+    int clock_policy = FRAME_CLOCK_STRETCH;        // 落后于时间轴时的处理
     int opt;
     char* directory = NULL;
     
@@ -35,10 +60,15 @@ int main(int argc, char *argv[]) {
     static struct option long_options[] = {
         {"delay", required_argument, 0, 'd'},
         {"loop", no_argument, 0, 'l'},
+        {"start", required_argument, 0, 's'},
+        {"cache", required_argument, 0, 'c'},
+        {"queue", required_argument, 0, 'q'},
+        {"present", required_argument, 0, 'm'},
+        {"policy", required_argument, 0, 'p'},
         {0, 0, 0, 0}
     };
 
-    while ((opt = getopt_long(argc, argv, "d:l", long_options, NULL)) != -1) {
+    while ((opt = getopt_long(argc, argv, "d:ls:c:q:m:p:", long_options, NULL)) != -1) {
         switch (opt) {
             case 'd':
                 delay_ms = atoi(optarg);
@@ -50,6 +80,41 @@ int main(int argc, char *argv[]) {
             case 'l':
                 loop_once = 1;
                 break;
+            case 's':
+                start_frame = atoi(optarg);
+                if (start_frame < 0) {
+                    fprintf(stderr, "Invalid start frame. Must not be negative.\n");
+                    return 1;
+                }
+                break;
+            case 'c':
+                cache_mb = atoi(optarg);
+                if (cache_mb < 0) {
+                    fprintf(stderr, "Invalid cache size. Must not be negative.\n");
+                    return 1;
+                }
+                break;
+            case 'q':
+                queue_depth = atoi(optarg);
+                if (queue_depth < 2 || queue_depth > 64) {
+                    fprintf(stderr, "Invalid queue depth. Must be between 2 and 64.\n");
+                    return 1;
+                }
+                break;
+            case 'm':
+                present_mode = fb_present_mode_parse(optarg);
+                if (present_mode == -1) {
+                    fprintf(stderr, "Invalid present mode. Must be auto, flip or copy.\n");
+                    return 1;
+                }
+                break;
+            case 'p':
+                clock_policy = frame_clock_policy_parse(optarg);
+                if (clock_policy == -1) {
+                    fprintf(stderr, "Invalid policy. Must be drop or stretch.\n");
+                    return 1;
+                }
+                break;
             default:
                 print_usage(argv[0]);
                 return 1;
@@ -64,184 +129,63 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    // 打开帧缓冲设备
-    int fb = open("/dev/fb0", O_RDWR);
-    if (fb == -1) {
-        perror("Error opening /dev/fb0");
-        return 1;
-    }
+    frame_cache cache_state;
+    frame_cache *cache = &cache_state;
+    frame_cache_init(cache, cache_mb);
 
-    // 获取屏幕信息
-    struct fb_var_screeninfo vinfo;
-    struct fb_fix_screeninfo finfo;
-    
-    if (ioctl(fb, FBIOGET_VSCREENINFO, &vinfo)) {
-        perror("Error reading variable information");
-        close(fb);
-        return 1;
-    }
-    
-    if (ioctl(fb, FBIOGET_FSCREENINFO, &finfo)) {
-        perror("Error reading fixed information");
-        close(fb);
+    // 打开帧缓冲设备（AKU_FB 可指定其它设备或模拟设备）
+    fb_device fb;
+    if (fb_device_open(&fb, NULL) == -1) {
         return 1;
     }
+    struct fb_var_screeninfo vinfo = fb.vinfo;
 
     int fb_width = vinfo.xres;
     int fb_height = vinfo.yres;
     int bpp = vinfo.bits_per_pixel;
-    int line_length = finfo.line_length;
+    int line_length = fb.finfo.line_length;
 
     printf("Screen resolution: %dx%d\n", fb_width, fb_height);
     printf("Bits per pixel: %d\n", bpp);
     printf("Line length: %d\n", line_length);
 
-    // 映射帧缓冲到内存
-    size_t framebuffer_size = fb_height * line_length;
-    printf("Framebuffer size: %zu bytes\n", framebuffer_size);
-    
-    // 创建双缓冲
-    unsigned char* back_buffer = malloc(framebuffer_size);
-    if (!back_buffer) {
-        perror("Error allocating back buffer");
-        close(fb);
-        return 1;
-    }
-    
-    unsigned char* front_buffer = mmap(NULL, framebuffer_size, PROT_READ | PROT_WRITE, MAP_SHARED, fb, 0);
-    if (front_buffer == MAP_FAILED) {
-        perror("Error mapping framebuffer");
-        free(back_buffer);
-        close(fb);
-        return 1;
-    }
-
-    // 扫描目录中的BMP文件
-    DIR *dir;
-    struct dirent *ent;
-    char **bmp_files = NULL;
-    int num_files = 0;
-    int max_files = 1000;  // 假设最多1000个文件
-
-    bmp_files = malloc(max_files * sizeof(char*));
-    if (!bmp_files) {
-        perror("Error allocating memory for file list");
-        free(back_buffer);
-        munmap(front_buffer, framebuffer_size);
-        close(fb);
+    // 选择与屏幕位域匹配的像素转换函数
+    const pixel_format *format = pixel_format_from_vinfo(&vinfo);
+    if (!format) {
+        fb_device_close(&fb);
         return 1;
     }
+    printf("Pixel format: %s\n", format->name);
 
-    dir = opendir(directory);
-    if (dir == NULL) {
-        perror("Error opening directory");
-        printf("Directory: %s\n", directory);
-        free(bmp_files);
-        free(back_buffer);
-        munmap(front_buffer, framebuffer_size);
-        close(fb);
-        return 1;
-    }
-
-    while ((ent = readdir(dir)) != NULL) {
-        if (strstr(ent->d_name, ".bmp") != NULL) {
-            if (num_files >= max_files) {
-                fprintf(stderr, "Too many BMP files in directory\n");
-                break;
-            }
-            bmp_files[num_files] = malloc(strlen(directory) + strlen(ent->d_name) + 2);
-            if (!bmp_files[num_files]) {
-                perror("Error allocating memory for filename");
-                break;
-            }
-            sprintf(bmp_files[num_files], "%s/%s", directory, ent->d_name);
-            num_files++;
-        }
-    }
-    closedir(dir);
-
-    if (num_files == 0) {
-        fprintf(stderr, "No BMP files found in directory\n");
-        for (int i = 0; i < num_files; i++) {
-            free(bmp_files[i]);
-        }
-        free(bmp_files);
-        free(back_buffer);
-        munmap(front_buffer, framebuffer_size);
-        close(fb);
+    // 支持平移时双页翻转，否则只拷贝变化区域
+    fb_presenter presenter;
+    if (fb_presenter_init(&presenter, &fb, format, present_mode) == -1) {
+        fb_presenter_destroy(&presenter);
+        fb_device_close(&fb);
         return 1;
     }
-
-    // 对文件名进行排序
-    qsort(bmp_files, num_files, sizeof(char*), compare_filenames);
-
-    printf("Found %d BMP files\n", num_files);
-
-    // 预计算背景色（黑色）
-    unsigned short black_color = 0;
-    unsigned short* back_buffer_16 = (unsigned short*)back_buffer;
-    for (int i = 0; i < framebuffer_size / 2; i++) {
-        back_buffer_16[i] = black_color;
-    }
+    printf("Present mode: %s\n", fb_presenter_mode_name(&presenter));
+
+    anim_player player;
+    anim_player_init(&player, &presenter, cache);
+    player.clock.policy = clock_policy;
+    player.queue_depth = queue_depth;
+    player.should_stop = check_stop_requested;
+
+    // 不设 SA_RESTART：等待中的 clock_nanosleep 被打断，播放随即结束
+    struct sigaction stop_action;
+    memset(&stop_action, 0, sizeof(stop_action));
+    stop_action.sa_handler = handle_stop_signal;
+    sigemptyset(&stop_action.sa_mask);
+    sigaction(SIGINT, &stop_action, NULL);
+    sigaction(SIGTERM, &stop_action, NULL);
 
     printf("Animation started. Press Ctrl+C to exit...\n");
+    int ret = anim_player_play(&player, directory, delay_ms, loop_once, start_frame);
 
-    // 动画循环
-    do {
-        for (int frame = 0; frame < num_files; frame++) {
-            int img_width, img_height, img_channels;
-            unsigned char* img_data = stbi_load(bmp_files[frame], &img_width, &img_height, &img_channels, 3);
-            
-            if (!img_data) {
-                printf("Error loading image %s: %s\n", bmp_files[frame], stbi_failure_reason());
-                continue;
-            }
-
-            // 计算显示位置（居中）
-            int offset_x = (fb_width - img_width) / 2;
-            int offset_y = (fb_height - img_height) / 2;
-
-            // 在后缓冲上绘制当前帧
-            for (int y = 0; y < img_height; y++) {
-                for (int x = 0; x < img_width; x++) {
-                    int src_pos = (y * img_width + x) * 3;
-                    unsigned char r = img_data[src_pos];
-                    unsigned char g = img_data[src_pos+1];
-                    unsigned char b = img_data[src_pos+2];
-
-                    int fb_x = x + offset_x;
-                    int fb_y = y + offset_y;
-                    
-                    if (fb_x >= 0 && fb_x < fb_width && fb_y >= 0 && fb_y < fb_height) {
-                        int pixel_offset = fb_y * line_length + fb_x * (bpp/8);
-                        if (pixel_offset + 1 < framebuffer_size) {
-                            unsigned short color = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
-                            back_buffer_16[pixel_offset/2] = color;
-                        }
-                    }
-                }
-            }
-
-            // 使用memcpy逐行更新前缓冲，减少画面割裂
-            for (int y = 0; y < fb_height; y++) {
-                memcpy(front_buffer + y * line_length,
-                       back_buffer + y * line_length,
-                       line_length);
-            }
-
-            stbi_image_free(img_data);
-            usleep(delay_ms * 1000);
-        }
-    } while (!loop_once);  // 根据参数决定是否循环
-
-    // 清理资源
-    for (int i = 0; i < num_files; i++) {
-        free(bmp_files[i]);
-    }
-    free(bmp_files);
-    free(back_buffer);
-    munmap(front_buffer, framebuffer_size);
-    close(fb);
-
-    return 0;
-} 
\ No newline at end of file
+    frame_clock_report(&player.clock);
+    fb_presenter_report(&presenter);
+    fb_presenter_destroy(&presenter);
+    fb_device_close(&fb);
+    return ret;
+}
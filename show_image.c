@@ -1,16 +1,15 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <fcntl.h>
-#include <unistd.h>
-#include <sys/mman.h>
-#include <sys/ioctl.h>
-#include <linux/fb.h>
 #include <string.h>
 #include <getopt.h>
 
 // 定义 STB_IMAGE_IMPLEMENTATION 来包含完整的 stb_image 实现
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
+#include "bmp_fast.h"
+#include "pixel_format.h"
+#include "image_scale.h"
+#include "fb_backend.h"
 
 // 旋转类型枚举
 typedef enum {
@@ -28,29 +27,6 @@ void print_usage(const char* program_name) {
     printf("  %s -r 90 image.jpg\n", program_name);
 }
 
-// 根据旋转角度获取目标位置的像素
-void get_rotated_pixel(int x, int y, int width, int height, Rotation rotation,
-                      int *out_x, int *out_y) {
-    switch (rotation) {
-        case ROTATE_90:
-            *out_x = height - 1 - y;
-            *out_y = x;
-            break;
-        case ROTATE_180:
-            *out_x = width - 1 - x;
-            *out_y = height - 1 - y;
-            break;
-        case ROTATE_270:
-            *out_x = y;
-            *out_y = width - 1 - x;
-            break;
-        default: // ROTATE_0
-            *out_x = x;
-            *out_y = y;
-            break;
-    }
-}
-
 int main(int argc, char *argv[]) {
     Rotation rotation = ROTATE_0;
     int opt;
@@ -83,9 +59,23 @@ int main(int argc, char *argv[]) {
 
     const char* image_path = argv[optind];
 
-    // 加载图像
+    // 加载图像：24位未压缩BMP走 mmap 快速路径，其它格式使用 stb_image
+    // 两条路径的结果都用 stbi_image_free 释放（stb 默认使用 malloc/free）
     int img_width, img_height, img_channels;
-    unsigned char *img_data = stbi_load(image_path, &img_width, &img_height, &img_channels, 3);
+    unsigned char *img_data = NULL;
+    bmp_image bmp;
+    if (bmp_fast_open(&bmp, image_path) == 0) {
+        img_width = bmp.width;
+        img_height = bmp.height;
+        img_channels = 3;
+        img_data = malloc((size_t)img_width * img_height * 3);
+        if (img_data) {
+            bmp_fast_to_rgb888(&bmp, img_data);
+        }
+        bmp_fast_close(&bmp);
+    } else {
+        img_data = stbi_load(image_path, &img_width, &img_height, &img_channels, 3);
+    }
     if (!img_data) {
         printf("Error loading image: %s\n", stbi_failure_reason());
         return 1;
@@ -93,36 +83,18 @@ int main(int argc, char *argv[]) {
 
     printf("Image loaded: %dx%d with %d channels\n", img_width, img_height, img_channels);
 
-    // 打开帧缓冲设备
-    int fb = open("/dev/fb0", O_RDWR);
-    if (fb == -1) {
-        perror("Error opening /dev/fb0");
-        stbi_image_free(img_data);
-        return 1;
-    }
-
-    // 获取屏幕信息
-    struct fb_var_screeninfo vinfo;
-    struct fb_fix_screeninfo finfo;
-    
-    if (ioctl(fb, FBIOGET_VSCREENINFO, &vinfo)) {
-        perror("Error reading variable information");
-        close(fb);
-        stbi_image_free(img_data);
-        return 1;
-    }
-    
-    if (ioctl(fb, FBIOGET_FSCREENINFO, &finfo)) {
-        perror("Error reading fixed information");
-        close(fb);
+    // 打开帧缓冲设备（AKU_FB 可指定其它设备或模拟设备）
+    fb_device fb;
+    if (fb_device_open(&fb, NULL) == -1) {
         stbi_image_free(img_data);
         return 1;
     }
+    struct fb_var_screeninfo vinfo = fb.vinfo;
 
     int fb_width = vinfo.xres;
     int fb_height = vinfo.yres;
     int bpp = vinfo.bits_per_pixel;
-    int line_length = finfo.line_length;
+    int line_length = fb.finfo.line_length;
 
     printf("Screen resolution: %dx%d\n", fb_width, fb_height);
     printf("Bits per pixel: %d\n", bpp);
@@ -139,56 +111,61 @@ int main(int argc, char *argv[]) {
     float scale_y = (float)fb_height / target_height;
     float scale = (scale_x < scale_y) ? scale_x : scale_y;
 
+    // 预先计算每个输出行、列的源偏移
+    image_scaler scaler;
+    if (image_scaler_init(&scaler, img_width, img_height, rotation, scale) == -1) {
+        fprintf(stderr, "Error preparing image scaler\n");
+        fb_device_close(&fb);
+        stbi_image_free(img_data);
+        return 1;
+    }
+
     // 计算显示尺寸和偏移量
-    int display_width = (int)(target_width * scale);
-    int display_height = (int)(target_height * scale);
+    int display_width = scaler.dst_width;
+    int display_height = scaler.dst_height;
     int offset_x = (fb_width - display_width) / 2;
     int offset_y = (fb_height - display_height) / 2;
 
-    // 映射帧缓冲到内存
-    size_t framebuffer_size = fb_height * line_length;
-    unsigned char* framebuffer = mmap(NULL, framebuffer_size, PROT_READ | PROT_WRITE, MAP_SHARED, fb, 0);
-    if (framebuffer == MAP_FAILED) {
-        perror("Error mapping framebuffer");
-        close(fb);
+    unsigned char* framebuffer = fb.map;
+
+    // 选择与屏幕位域匹配的像素转换函数
+    const pixel_format *format = pixel_format_from_vinfo(&vinfo);
+    if (!format) {
+        image_scaler_destroy(&scaler);
+        fb_device_close(&fb);
         stbi_image_free(img_data);
         return 1;
     }
 
     // 清空屏幕（设置为黑色背景）
-    memset(framebuffer, 0, framebuffer_size);
+    pixel_format_clear(format, framebuffer, line_length, fb_width, fb_height);
+
+    // 每次采样一个行带到RGB888缓冲，再逐行转换为屏幕像素格式
+    unsigned char *band_buffer = malloc((size_t)display_width * IMAGE_SCALE_TILE * 3);
+    if (!band_buffer) {
+        perror("Error allocating band buffer");
+        image_scaler_destroy(&scaler);
+        fb_device_close(&fb);
+        stbi_image_free(img_data);
+        return 1;
+    }
 
     // 显示图像
-    for (int y = 0; y < display_height; y++) {
-        for (int x = 0; x < display_width; x++) {
-            // 计算源图像中的对应像素位置
-            float src_x = x / scale;
-            float src_y = y / scale;
-
-            // 根据旋转角度获取实际的源像素位置
-            int rotated_x, rotated_y;
-            get_rotated_pixel((int)src_x, (int)src_y, img_width, img_height, rotation,
-                            &rotated_x, &rotated_y);
-
-            // 获取源像素颜色
-            int src_pos = (rotated_y * img_width + rotated_x) * 3;
-            unsigned char r = img_data[src_pos];
-            unsigned char g = img_data[src_pos+1];
-            unsigned char b = img_data[src_pos+2];
+    for (int y0 = 0; y0 < display_height; y0 += IMAGE_SCALE_TILE) {
+        int rows = display_height - y0 < IMAGE_SCALE_TILE ? display_height - y0 : IMAGE_SCALE_TILE;
+        image_scaler_rows(&scaler, img_data, y0, rows, band_buffer);
 
+        for (int y = 0; y < rows; y++) {
             // 计算目标帧缓冲区中的位置
-            int fb_x = x + offset_x;
-            int fb_y = y + offset_y;
-            int pixel_offset = fb_y * line_length + fb_x * (bpp/8);
-
-            // 将24位RGB转换为16位RGB565
-            // R: 5位 (31/255 * r)
-            // G: 6位 (63/255 * g)
-            // B: 5位 (31/255 * b)
-            unsigned short color = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
-            *(unsigned short*)(framebuffer + pixel_offset) = color;
+            int fb_y = y0 + y + offset_y;
+            int pixel_offset = fb_y * line_length + offset_x * format->bytes_per_pixel;
+            format->from_rgb888_row(band_buffer + (size_t)y * display_width * 3,
+                                    framebuffer + pixel_offset, display_width);
         }
     }
+    free(band_buffer);
+    image_scaler_destroy(&scaler);
+    fb_device_present(&fb);
 
     printf("Image displayed successfully! (Rotation: %d degrees)\n", rotation);
     printf("Press Enter to exit...");
@@ -196,8 +173,7 @@ int main(int argc, char *argv[]) {
 
     // 清理资源
     stbi_image_free(img_data);
-    munmap(framebuffer, framebuffer_size);
-    close(fb);
+    fb_device_close(&fb);
 
     return 0;
 } 
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "sysfs.h"
+
+const char *sysfs_root(void) {
+    static const char *root;
+    if (!root) {
+        root = getenv(SYSFS_ROOT_ENV);
+        if (!root || !root[0]) {
+            root = SYSFS_DEFAULT_ROOT;
+        }
+    }
+    return root;
+}
+
+static int attr_reopen(sysfs_attr *attr) {
+    if (attr->fd >= 0) {
+        return 0;
+    }
+    attr->fd = open(attr->path, attr->flags | O_CLOEXEC);
+    if (attr->fd == -1) {
+        if (!attr->warned) {
+            fprintf(stderr, "Error opening %s: %s\n", attr->path, strerror(errno));
+            attr->warned = 1;
+        }
+        return -1;
+    }
+    attr->warned = 0;
+    struct stat st;
+    attr->regular = fstat(attr->fd, &st) == 0 && S_ISREG(st.st_mode);
+    return 0;
+}
+
+int sysfs_attr_open(sysfs_attr *attr, const char *rel, int flags) {
+    attr->fd = -1;
+    attr->flags = flags;
+    attr->warned = 0;
+    snprintf(attr->path, sizeof(attr->path), "%s/%s", sysfs_root(), rel);
+    return attr_reopen(attr);
+}
+
+void sysfs_attr_close(sysfs_attr *attr) {
+    if (attr->fd >= 0) {
+        close(attr->fd);
+        attr->fd = -1;
+    }
+}
+
+ssize_t sysfs_read(sysfs_attr *attr, char *buf, size_t size) {
+    buf[0] = '\0';
+    if (size < 2 || attr_reopen(attr) == -1) {
+        return -1;
+    }
+    // sysfs 每次在偏移0处读取都会重新生成内容
+    ssize_t n = pread(attr->fd, buf, size - 1, 0);
+    if (n < 0) {
+        // 设备被移除等情况：下次访问重新打开
+        sysfs_attr_close(attr);
+        return -1;
+    }
+    while (n > 0 && (buf[n - 1] == '\n' || buf[n - 1] == ' ')) {
+        n--;
+    }
+    buf[n] = '\0';
+    return n;
+}
+
+int sysfs_write(sysfs_attr *attr, const char *value) {
+    if (attr_reopen(attr) == -1) {
+        return -1;
+    }
+    size_t len = strlen(value);
+    // 真实的 sysfs 属性每次写入都是完整的值；普通文件要截掉旧内容，否则 "0" 写在 "255" 上读回 "055"
+    if (pwrite(attr->fd, value, len, 0) != (ssize_t)len ||
+        (attr->regular && ftruncate(attr->fd, len) == -1)) {
+        sysfs_attr_close(attr);
+        return -1;
+    }
+    return 0;
+}
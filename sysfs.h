@@ -0,0 +1,38 @@
+#ifndef SYSFS_H
+#define SYSFS_H
+
+#include <sys/types.h>
+
+// sysfs 属性访问：每个属性只打开一次，之后用 pread/pwrite 在偏移0处读写，
+// 读入调用者的栈缓冲区，不经过 stdio，不分配内存
+// 打开失败（驱动尚未加载等）时下次访问再试；读写出错时关闭，下次访问重新打开
+// 根目录默认为 /sys，可用环境变量 AKU_SYSFS_ROOT 指向一个临时目录树做测试：
+//   mkdir -p /tmp/sys/class/power_supply/axp20x-battery
+//   echo Charging > /tmp/sys/class/power_supply/axp20x-battery/status
+//   AKU_SYSFS_ROOT=/tmp/sys ./sys_boot
+
+#define SYSFS_ROOT_ENV     "AKU_SYSFS_ROOT"
+#define SYSFS_DEFAULT_ROOT "/sys"
+
+typedef struct {
+    char path[256];
+    int fd;                  // -1 表示未打开
+    int flags;               // O_RDONLY 或 O_WRONLY
+    int warned;              // 已打印过打开失败，避免周期性检查重复输出
+    int regular;             // 普通文件（AKU_SYSFS_ROOT 测试目录树），写入后截断到新内容长度
+} sysfs_attr;
+
+// 根目录（第一次调用时读取 AKU_SYSFS_ROOT）
+const char *sysfs_root(void);
+
+// 准备属性 rel（相对根目录，如 "class/leds/aku-logo/brightness"）并尝试打开
+// 打开失败时返回-1，但属性仍可使用（访问时重试）
+int sysfs_attr_open(sysfs_attr *attr, const char *rel, int flags);
+void sysfs_attr_close(sysfs_attr *attr);
+
+// 读取属性内容到 buf（去掉结尾换行，总是以0结尾），返回长度，失败返回-1
+ssize_t sysfs_read(sysfs_attr *attr, char *buf, size_t size);
+// 写入字符串，成功返回0
+int sysfs_write(sysfs_attr *attr, const char *value);
+
+#endif
@@ -1,12 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <fcntl.h>
-#include <unistd.h>
-#include <sys/mman.h>
-#include <sys/ioctl.h>
-#include <linux/fb.h>
 #include <string.h>
 
+#include "fb_backend.h"
+#include "pixel_format.h"
+
 // 颜色结构体
 typedef struct {
     unsigned char red;
@@ -34,34 +32,18 @@ Color get_color_from_name(const char* color_name) {
 }
 
 int main() {
-    // 打开帧缓冲设备
-    int fb = open("/dev/fb0", O_RDWR);
-    if (fb == -1) {
-        perror("Error opening /dev/fb0");
-        return 1;
-    }
-
-    // 获取屏幕信息
-    struct fb_var_screeninfo vinfo;
-    struct fb_fix_screeninfo finfo;
-    
-    if (ioctl(fb, FBIOGET_VSCREENINFO, &vinfo)) {
-        perror("Error reading variable information");
-        close(fb);
-        return 1;
-    }
-    
-    if (ioctl(fb, FBIOGET_FSCREENINFO, &finfo)) {
-        perror("Error reading fixed information");
-        close(fb);
+    // 打开帧缓冲设备（AKU_FB 可指定其它设备或模拟设备）
+    fb_device fb;
+    if (fb_device_open(&fb, NULL) == -1) {
         return 1;
     }
+    struct fb_var_screeninfo vinfo = fb.vinfo;
 
     // 使用实际分辨率
     int fb_width = vinfo.xres;
     int fb_height = vinfo.yres;
     int bpp = vinfo.bits_per_pixel;
-    int line_length = finfo.line_length;
+    int line_length = fb.finfo.line_length;
 
     printf("Screen resolution: %dx%d\n", fb_width, fb_height);
     printf("Bits per pixel: %d\n", bpp);
@@ -69,55 +51,49 @@ int main() {
     printf("Red:   offset=%d, length=%d, msb_right=%d\n", vinfo.red.offset, vinfo.red.length, vinfo.red.msb_right);
     printf("Green: offset=%d, length=%d, msb_right=%d\n", vinfo.green.offset, vinfo.green.length, vinfo.green.msb_right);
     printf("Blue:  offset=%d, length=%d, msb_right=%d\n", vinfo.blue.offset, vinfo.blue.length, vinfo.blue.msb_right);
+    printf("Alpha: offset=%d, length=%d, msb_right=%d\n", vinfo.transp.offset, vinfo.transp.length, vinfo.transp.msb_right);
 
-    // 映射帧缓冲到内存
-    size_t framebuffer_size = fb_height * line_length;
-    unsigned char* framebuffer = mmap(NULL, framebuffer_size, PROT_READ | PROT_WRITE, MAP_SHARED, fb, 0);
-    if (framebuffer == MAP_FAILED) {
-        perror("Error mapping framebuffer");
-        close(fb);
+    unsigned char* framebuffer = fb.map;
+
+    // 选择与屏幕位域匹配的像素格式，同一套测试可用于16/24/32位屏幕
+    const pixel_format *format = pixel_format_from_vinfo(&vinfo);
+    if (!format) {
+        fb_device_close(&fb);
         return 1;
     }
 
     // 清空屏幕（设置为黑色背景）
-    memset(framebuffer, 0, framebuffer_size);
+    pixel_format_clear(format, framebuffer, line_length, fb_width, fb_height);
+    printf("Pixel format: %s\n", format->name);
 
     // 测试红色
     printf("Testing RED...\n");
+    uint32_t color = format->pack(255, 0, 0);
     for (int y = 0; y < 40; y++) {
-        for (int x = 0; x < fb_width; x++) {
-            int pixel_offset = y * line_length + x * (bpp/8);
-            unsigned short color = (0x1F << 11); // R=31, G=0, B=0
-            *(unsigned short*)(framebuffer + pixel_offset) = color;
-        }
+        format->fill_row(framebuffer + y * line_length, color, fb_width);
     }
 
     // 测试绿色
     printf("Testing GREEN...\n");
+    color = format->pack(0, 255, 0);
     for (int y = 40; y < 80; y++) {
-        for (int x = 0; x < fb_width; x++) {
-            int pixel_offset = y * line_length + x * (bpp/8);
-            unsigned short color = (0x3F << 5); // R=0, G=63, B=0
-            *(unsigned short*)(framebuffer + pixel_offset) = color;
-        }
+        format->fill_row(framebuffer + y * line_length, color, fb_width);
     }
 
     // 测试蓝色
     printf("Testing BLUE...\n");
+    color = format->pack(0, 0, 255);
     for (int y = 80; y < 120; y++) {
-        for (int x = 0; x < fb_width; x++) {
-            int pixel_offset = y * line_length + x * (bpp/8);
-            unsigned short color = 0x1F; // R=0, G=0, B=31
-            *(unsigned short*)(framebuffer + pixel_offset) = color;
-        }
+        format->fill_row(framebuffer + y * line_length, color, fb_width);
     }
 
+    fb_device_present(&fb);
+
     printf("Color test completed. Press Enter to exit...");
     getchar();
 
     // 清理资源
-    munmap(framebuffer, framebuffer_size);
-    close(fb);
+    fb_device_close(&fb);
 
     return 0;
 } 
\ No newline at end of file
@@ -0,0 +1,310 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "text_layout.h"
+#include "fnv_hash.h"
+
+static int is_space(uint32_t cp) {
+    return cp == ' ' || cp == '\t' || cp == 0x3000;
+}
+
+// 中日韩文字和全角符号：任意两字之间都可以断行
+static int is_cjk(uint32_t cp) {
+    return (cp >= 0x1100 && cp <= 0x11ff) ||    // 谚文字母
+           (cp >= 0x2e80 && cp <= 0x9fff) ||    // 部首、标点、假名、汉字
+           (cp >= 0xac00 && cp <= 0xd7af) ||    // 谚文音节
+           (cp >= 0xf900 && cp <= 0xfaff) ||    // 兼容汉字
+           (cp >= 0xff00 && cp <= 0xffef) ||    // 全角字符
+           (cp >= 0x20000 && cp <= 0x3ffff);    // 扩展汉字
+}
+
+// 不能放在行首的字符：句末标点、闭括号
+static int no_line_start(uint32_t cp) {
+    if (cp < 0x80) {
+        return cp && strchr(",.;:!?)]}%", (int)cp) != NULL;
+    }
+    static const uint32_t closing[] = {
+        0x2019, 0x201d, 0x2026, 0x3001, 0x3002, 0x3009, 0x300b, 0x300d, 0x300f, 0x3011,
+        0x3015, 0x3017, 0x30fc, 0xff01, 0xff09, 0xff0c, 0xff0e, 0xff1a, 0xff1b, 0xff1f,
+        0xff3d, 0xff5d,
+    };
+    for (size_t i = 0; i < sizeof(closing) / sizeof(closing[0]); i++) {
+        if (cp == closing[i]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 不能放在行尾的字符：开括号、前引号
+static int no_line_end(uint32_t cp) {
+    if (cp < 0x80) {
+        return cp && strchr("([{", (int)cp) != NULL;
+    }
+    static const uint32_t opening[] = {
+        0x2018, 0x201c, 0x3008, 0x300a, 0x300c, 0x300e, 0x3010, 0x3014, 0x3016, 0xff08,
+        0xff3b, 0xff5b,
+    };
+    for (size_t i = 0; i < sizeof(opening) / sizeof(opening[0]); i++) {
+        if (cp == opening[i]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// a 和 b 之间能否断行（空格留在上一行末尾，在空格之后断开）
+static int can_break(uint32_t a, uint32_t b) {
+    if (is_space(b)) {
+        return 0;
+    }
+    if (is_space(a)) {
+        return 1;
+    }
+    if (no_line_start(b) || no_line_end(a)) {
+        return 0;
+    }
+    return a == '-' || is_cjk(a) || is_cjk(b);
+}
+
+static int reserve(void **array, uint32_t *capacity, uint32_t count, size_t item) {
+    if (count <= *capacity) {
+        return 0;
+    }
+    uint32_t size = *capacity ? *capacity : 64;
+    while (size < count) {
+        size *= 2;
+    }
+    void *grown = realloc(*array, size * item);
+    if (!grown) {
+        return -1;
+    }
+    *array = grown;
+    *capacity = size;
+    return 0;
+}
+
+void text_layout_cache_init(text_layout_cache *cache) {
+    memset(cache, 0, sizeof(*cache));
+}
+
+void text_layout_cache_destroy(text_layout_cache *cache) {
+    for (int i = 0; i < TEXT_LAYOUT_CACHE_SIZE; i++) {
+        free(cache->entries[i].text);
+        free(cache->entries[i].glyphs);
+    }
+    free(cache->chars);
+    free(cache->lines);
+    memset(cache, 0, sizeof(*cache));
+}
+
+// 解码文字，取得每个字符的 advance 和与前一个字符之间的字距；返回字符数，失败返回-1
+static long decode(text_layout_cache *cache, glyph_cache *glyphs, const char *text, size_t len,
+                   int size) {
+    const unsigned char *s = (const unsigned char *)text;
+    const unsigned char *end = s + len;
+    uint32_t count = 0;
+    while (s < end) {
+        int32_t cp = utf8_next(&s, end);
+        if (cp < 0) {
+            cp = 0xfffd;  // 非法序列显示为替换字符
+        }
+        if (cp == '\r' || (cp < 0x20 && cp != '\n' && cp != '\t')) {
+            continue;
+        }
+        if (reserve((void **)&cache->chars, &cache->char_capacity, count + 1,
+                    sizeof(text_layout_char)) == -1) {
+            return -1;
+        }
+        text_layout_char *c = &cache->chars[count];
+        c->codepoint = cp;
+        c->advance = 0;
+        c->kern = 0;
+        if (cp != '\n') {
+            // 只用缓存的 advance 测量，字形第一次出现时光栅化并缓存
+            const glyph *g = glyph_cache_get(glyphs, cp == '\t' ? ' ' : cp, size);
+            if (!g) {
+                return -1;
+            }
+            c->advance = g->advance;
+            if (count > 0 && !is_space(cp)) {
+                uint32_t prev = cache->chars[count - 1].codepoint;
+                if (prev != '\n' && !is_space(prev)) {
+                    c->kern = glyph_cache_kerning(glyphs, prev, cp, size);
+                }
+            }
+        }
+        count++;
+    }
+    return count;
+}
+
+// 从 start 开始排出一行（不超过段落末尾 para_end）：超出 box_width 时在最后一个断行点断开，
+// 没有断行点时按字符断开；返回行尾，*visible 为不含行尾空格的宽度
+static uint32_t fit_line(const text_layout_char *chars, uint32_t start, uint32_t para_end,
+                         int box_width, int *visible) {
+    uint32_t brk = start;
+    int width = 0;
+    int width_at_brk = 0;
+    *visible = 0;
+    for (uint32_t i = start; i < para_end; i++) {
+        uint32_t cp = chars[i].codepoint;
+        if (i > start && can_break(chars[i - 1].codepoint, cp)) {
+            brk = i;
+            width_at_brk = *visible;
+        }
+        int step = (i > start ? chars[i].kern : 0) + chars[i].advance;
+        if (!is_space(cp) && i > start && width + step > box_width) {
+            if (brk > start) {
+                *visible = width_at_brk;
+                return brk;
+            }
+            return i;
+        }
+        width += step;
+        if (!is_space(cp)) {
+            *visible = width;
+        }
+    }
+    return para_end;
+}
+
+// 按换行符分段，每段按区域宽度分成若干行；空段是一个空行
+static int break_lines(text_layout_cache *cache, uint32_t count, int box_width, uint32_t *line_count) {
+    const text_layout_char *chars = cache->chars;
+    uint32_t lines = 0;
+    uint32_t i = 0;
+    for (;;) {
+        uint32_t para_end = i;
+        while (para_end < count && chars[para_end].codepoint != '\n') {
+            para_end++;
+        }
+        uint32_t start = i;
+        do {
+            int width;
+            uint32_t end = fit_line(chars, start, para_end, box_width, &width);
+            if (reserve((void **)&cache->lines, &cache->line_capacity, lines + 1,
+                        sizeof(text_layout_line)) == -1) {
+                return -1;
+            }
+            cache->lines[lines++] = (text_layout_line){start, end, width};
+            // 自动换行后的行首空格去掉
+            start = end;
+            while (start < para_end && is_space(chars[start].codepoint)) {
+                start++;
+            }
+        } while (start < para_end);
+        if (para_end == count) {
+            break;
+        }
+        i = para_end + 1;
+    }
+    *line_count = lines;
+    return 0;
+}
+
+// 排版并把结果写入 layout（键已填好）
+static int build(text_layout_cache *cache, glyph_cache *glyphs, text_layout *layout) {
+    long count = decode(cache, glyphs, layout->text, layout->text_len, layout->size);
+    uint32_t line_count;
+    if (count == -1 || break_lines(cache, count, layout->box_width, &line_count) == -1) {
+        return -1;
+    }
+
+    int font_size = layout->size;
+    int line_height = font_size + 2;
+    int total_height = line_count * line_height;
+    int y;
+    switch (layout->v_align) {
+        case ALIGN_MIDDLE:
+            // 考虑第一个字符的bitmap_top和顶部font_size偏移，确保文字垂直居中
+            y = (layout->box_height - total_height) / 2 + font_size / 2;
+            break;
+        case ALIGN_BOTTOM:
+            y = layout->box_height - total_height;
+            break;
+        default:
+            y = font_size;  // 顶部对齐时从y=font_size开始
+            break;
+    }
+
+    layout->count = 0;
+    layout->lines = line_count;
+    layout->width = 0;
+    for (uint32_t l = 0; l < line_count; l++, y += line_height) {
+        const text_layout_line *line = &cache->lines[l];
+        if (line->width > layout->width) {
+            layout->width = line->width;
+        }
+        // 整行都在区域下方时不再产生字形；部分可见的行照常排出，绘制时裁剪
+        if (y - font_size >= layout->box_height) {
+            continue;
+        }
+        int x = 0;
+        if (layout->h_align == ALIGN_CENTER) {
+            x = (layout->box_width - line->width) / 2;
+        } else if (layout->h_align == ALIGN_RIGHT) {
+            x = layout->box_width - line->width;
+        }
+        if (reserve((void **)&layout->glyphs, &layout->capacity,
+                    layout->count + (line->end - line->start), sizeof(text_glyph_pos)) == -1) {
+            return -1;
+        }
+        for (uint32_t i = line->start; i < line->end; i++) {
+            const text_layout_char *c = &cache->chars[i];
+            if (i > line->start) {
+                x += c->kern;
+            }
+            if (!is_space(c->codepoint)) {
+                layout->glyphs[layout->count++] = (text_glyph_pos){c->codepoint, x, y};
+            }
+            x += c->advance;
+        }
+    }
+    return 0;
+}
+
+const text_layout *text_layout_get(text_layout_cache *cache, glyph_cache *glyphs,
+                                   const char *text, size_t len, int size,
+                                   int h_align, int v_align, int box_width, int box_height) {
+    int key[5] = {size, h_align, v_align, box_width, box_height};
+    uint64_t hash = fnv_hash(fnv_hash(FNV_HASH_INIT, key, sizeof(key)), text, len);
+
+    text_layout *victim = &cache->entries[0];
+    for (int i = 0; i < TEXT_LAYOUT_CACHE_SIZE; i++) {
+        text_layout *e = &cache->entries[i];
+        if (e->last_used && e->hash == hash && e->text_len == len && e->size == size &&
+            e->h_align == h_align && e->v_align == v_align && e->box_width == box_width &&
+            e->box_height == box_height && memcmp(e->text, text, len) == 0) {
+            e->last_used = ++cache->clock;
+            cache->hits++;
+            return e;
+        }
+        if (e->last_used < victim->last_used) {
+            victim = e;
+        }
+    }
+
+    // 替换最久未用的条目，复用它的内存
+    cache->misses++;
+    victim->last_used = 0;
+    char *copy = realloc(victim->text, len + 1);
+    if (!copy) {
+        return NULL;
+    }
+    memcpy(copy, text, len);
+    copy[len] = '\0';
+    victim->text = copy;
+    victim->text_len = len;
+    victim->hash = hash;
+    victim->size = size;
+    victim->h_align = h_align;
+    victim->v_align = v_align;
+    victim->box_width = box_width;
+    victim->box_height = box_height;
+    if (build(cache, glyphs, victim) == -1) {
+        return NULL;
+    }
+    victim->last_used = ++cache->clock;
+    return victim;
+}
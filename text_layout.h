@@ -0,0 +1,111 @@
+#ifndef TEXT_LAYOUT_H
+#define TEXT_LAYOUT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "glyph_cache.h"
+
+// 文字排版：直接解码 UTF-8，按字形缓存中的 advance 加上字距调整排出每个字形的笔位置
+// 断行按区域宽度精确计算，所有对齐方式都会自动换行：
+//   拉丁文在空格和连字符之后断开，中日韩文字任意两字之间都可以断开；
+//   句末标点和闭括号不放在行首，开括号不放在行尾；一个词比整行还宽时按字符断开
+// 每行单独按水平对齐方式放置（行尾空格不计宽度），行高和垂直对齐与原来的 show_text 相同
+// 排版结果（字形位置）按 (文字, 大小, 对齐, 区域大小) 缓存，同一标签再次绘制时只需查表，不再排版
+// 文字长度不受限制
+
+#define TEXT_LAYOUT_CACHE_SIZE 16
+
+// 对齐方式
+#define ALIGN_LEFT   0
+#define ALIGN_CENTER 1
+#define ALIGN_RIGHT  2
+#define ALIGN_TOP    0
+#define ALIGN_MIDDLE 1
+#define ALIGN_BOTTOM 2
+
+// 一个字形的位置：笔位置（基线原点），相对区域左上角；空格和换行不产生字形
+typedef struct {
+    uint32_t codepoint;
+    int16_t x;
+    int16_t y;
+} text_glyph_pos;
+
+typedef struct {
+    // 键
+    uint64_t hash;
+    char *text;
+    size_t text_len;
+    int size;
+    int h_align;
+    int v_align;
+    int box_width;
+    int box_height;
+    // 结果
+    text_glyph_pos *glyphs;
+    uint32_t count;
+    uint32_t capacity;
+    int lines;               // 排出的行数（含区域下方放不下的行）
+    int width;               // 最宽一行的宽度
+    uint64_t last_used;      // 0 表示空条目
+} text_layout;
+
+// 排版过程中的临时数组，在条目之间复用
+typedef struct {
+    uint32_t codepoint;
+    int16_t advance;
+    int16_t kern;            // 与前一个字符之间的字距调整，行首不计
+} text_layout_char;
+
+typedef struct {
+    uint32_t start;
+    uint32_t end;
+    int width;
+} text_layout_line;
+
+typedef struct {
+    text_layout entries[TEXT_LAYOUT_CACHE_SIZE];
+    uint64_t clock;
+    text_layout_char *chars;
+    uint32_t char_capacity;
+    text_layout_line *lines;
+    uint32_t line_capacity;
+    // 统计
+    uint64_t hits;
+    uint64_t misses;
+} text_layout_cache;
+
+void text_layout_cache_init(text_layout_cache *cache);
+void text_layout_cache_destroy(text_layout_cache *cache);
+
+// 取得 text（len 字节）的排版结果，未缓存时排版并替换最久未用的条目
+// 返回的指针在下一次调用前有效，内存不足时返回 NULL
+const text_layout *text_layout_get(text_layout_cache *cache, glyph_cache *glyphs,
+                                   const char *text, size_t len, int size,
+                                   int h_align, int v_align, int box_width, int box_height);
+
+// 解码 *s 处的一个 UTF-8 字符并前进；非法或截断的序列只前进一个字节，返回-1
+static inline int32_t utf8_next(const unsigned char **s, const unsigned char *end) {
+    const unsigned char *p = *s;
+    uint32_t cp = *p;
+    int extra = cp < 0x80 ? 0 : (cp & 0xe0) == 0xc0 ? 1 : (cp & 0xf0) == 0xe0 ? 2 :
+                (cp & 0xf8) == 0xf0 ? 3 : -1;
+    *s = p + 1;
+    if (extra == 0) {
+        return cp;
+    }
+    if (extra < 0 || end - p <= extra) {
+        return -1;
+    }
+    cp &= 0x3f >> extra;
+    for (int k = 1; k <= extra; k++) {
+        if ((p[k] & 0xc0) != 0x80) {
+            return -1;
+        }
+        cp = (cp << 6) | (p[k] & 0x3f);
+    }
+    *s = p + extra + 1;
+    return cp;
+}
+
+#endif
@@ -0,0 +1,166 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "text_render.h"
+
+// 初始化FreeType，失败时返回 NULL；像素大小由字形缓存按需设置
+static FT_Face ft_init(text_renderer *r) {
+    if (FT_Init_FreeType(&r->library)) {
+        fprintf(stderr, "Could not initialize FreeType library\n");
+        return NULL;
+    }
+    if (FT_New_Face(r->library, r->font_path, 0, &r->face)) {
+        fprintf(stderr, "Could not open font file: %s\n", r->font_path);
+        FT_Done_FreeType(r->library);
+        r->face = NULL;
+        return NULL;
+    }
+    return r->face;
+}
+
+// 字形缓存的延迟加载：图集中缺少字形时才初始化 FreeType
+static FT_Face load_font(void *arg) {
+    return ft_init(arg);
+}
+
+int text_renderer_open(text_renderer *r) {
+    memset(r, 0, sizeof(*r));
+
+    // AKU_FB 可指定其它设备或模拟设备
+    if (fb_device_open(&r->fb, NULL) == -1) {
+        return -1;
+    }
+    r->format = pixel_format_from_vinfo(&r->fb.vinfo);
+    if (!r->format) {
+        fb_device_close(&r->fb);
+        return -1;
+    }
+    r->screen = (glyph_target){r->fb.map, r->fb.finfo.line_length,
+                               r->fb.vinfo.xres, r->fb.vinfo.yres, r->format};
+
+    // 字体（AKU_FONT 可覆盖字体路径，用于没有设备字体的环境）
+    // 有图集时 FreeType 只在缺字时加载
+    const char *font_path = getenv("AKU_FONT");
+    if (!font_path || !font_path[0]) {
+        font_path = TEXT_RENDER_DEFAULT_FONT;
+    }
+    snprintf(r->font_path, sizeof(r->font_path), "%s", font_path);
+
+    char atlas_path[512];
+    const char *atlas_env = getenv("AKU_FONT_ATLAS");
+    if (atlas_env && atlas_env[0]) {
+        snprintf(atlas_path, sizeof(atlas_path), "%s", atlas_env);
+    } else {
+        snprintf(atlas_path, sizeof(atlas_path), "%s", font_path);
+        char *dot = strrchr(atlas_path, '.');
+        if (dot && !strchr(dot, '/')) {
+            *dot = '\0';
+        }
+        strncat(atlas_path, FONT_ATLAS_EXT, sizeof(atlas_path) - strlen(atlas_path) - 1);
+    }
+    r->atlas_ready = font_atlas_open(&r->atlas, atlas_path) == 0;
+    if (!r->atlas_ready && !ft_init(r)) {
+        fb_device_close(&r->fb);
+        return -1;
+    }
+    text_layout_cache_init(&r->layouts);
+    if (glyph_cache_init(&r->glyphs, r->face) == -1) {
+        fprintf(stderr, "Could not allocate glyph cache\n");
+        text_renderer_close(r);
+        return -1;
+    }
+    if (r->atlas_ready) {
+        glyph_cache_set_atlas(&r->glyphs, &r->atlas);
+        glyph_cache_set_face_loader(&r->glyphs, load_font, r);
+    }
+    return 0;
+}
+
+void text_renderer_close(text_renderer *r) {
+    text_layout_cache_destroy(&r->layouts);
+    glyph_cache_destroy(&r->glyphs);
+    if (r->face) {
+        FT_Done_Face(r->face);
+        FT_Done_FreeType(r->library);
+        r->face = NULL;
+    }
+    if (r->atlas_ready) {
+        font_atlas_close(&r->atlas);
+        r->atlas_ready = 0;
+    }
+    fb_device_close(&r->fb);
+}
+
+int text_renderer_clip(const text_renderer *r, const text_region *region, text_region *clipped) {
+    int x0 = 0, y0 = 0;
+    int x1 = r->screen.width, y1 = r->screen.height;
+    if (region && region->width > 0 && region->height > 0) {
+        x0 = region->x > 0 ? region->x : 0;
+        y0 = region->y > 0 ? region->y : 0;
+        if (region->x + region->width < x1) {
+            x1 = region->x + region->width;
+        }
+        if (region->y + region->height < y1) {
+            y1 = region->y + region->height;
+        }
+    }
+    if (x0 >= x1 || y0 >= y1) {
+        return -1;
+    }
+    *clipped = (text_region){x0, y0, x1 - x0, y1 - y0};
+    return 0;
+}
+
+void text_renderer_clear(text_renderer *r, const text_region *region) {
+    text_region area;
+    if (text_renderer_clip(r, region, &area) == -1) {
+        return;
+    }
+    pixel_format_clear(r->format, r->screen.base + (long)area.y * r->screen.line_length +
+                       (long)area.x * r->format->bytes_per_pixel,
+                       r->screen.line_length, area.width, area.height);
+}
+
+// 绘制一个字符（已缓存的字形）：按覆盖度抗锯齿混合，color 已转换为屏幕像素格式
+// 超出目标区域的部分在 glyph_blit 中一次裁掉
+static void draw_char(text_renderer *r, const glyph_target *target, int x, int y,
+                      const glyph *g, uint32_t color) {
+    glyph_blit(target, x + g->left, y - g->top, glyph_bitmap(&r->glyphs, g),
+               g->width, g->rows, g->width, color);
+}
+
+void text_renderer_draw(text_renderer *r, const char *text, int font_size, uint16_t color,
+                        int h_align, int v_align, const text_region *region) {
+    text_region area;
+    if (text_renderer_clip(r, region, &area) == -1) {
+        return;
+    }
+    const text_layout *layout = text_layout_get(&r->layouts, &r->glyphs, text, strlen(text),
+                                                font_size, h_align, v_align, area.width, area.height);
+    if (!layout) {
+        fprintf(stderr, "Could not lay out text\n");
+        return;
+    }
+
+    // 区域作为一个独立的绘制目标，字形在区域边界处裁剪
+    glyph_target target = r->screen;
+    target.base += (long)area.y * target.line_length + (long)area.x * r->format->bytes_per_pixel;
+    target.width = area.width;
+    target.height = area.height;
+
+    // 颜色参数为RGB565，按屏幕像素格式转换一次
+    uint32_t pixel = pixel_format_from_rgb565(r->format, color);
+    for (uint32_t i = 0; i < layout->count; i++) {
+        const text_glyph_pos *pos = &layout->glyphs[i];
+        const glyph *g = glyph_cache_get(&r->glyphs, pos->codepoint, font_size);
+        if (!g) {
+            break;
+        }
+        draw_char(r, &target, pos->x, pos->y, g, pixel);
+    }
+}
+
+void text_renderer_present(text_renderer *r) {
+    fb_device_present(&r->fb);
+}
@@ -0,0 +1,57 @@
+#ifndef TEXT_RENDER_H
+#define TEXT_RENDER_H
+
+#include <stdint.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include "fb_backend.h"
+#include "pixel_format.h"
+#include "glyph_cache.h"
+#include "font_atlas.h"
+#include "glyph_blit.h"
+#include "text_layout.h"
+
+// 文字渲染：帧缓冲、字体（图集 + 延迟加载的 FreeType）和字形缓存
+// show_text 每次启动都打开一个；text_server 长期持有一个，字体和字形缓存一直保持加载
+// 字体由 AKU_FONT 指定（默认设备字体），图集默认是字体旁边的同名 .akf 文件，AKU_FONT_ATLAS 可覆盖
+
+#define TEXT_RENDER_DEFAULT_FONT "/home/aku/xiaozhi/font/HarmonyOS_Sans_SC_Regular.ttf"
+
+// 屏幕上的矩形区域，width 或 height 为0表示整个屏幕
+typedef struct {
+    int x;
+    int y;
+    int width;
+    int height;
+} text_region;
+
+typedef struct {
+    fb_device fb;
+    const pixel_format *format;
+    glyph_target screen;     // 整个帧缓冲
+    FT_Library library;
+    FT_Face face;            // 图集缺字时才加载
+    glyph_cache glyphs;
+    text_layout_cache layouts;  // 最近绘制的标签的排版结果
+    font_atlas atlas;
+    int atlas_ready;
+    char font_path[256];
+} text_renderer;
+
+// 打开帧缓冲（AKU_FB）和字体，失败时打印原因并返回-1
+int text_renderer_open(text_renderer *r);
+void text_renderer_close(text_renderer *r);
+
+// 把区域裁剪到屏幕内；区域完全在屏幕外时返回-1
+int text_renderer_clip(const text_renderer *r, const text_region *region, text_region *clipped);
+// 清除区域（填黑）
+void text_renderer_clear(text_renderer *r, const text_region *region);
+// 在区域内按对齐方式绘制 UTF-8 文字（长度不限），color 为 RGB565；按区域宽度自动换行，
+// 超出区域的部分裁掉；同一段文字在同一区域再次绘制时直接使用缓存的排版结果
+void text_renderer_draw(text_renderer *r, const char *text, int font_size, uint16_t color,
+                        int h_align, int v_align, const text_region *region);
+// 一帧绘制完成（模拟设备按 AKU_FB_DUMP 保存画面）
+void text_renderer_present(text_renderer *r);
+
+#endif
@@ -0,0 +1,302 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <locale.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "event_loop.h"
+#include "text_render.h"
+#include "text_service.h"
+
+// 文字服务：启动时打开帧缓冲和字体并预热常用字形，之后一直保持加载
+// 绘制请求通过 Unix 套接字到达（协议见 text_service.h），在事件循环中依次绘制并应答，
+// 省去了每段文字都启动 show_text、重新加载 FreeType 和字体的开销
+// 请求带显示时长时，到时由定时器清除该区域；新文字完全覆盖该区域时取消清除
+
+#define TEXT_SERVER_MAX_CLIENTS 8
+#define TEXT_SERVER_MAX_CLEARS  4
+#define TEXT_SERVER_BACKLOG     8
+
+static text_renderer renderer;
+static event_loop loop;
+static int listen_fd = -1;
+static char socket_path[108];
+static int clients[TEXT_SERVER_MAX_CLIENTS];
+
+// 等待清除的区域（带显示时长的文字）
+static struct {
+    int timer;
+    int active;
+    text_region region;      // 已裁剪到屏幕内
+    uint64_t deadline_ns;
+} clears[TEXT_SERVER_MAX_CLEARS];
+
+// 统计
+static uint64_t request_count;
+static uint64_t error_count;
+static uint64_t render_ns_total;
+static uint64_t render_ns_max;
+
+static int region_contains(const text_region *outer, const text_region *inner) {
+    return inner->x >= outer->x && inner->y >= outer->y &&
+           inner->x + inner->width <= outer->x + outer->width &&
+           inner->y + inner->height <= outer->y + outer->height;
+}
+
+static void on_clear_timer(void *arg) {
+    int i = (int)(long)arg;
+    clears[i].active = 0;
+    text_renderer_clear(&renderer, &clears[i].region);
+    text_renderer_present(&renderer);
+}
+
+// 新文字画在 area 上：被完全覆盖的区域不再需要到时清除
+// 只覆盖一部分时保留定时器，否则露在 area 外的旧文字会一直留在屏幕上
+static void cancel_clears(const text_region *area) {
+    for (int i = 0; i < TEXT_SERVER_MAX_CLEARS; i++) {
+        if (clears[i].active && region_contains(area, &clears[i].region)) {
+            clears[i].active = 0;
+            event_loop_timer_cancel(&loop, clears[i].timer);
+        }
+    }
+}
+
+// 登记到时清除；没有空位时先清除最早到期的那个
+static void schedule_clear(const text_region *area, uint32_t timeout_ms) {
+    int slot = -1;
+    for (int i = 0; i < TEXT_SERVER_MAX_CLEARS; i++) {
+        if (!clears[i].active) {
+            slot = i;
+            break;
+        }
+        if (slot == -1 || clears[i].deadline_ns < clears[slot].deadline_ns) {
+            slot = i;
+        }
+    }
+    if (clears[slot].active) {
+        event_loop_timer_cancel(&loop, clears[slot].timer);
+        on_clear_timer((void *)(long)slot);
+    }
+    clears[slot].active = 1;
+    clears[slot].region = *area;
+    clears[slot].deadline_ns = event_loop_now_ns() + (uint64_t)timeout_ms * 1000000;
+    event_loop_timer_at(&loop, clears[slot].timer, clears[slot].deadline_ns);
+}
+
+// 处理一条请求，返回0或-errno
+static int handle_request(text_request *req, size_t len) {
+    if (len < TEXT_REQUEST_HEADER_SIZE || req->magic != TEXT_SERVICE_MAGIC) {
+        return -EPROTO;
+    }
+    if (req->size < 8 || req->size > 72 || req->h_align > 2 || req->v_align > 2) {
+        return -EINVAL;
+    }
+    // 文字不含结尾0，消息正好装满时截掉最后一个字节
+    size_t text_len = len - TEXT_REQUEST_HEADER_SIZE;
+    if (text_len >= TEXT_SERVICE_MAX_TEXT) {
+        text_len = TEXT_SERVICE_MAX_TEXT - 1;
+    }
+    req->text[text_len] = '\0';
+
+    text_region region = {req->x, req->y, req->width, req->height};
+    text_region area;
+    if (text_renderer_clip(&renderer, &region, &area) == -1) {
+        return -EINVAL;
+    }
+
+    cancel_clears(&area);
+    if (!(req->flags & TEXT_NO_CLEAR)) {
+        text_renderer_clear(&renderer, &area);
+    }
+    text_renderer_draw(&renderer, req->text, req->size, req->color, req->h_align, req->v_align, &area);
+    text_renderer_present(&renderer);
+    if (req->timeout_ms > 0) {
+        schedule_clear(&area, req->timeout_ms);
+    }
+    return 0;
+}
+
+static void drop_client(int slot) {
+    event_loop_remove_fd(&loop, clients[slot]);
+    close(clients[slot]);
+    clients[slot] = -1;
+}
+
+static void on_client(void *arg, int fd, uint32_t events) {
+    int slot = (int)(long)arg;
+    static text_request req;
+
+    for (;;) {
+        ssize_t n = recv(fd, &req, sizeof(req), 0);
+        if (n == -1 && errno == EAGAIN) {
+            break;
+        }
+        if (n <= 0) {
+            drop_client(slot);
+            return;
+        }
+
+        uint64_t start = event_loop_now_ns();
+        int status = handle_request(&req, n);
+        uint64_t elapsed = event_loop_now_ns() - start;
+        request_count++;
+        if (status != 0) {
+            error_count++;
+        }
+        render_ns_total += elapsed;
+        if (elapsed > render_ns_max) {
+            render_ns_max = elapsed;
+        }
+
+        // 应答很小，发送缓冲区满说明客户端不读应答，直接丢弃这条应答
+        text_reply reply = {req.magic == TEXT_SERVICE_MAGIC ? req.seq : 0, status, elapsed / 1000};
+        if (send(fd, &reply, sizeof(reply), MSG_NOSIGNAL | MSG_DONTWAIT) == -1 && errno != EAGAIN) {
+            drop_client(slot);
+            return;
+        }
+    }
+    if (events & (EPOLLHUP | EPOLLERR)) {
+        drop_client(slot);
+    }
+}
+
+static void on_accept(void *arg, int fd, uint32_t events) {
+    (void)arg;
+    (void)events;
+    for (;;) {
+        int client = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client == -1) {
+            if (errno != EAGAIN && errno != EINTR) {
+                perror("Error accepting text client");
+            }
+            return;
+        }
+        int slot = -1;
+        for (int i = 0; i < TEXT_SERVER_MAX_CLIENTS; i++) {
+            if (clients[i] == -1) {
+                slot = i;
+                break;
+            }
+        }
+        // 连接已满：关闭，客户端读应答时得到 ECONNRESET，由它自己处理（show_text 改为本地绘制）
+        if (slot == -1 ||
+            event_loop_add_fd(&loop, client, EPOLLIN, on_client, (void *)(long)slot) == -1) {
+            fprintf(stderr, "Too many text clients\n");
+            close(client);
+            continue;
+        }
+        clients[slot] = client;
+    }
+}
+
+static void on_signal(void *arg, int fd, uint32_t events) {
+    (void)arg;
+    (void)events;
+    struct signalfd_siginfo info;
+    if (read(fd, &info, sizeof(info)) == sizeof(info)) {
+        loop.stop = 1;
+    }
+}
+
+static int open_socket(void) {
+    const char *path = text_service_path();
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Text service socket path too long: %s\n", path);
+        return -1;
+    }
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+
+    listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd == -1) {
+        perror("Error creating text service socket");
+        return -1;
+    }
+    // 上次异常退出留下的套接字文件
+    unlink(path);
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 ||
+        listen(listen_fd, TEXT_SERVER_BACKLOG) == -1) {
+        fprintf(stderr, "Error binding %s: %s\n", path, strerror(errno));
+        close(listen_fd);
+        listen_fd = -1;
+        return -1;
+    }
+    snprintf(socket_path, sizeof(socket_path), "%s", path);
+    return 0;
+}
+
+int main(void) {
+    // 设置locale以支持中文
+    setlocale(LC_ALL, "C.UTF-8");
+
+    // SIGINT/SIGTERM 通过 signalfd 送到事件循环，退出时删除套接字文件
+    sigset_t quit_signals;
+    sigemptyset(&quit_signals);
+    sigaddset(&quit_signals, SIGINT);
+    sigaddset(&quit_signals, SIGTERM);
+    sigprocmask(SIG_BLOCK, &quit_signals, NULL);
+    int signal_fd = signalfd(-1, &quit_signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signal_fd == -1) {
+        perror("signalfd");
+        return 1;
+    }
+
+    if (text_renderer_open(&renderer) == -1) {
+        return 1;
+    }
+    // 预热：默认大小的可打印 ASCII 先放进缓存，第一段文字也不必光栅化
+    for (uint32_t cp = 0x20; cp < 0x7f; cp++) {
+        glyph_cache_get(&renderer.glyphs, cp, 24);
+    }
+
+    if (event_loop_init(&loop) == -1) {
+        text_renderer_close(&renderer);
+        return 1;
+    }
+    for (int i = 0; i < TEXT_SERVER_MAX_CLIENTS; i++) {
+        clients[i] = -1;
+    }
+    for (int i = 0; i < TEXT_SERVER_MAX_CLEARS; i++) {
+        clears[i].timer = event_loop_add_timer(&loop, on_clear_timer, (void *)(long)i);
+    }
+    if (open_socket() == -1 ||
+        event_loop_add_fd(&loop, listen_fd, EPOLLIN, on_accept, NULL) == -1 ||
+        event_loop_add_fd(&loop, signal_fd, EPOLLIN, on_signal, NULL) == -1) {
+        event_loop_destroy(&loop);
+        text_renderer_close(&renderer);
+        return 1;
+    }
+    printf("Text service listening on %s\n", socket_path);
+    fflush(stdout);
+
+    event_loop_run(&loop);
+
+    printf("Requests: %llu (%llu failed), render avg %.1f us, max %.1f us\n",
+           (unsigned long long)request_count, (unsigned long long)error_count,
+           request_count ? render_ns_total / 1000.0 / request_count : 0.0, render_ns_max / 1000.0);
+    printf("Glyph cache: %llu hits, %llu misses, %llu from atlas\n",
+           (unsigned long long)renderer.glyphs.hits, (unsigned long long)renderer.glyphs.misses,
+           (unsigned long long)renderer.glyphs.atlas_hits);
+    printf("Layouts: %llu cached, %llu laid out\n", (unsigned long long)renderer.layouts.hits,
+           (unsigned long long)renderer.layouts.misses);
+
+    for (int i = 0; i < TEXT_SERVER_MAX_CLIENTS; i++) {
+        if (clients[i] != -1) {
+            drop_client(i);
+        }
+    }
+    event_loop_remove_fd(&loop, listen_fd);
+    close(listen_fd);
+    unlink(socket_path);
+    close(signal_fd);
+    event_loop_destroy(&loop);
+    text_renderer_close(&renderer);
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "text_service.h"
+
+const char *text_service_path(void) {
+    const char *path = getenv(TEXT_SERVICE_ENV);
+    return path && path[0] ? path : TEXT_SERVICE_DEFAULT_PATH;
+}
+
+size_t text_request_init(text_request *req, const char *text) {
+    memset(req, 0, TEXT_REQUEST_HEADER_SIZE);
+    req->magic = TEXT_SERVICE_MAGIC;
+    req->size = 24;
+    req->color = 0xFFFF;
+    req->h_align = 1;
+    req->v_align = 1;
+    size_t len = strnlen(text, TEXT_SERVICE_MAX_TEXT - 1);
+    memcpy(req->text, text, len);
+    return TEXT_REQUEST_HEADER_SIZE + len;
+}
+
+int text_client_open(text_client *client, int reply_timeout_ms) {
+    client->fd = -1;
+    client->seq = 0;
+
+    const char *path = text_service_path();
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Text service socket path too long: %s\n", path);
+        return -1;
+    }
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+
+    int flags = SOCK_SEQPACKET | SOCK_CLOEXEC | (reply_timeout_ms > 0 ? 0 : SOCK_NONBLOCK);
+    int fd = socket(AF_UNIX, flags, 0);
+    if (fd == -1) {
+        perror("Error creating text service socket");
+        return -1;
+    }
+    // 本地套接字的 connect 不会阻塞：服务的 backlog 满时非阻塞套接字返回 EAGAIN，按连接失败处理
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        if (errno != ENOENT && errno != ECONNREFUSED) {
+            fprintf(stderr, "Error connecting to %s: %s\n", path, strerror(errno));
+        }
+        close(fd);
+        return -1;
+    }
+    if (reply_timeout_ms > 0) {
+        struct timeval tv = {reply_timeout_ms / 1000, (reply_timeout_ms % 1000) * 1000};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+    client->fd = fd;
+    return 0;
+}
+
+void text_client_close(text_client *client) {
+    if (client->fd >= 0) {
+        close(client->fd);
+        client->fd = -1;
+    }
+}
+
+int text_client_send(text_client *client, text_request *req, size_t len) {
+    req->seq = ++client->seq;
+    // MSG_NOSIGNAL：服务已退出时返回 EPIPE，而不是让客户端收到 SIGPIPE
+    ssize_t n = send(client->fd, req, len, MSG_NOSIGNAL);
+    if (n != (ssize_t)len) {
+        if (n >= 0) {
+            errno = EMSGSIZE;
+        }
+        return -1;
+    }
+    return 0;
+}
+
+int text_client_recv(text_client *client, text_reply *reply) {
+    ssize_t n = recv(client->fd, reply, sizeof(*reply), 0);
+    if (n == (ssize_t)sizeof(*reply)) {
+        return 0;
+    }
+    if (n >= 0) {
+        errno = ECONNRESET;  // 服务关闭了连接，或应答不完整
+    }
+    return -1;
+}
+
+int text_client_draw(text_client *client, text_request *req, size_t len, text_reply *reply) {
+    if (text_client_send(client, req, len) == -1) {
+        return -1;
+    }
+    // 同一连接上的应答按请求顺序返回，跳过之前未读的应答
+    do {
+        if (text_client_recv(client, reply) == -1) {
+            return -1;
+        }
+    } while (reply->seq != req->seq);
+    return 0;
+}
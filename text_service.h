@@ -0,0 +1,67 @@
+#ifndef TEXT_SERVICE_H
+#define TEXT_SERVICE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 文字服务协议：text_server 长期持有字体和字形缓存，通过 Unix 套接字（SOCK_SEQPACKET）接收绘制请求
+// 每条消息是一个完整请求，服务画完后回一条应答；一个连接上可以连续发送多个请求，按顺序处理
+// 套接字路径由 AKU_TEXT_SOCKET 指定，默认 TEXT_SERVICE_DEFAULT_PATH
+
+#define TEXT_SERVICE_ENV          "AKU_TEXT_SOCKET"
+#define TEXT_SERVICE_DEFAULT_PATH "/tmp/aku_text.sock"
+#define TEXT_SERVICE_MAGIC        0x54584b41  // "AKXT"
+#define TEXT_SERVICE_MAX_TEXT     4096  // 更长的文字由 show_text 在本地绘制
+
+// 请求标志
+#define TEXT_NO_CLEAR 0x1    // 不先清除区域，直接叠加绘制
+
+// 绘制请求：固定头部加 UTF-8 文字（不含结尾0，长度由消息长度决定）
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;            // 由客户端编号，应答中原样带回
+    uint16_t size;           // 像素大小 8..72
+    uint16_t color;          // RGB565
+    uint8_t h_align;         // 0=左 1=中 2=右
+    uint8_t v_align;         // 0=上 1=中 2=下
+    uint16_t flags;
+    int16_t x;               // 区域，width 或 height 为0表示整个屏幕
+    int16_t y;
+    uint16_t width;
+    uint16_t height;
+    uint32_t timeout_ms;     // 显示时长，到时清除区域；0 表示一直显示
+    char text[TEXT_SERVICE_MAX_TEXT];
+} text_request;
+
+#define TEXT_REQUEST_HEADER_SIZE offsetof(text_request, text)
+
+// 应答
+typedef struct {
+    uint32_t seq;
+    int32_t status;          // 0 表示已绘制，否则为 -errno
+    uint32_t render_us;      // 服务端清除、绘制和显示的耗时（微秒）
+} text_reply;
+
+typedef struct {
+    int fd;
+    uint32_t seq;            // 最近发送的请求编号
+} text_client;
+
+// 套接字路径
+const char *text_service_path(void);
+
+// 填写默认值（24像素、白色、居中、整个屏幕、一直显示）和文字，返回要发送的消息长度
+size_t text_request_init(text_request *req, const char *text);
+
+// 连接服务；reply_timeout_ms 大于0时等待应答最多这么久，为0时套接字为非阻塞（用于事件循环）
+// 服务未运行时（ENOENT/ECONNREFUSED）静默返回-1，其它错误打印原因
+int text_client_open(text_client *client, int reply_timeout_ms);
+void text_client_close(text_client *client);
+// 发送请求（len 为 text_request_init 的返回值），填写 seq，成功返回0
+int text_client_send(text_client *client, text_request *req, size_t len);
+// 读取一条应答，成功返回0；非阻塞时没有应答返回-1，errno 为 EAGAIN；服务断开时 errno 为 ECONNRESET
+int text_client_recv(text_client *client, text_reply *reply);
+// 发送请求并等待对应的应答，成功返回0
+int text_client_draw(text_client *client, text_request *req, size_t len, text_reply *reply);
+
+#endif
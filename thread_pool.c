@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "thread_pool.h"
+
+// 取出队首任务，调用时需持有锁
+static thread_pool_task *pop_task(thread_pool *pool) {
+    thread_pool_task *task = pool->head;
+    if (task) {
+        pool->head = task->next;
+        if (!pool->head) {
+            pool->tail = NULL;
+        }
+    }
+    return task;
+}
+
+// 在锁外执行任务，返回时重新持有锁
+static void run_task(thread_pool *pool, thread_pool_task *task) {
+    pthread_mutex_unlock(&pool->lock);
+    task->fn(task->arg);
+    pthread_mutex_lock(&pool->lock);
+
+    if (task->group) {
+        task->group->pending--;
+    }
+    free(task);
+    pthread_cond_broadcast(&pool->task_done);
+}
+
+static void *worker_main(void *arg) {
+    thread_pool *pool = arg;
+
+    pthread_mutex_lock(&pool->lock);
+    while (1) {
+        thread_pool_task *task = pop_task(pool);
+        if (task) {
+            run_task(pool, task);
+            continue;
+        }
+        if (pool->shutdown) {
+            break;
+        }
+        pthread_cond_wait(&pool->task_ready, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+int thread_pool_init(thread_pool *pool, int thread_count) {
+    if (thread_count <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = cpus > 0 ? cpus : 1;
+    }
+
+    pool->head = NULL;
+    pool->tail = NULL;
+    pool->thread_count = 0;
+    pool->shutdown = 0;
+    pool->threads = malloc(thread_count * sizeof(pthread_t));
+    if (!pool->threads) {
+        perror("Error allocating thread pool");
+        return -1;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->task_ready, NULL);
+    pthread_cond_init(&pool->task_done, NULL);
+
+    for (int i = 0; i < thread_count; i++) {
+        if (pthread_create(&pool->threads[i], NULL, worker_main, pool) != 0) {
+            fprintf(stderr, "Error creating worker thread %d\n", i);
+            break;
+        }
+        pool->thread_count++;
+    }
+
+    if (pool->thread_count == 0) {
+        thread_pool_destroy(pool);
+        return -1;
+    }
+    return 0;
+}
+
+void thread_pool_destroy(thread_pool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->task_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    // 工作线程退出前会执行完队列中剩余的任务
+    for (int i = 0; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    free(pool->threads);
+    pool->threads = NULL;
+    pool->thread_count = 0;
+    pthread_cond_destroy(&pool->task_done);
+    pthread_cond_destroy(&pool->task_ready);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+void thread_pool_group_init(thread_pool_group *group) {
+    group->pending = 0;
+}
+
+int thread_pool_submit(thread_pool *pool, thread_pool_group *group, thread_pool_fn fn, void *arg) {
+    thread_pool_task *task = malloc(sizeof(thread_pool_task));
+    if (!task) {
+        perror("Error allocating task");
+        return -1;
+    }
+    task->fn = fn;
+    task->arg = arg;
+    task->group = group;
+    task->next = NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    if (group) {
+        group->pending++;
+    }
+    if (pool->tail) {
+        pool->tail->next = task;
+    } else {
+        pool->head = task;
+    }
+    pool->tail = task;
+    pthread_cond_signal(&pool->task_ready);
+    pthread_mutex_unlock(&pool->lock);
+    return 0;
+}
+
+void thread_pool_group_wait(thread_pool *pool, thread_pool_group *group) {
+    pthread_mutex_lock(&pool->lock);
+    while (group->pending > 0) {
+        // 等待期间帮忙执行队列中的任务
+        thread_pool_task *task = pop_task(pool);
+        if (task) {
+            run_task(pool, task);
+        } else {
+            pthread_cond_wait(&pool->task_done, &pool->lock);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,44 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <pthread.h>
+
+// 简单线程池：任务按提交顺序执行，任务可以再向池中提交子任务
+// 任务组用于等待一批任务完成；等待方在等待期间会帮忙执行队列中的任务，
+// 因此在工作线程内等待子任务也不会死锁
+
+typedef void (*thread_pool_fn)(void *arg);
+
+typedef struct thread_pool_task {
+    thread_pool_fn fn;
+    void *arg;
+    struct thread_pool_group *group;
+    struct thread_pool_task *next;
+} thread_pool_task;
+
+typedef struct thread_pool_group {
+    int pending;             // 尚未完成的任务数，受线程池锁保护
+} thread_pool_group;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t task_ready;   // 有新任务或线程池关闭
+    pthread_cond_t task_done;    // 有任务完成
+    thread_pool_task *head;
+    thread_pool_task *tail;
+    pthread_t *threads;
+    int thread_count;
+    int shutdown;
+} thread_pool;
+
+// thread_count 为 0 时使用在线CPU核数，成功返回0
+int thread_pool_init(thread_pool *pool, int thread_count);
+void thread_pool_destroy(thread_pool *pool);
+
+void thread_pool_group_init(thread_pool_group *group);
+// 提交任务，group 可以为 NULL，成功返回0
+int thread_pool_submit(thread_pool *pool, thread_pool_group *group, thread_pool_fn fn, void *arg);
+// 等待任务组中的全部任务完成
+void thread_pool_group_wait(thread_pool *pool, thread_pool_group *group);
+
+#endif
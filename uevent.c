@@ -0,0 +1,163 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <linux/netlink.h>
+
+#include "uevent.h"
+
+// 解析 "action@devpath\0KEY=VALUE\0..."，格式不对时返回-1
+static int parse_uevent(char *buf, size_t len, uevent *ev) {
+    memset(ev, 0, sizeof(*ev));
+    char *at = memchr(buf, '@', strnlen(buf, len));
+    if (!at) {
+        return -1;
+    }
+    *at = '\0';
+    ev->action = buf;
+    ev->devpath = at + 1;
+
+    char *p = at + 1 + strlen(at + 1) + 1;
+    char *end = buf + len;
+    while (p < end && ev->var_count < UEVENT_MAX_VARS) {
+        size_t n = strnlen(p, end - p);
+        if (n > 0 && memchr(p, '=', n)) {
+            ev->vars[ev->var_count++] = p;
+            if (strncmp(p, "SUBSYSTEM=", 10) == 0) {
+                ev->subsystem = p + 10;
+            }
+        }
+        p += n + 1;
+    }
+    return 0;
+}
+
+const char *uevent_get(const uevent *ev, const char *key) {
+    size_t len = strlen(key);
+    for (int i = 0; i < ev->var_count; i++) {
+        if (strncmp(ev->vars[i], key, len) == 0 && ev->vars[i][len] == '=') {
+            return ev->vars[i] + len + 1;
+        }
+    }
+    return NULL;
+}
+
+static void on_uevent(void *arg, int fd, uint32_t events) {
+    uevent_monitor *mon = arg;
+    char buf[UEVENT_BUF_SIZE + 1];
+    (void)events;
+
+    for (;;) {
+        struct sockaddr_nl addr;
+        struct iovec iov = {buf, UEVENT_BUF_SIZE};
+        struct msghdr msg = {0};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        if (mon->netlink) {
+            msg.msg_name = &addr;
+            msg.msg_namelen = sizeof(addr);
+        }
+        ssize_t n = recvmsg(fd, &msg, 0);
+        if (n <= 0) {
+            if (n == -1 && errno == ENOBUFS) {
+                // 接收缓冲区溢出丢了事件：交给回调一个空事件，让使用者重新读取状态
+                fprintf(stderr, "uevent receive buffer overrun\n");
+                uevent lost = {.action = "overrun", .devpath = "", .subsystem = mon->subsystem};
+                mon->fn(mon->arg, &lost);
+                continue;
+            }
+            return;
+        }
+        // 只接受内核发出的消息（nl_pid 为0），忽略其它进程伪造的
+        if (mon->netlink && (msg.msg_namelen != sizeof(addr) || addr.nl_pid != 0)) {
+            continue;
+        }
+        buf[n] = '\0';
+        mon->received++;
+
+        uevent ev;
+        if (parse_uevent(buf, n, &ev) == -1) {
+            continue;
+        }
+        if (mon->subsystem[0] && (!ev.subsystem || strcmp(ev.subsystem, mon->subsystem) != 0)) {
+            continue;
+        }
+        mon->matched++;
+        mon->fn(mon->arg, &ev);
+    }
+}
+
+int uevent_monitor_open(uevent_monitor *mon, const char *subsystem, uevent_fn fn, void *arg) {
+    memset(mon, 0, sizeof(*mon));
+    mon->fd = -1;
+    mon->fn = fn;
+    mon->arg = arg;
+    snprintf(mon->subsystem, sizeof(mon->subsystem), "%s", subsystem ? subsystem : "");
+
+    const char *path = getenv(UEVENT_ENV);
+    if (path && path[0]) {
+        struct sockaddr_un addr = {.sun_family = AF_UNIX};
+        if (strlen(path) >= sizeof(addr.sun_path)) {
+            fprintf(stderr, "uevent socket path too long: %s\n", path);
+            return -1;
+        }
+        snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+        mon->fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (mon->fd == -1) {
+            perror("Error creating uevent socket");
+            return -1;
+        }
+        unlink(path);
+        if (bind(mon->fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+            fprintf(stderr, "Error binding %s: %s\n", path, strerror(errno));
+            close(mon->fd);
+            mon->fd = -1;
+            return -1;
+        }
+        snprintf(mon->path, sizeof(mon->path), "%s", path);
+        return 0;
+    }
+
+    mon->netlink = 1;
+    mon->fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+    if (mon->fd == -1) {
+        perror("Error creating uevent netlink socket");
+        return -1;
+    }
+    struct sockaddr_nl addr = {.nl_family = AF_NETLINK, .nl_groups = 1};
+    if (bind(mon->fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        perror("Error binding uevent netlink socket");
+        close(mon->fd);
+        mon->fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+int uevent_monitor_attach(uevent_monitor *mon, event_loop *loop) {
+    if (event_loop_add_fd(loop, mon->fd, EPOLLIN, on_uevent, mon) == -1) {
+        return -1;
+    }
+    mon->loop = loop;
+    return 0;
+}
+
+void uevent_monitor_close(uevent_monitor *mon) {
+    if (mon->fd < 0) {
+        return;
+    }
+    if (mon->loop) {
+        event_loop_remove_fd(mon->loop, mon->fd);
+        mon->loop = NULL;
+    }
+    close(mon->fd);
+    mon->fd = -1;
+    if (mon->path[0]) {
+        unlink(mon->path);
+        mon->path[0] = '\0';
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef UEVENT_H
+#define UEVENT_H
+
+#include <stdint.h>
+
+#include "event_loop.h"
+
+// 内核 uevent 监视：NETLINK_KOBJECT_UEVENT 套接字加入事件循环，只把指定子系统的事件交给回调
+// 事件来源可由环境变量 AKU_UEVENT 替换为一个 Unix 数据报套接字路径（启动时创建），
+// 测试时向它发送与内核相同格式的消息即可回放事件：
+//   AKU_UEVENT=/tmp/uevent ./sys_boot
+//   printf 'change@/class/power_supply/axp20x-battery\0SUBSYSTEM=power_supply\0' | socat - UNIX-SENDTO:/tmp/uevent
+
+#define UEVENT_ENV      "AKU_UEVENT"
+#define UEVENT_BUF_SIZE 4096
+#define UEVENT_MAX_VARS 64
+
+// 一条 uevent：action@devpath 加若干 KEY=VALUE，指针都指向接收缓冲区，只在回调期间有效
+typedef struct {
+    const char *action;
+    const char *devpath;
+    const char *subsystem;
+    const char *vars[UEVENT_MAX_VARS];
+    int var_count;
+} uevent;
+
+typedef void (*uevent_fn)(void *arg, const uevent *ev);
+
+typedef struct {
+    int fd;
+    int netlink;             // 0 表示替代的 Unix 套接字
+    char path[108];          // Unix 套接字路径，关闭时删除
+    char subsystem[32];      // 只处理这个子系统，空字符串表示全部
+    uevent_fn fn;
+    void *arg;
+    event_loop *loop;
+    uint64_t received;
+    uint64_t matched;
+} uevent_monitor;
+
+// 打开事件来源（AKU_UEVENT 或内核 netlink），失败时打印原因并返回-1
+int uevent_monitor_open(uevent_monitor *mon, const char *subsystem, uevent_fn fn, void *arg);
+// 加入事件循环，成功返回0
+int uevent_monitor_attach(uevent_monitor *mon, event_loop *loop);
+void uevent_monitor_close(uevent_monitor *mon);
+
+// 查找变量值，如 uevent_get(ev, "POWER_SUPPLY_STATUS")，没有时返回 NULL
+const char *uevent_get(const uevent *ev, const char *key);
+
+#endif